@@ -412,11 +412,16 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest
 
     HEADERS += \
+        src/AnalyzeView/GeoTagLogParserTest.h \
         src/AnalyzeView/LogDownloadTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
         src/FactSystem/FactSystemTestPX4.h \
+        src/FactSystem/ParameterCacheTest.h \
         src/FactSystem/ParameterManagerTest.h \
+        src/FactSystem/ParameterMetaDataCacheTest.h \
+        src/FactSystem/ParameterRequestWindowTest.h \
+        src/FactSystem/ParameterStoreTest.h \
         src/MissionManager/CameraSectionTest.h \
         src/MissionManager/MissionCommandTreeTest.h \
         src/MissionManager/MissionControllerManagerTest.h \
@@ -431,27 +436,39 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/MissionManager/SpeedSectionTest.h \
         src/MissionManager/SurveyMissionItemTest.h \
         src/MissionManager/VisualMissionItemTest.h \
+        src/QtLocationPlugin/QGCTileCacheWorkerTest.h \
+        src/QtLocationPlugin/QGCTileDownloaderTest.h \
+        src/qgcunittest/CRC32Test.h \
         src/qgcunittest/FileDialogTest.h \
         src/qgcunittest/FileManagerTest.h \
         src/qgcunittest/FlightGearTest.h \
         src/qgcunittest/GeoTest.h \
         src/qgcunittest/LinkManagerTest.h \
+        src/qgcunittest/LogReplayIndexTest.h \
         src/qgcunittest/MainWindowTest.h \
+        src/qgcunittest/MAVLinkProtocolTest.h \
         src/qgcunittest/MavlinkLogTest.h \
         src/qgcunittest/MessageBoxTest.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/RadioConfigTest.h \
         src/qgcunittest/TCPLinkTest.h \
         src/qgcunittest/TCPLoopBackServer.h \
+        src/qgcunittest/TimeSeriesDataTest.h \
         src/qgcunittest/UnitTest.h \
         src/Vehicle/SendMavCommandTest.h \
+        src/VehicleSetup/BootloaderTest.h \
 
     SOURCES += \
+        src/AnalyzeView/GeoTagLogParserTest.cc \
         src/AnalyzeView/LogDownloadTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
         src/FactSystem/FactSystemTestPX4.cc \
+        src/FactSystem/ParameterCacheTest.cc \
         src/FactSystem/ParameterManagerTest.cc \
+        src/FactSystem/ParameterMetaDataCacheTest.cc \
+        src/FactSystem/ParameterRequestWindowTest.cc \
+        src/FactSystem/ParameterStoreTest.cc \
         src/MissionManager/CameraSectionTest.cc \
         src/MissionManager/MissionCommandTreeTest.cc \
         src/MissionManager/MissionControllerManagerTest.cc \
@@ -466,21 +483,28 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/MissionManager/SpeedSectionTest.cc \
         src/MissionManager/SurveyMissionItemTest.cc \
         src/MissionManager/VisualMissionItemTest.cc \
+        src/QtLocationPlugin/QGCTileCacheWorkerTest.cc \
+        src/QtLocationPlugin/QGCTileDownloaderTest.cc \
+        src/qgcunittest/CRC32Test.cc \
         src/qgcunittest/FileDialogTest.cc \
         src/qgcunittest/FileManagerTest.cc \
         src/qgcunittest/FlightGearTest.cc \
         src/qgcunittest/GeoTest.cc \
         src/qgcunittest/LinkManagerTest.cc \
+        src/qgcunittest/LogReplayIndexTest.cc \
         src/qgcunittest/MainWindowTest.cc \
+        src/qgcunittest/MAVLinkProtocolTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
         src/qgcunittest/MessageBoxTest.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/RadioConfigTest.cc \
         src/qgcunittest/TCPLinkTest.cc \
         src/qgcunittest/TCPLoopBackServer.cc \
+        src/qgcunittest/TimeSeriesDataTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
         src/Vehicle/SendMavCommandTest.cc \
+        src/VehicleSetup/BootloaderTest.cc \
 } } } } } }
 
 # Main QGC Headers and Source files
@@ -489,6 +513,7 @@ HEADERS += \
     src/AnalyzeView/ExifParser.h \
     src/AnalyzeView/ULogParser.h \
     src/AnalyzeView/PX4LogParser.h \
+    src/AnalyzeView/LogFileView.h \
     src/Camera/QGCCameraControl.h \
     src/Camera/QGCCameraIO.h \
     src/Camera/QGCCameraManager.h \
@@ -579,6 +604,7 @@ HEADERS += \
     src/comm/MAVLinkProtocol.h \
     src/comm/ProtocolInterface.h \
     src/comm/QGCMAVLink.h \
+    src/comm/SharedMAVLinkMessage.h \
     src/comm/TCPLink.h \
     src/comm/UDPLink.h \
     src/uas/UAS.h \
@@ -636,6 +662,7 @@ HEADERS += \
     src/ViewWidgets/CustomCommandWidget.h \
     src/ViewWidgets/CustomCommandWidgetController.h \
     src/ViewWidgets/ViewWidgetController.h \
+    src/comm/LogReplayIndex.h \
     src/comm/LogReplayLink.h \
     src/comm/QGCFlightGearLink.h \
     src/comm/QGCHilLink.h \
@@ -644,6 +671,7 @@ HEADERS += \
     src/uas/FileManager.h \
     src/ui/HILDockWidget.h \
     src/ui/MAVLinkDecoder.h \
+    src/ui/MAVLinkSubscriptions.h \
     src/ui/MainWindow.h \
     src/ui/MultiVehicleDockWidget.h \
     src/ui/QGCHilConfiguration.h \
@@ -679,6 +707,7 @@ SOURCES += \
     src/AnalyzeView/ExifParser.cc \
     src/AnalyzeView/ULogParser.cc \
     src/AnalyzeView/PX4LogParser.cc \
+    src/AnalyzeView/LogFileView.cc \
     src/Camera/QGCCameraControl.cc \
     src/Camera/QGCCameraIO.cc \
     src/Camera/QGCCameraManager.cc \
@@ -763,6 +792,7 @@ SOURCES += \
     src/comm/LinkManager.cc \
     src/comm/MAVLinkProtocol.cc \
     src/comm/QGCMAVLink.cc \
+    src/comm/SharedMAVLinkMessage.cc \
     src/comm/TCPLink.cc \
     src/comm/UDPLink.cc \
     src/main.cc \
@@ -803,6 +833,7 @@ SOURCES += \
     src/ViewWidgets/CustomCommandWidget.cc \
     src/ViewWidgets/CustomCommandWidgetController.cc \
     src/ViewWidgets/ViewWidgetController.cc \
+    src/comm/LogReplayIndex.cc \
     src/comm/LogReplayLink.cc \
     src/comm/QGCFlightGearLink.cc \
     src/comm/QGCJSBSimLink.cc \
@@ -810,6 +841,7 @@ SOURCES += \
     src/uas/FileManager.cc \
     src/ui/HILDockWidget.cc \
     src/ui/MAVLinkDecoder.cc \
+    src/ui/MAVLinkSubscriptions.cc \
     src/ui/MainWindow.cc \
     src/ui/MultiVehicleDockWidget.cc \
     src/ui/QGCHilConfiguration.cc \
@@ -1032,7 +1064,11 @@ HEADERS += \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValidator.h \
+    src/FactSystem/ParameterCache.h \
     src/FactSystem/ParameterManager.h \
+    src/FactSystem/ParameterMetaDataCache.h \
+    src/FactSystem/ParameterRequestWindow.h \
+    src/FactSystem/ParameterStore.h \
     src/FactSystem/SettingsFact.h \
 
 SOURCES += \
@@ -1042,7 +1078,11 @@ SOURCES += \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValidator.cc \
+    src/FactSystem/ParameterCache.cc \
     src/FactSystem/ParameterManager.cc \
+    src/FactSystem/ParameterMetaDataCache.cc \
+    src/FactSystem/ParameterRequestWindow.cc \
+    src/FactSystem/ParameterStore.cc \
     src/FactSystem/SettingsFact.cc \
 
 #-------------------------------------------------------------------------------------
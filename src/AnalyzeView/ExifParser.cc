@@ -56,6 +56,33 @@ double ExifParser::readTime(QByteArray& buf)
     return tagTime.toMSecsSinceEpoch()/1000.0;
 }
 
+QByteArray ExifParser::readApp1(QIODevice& device)
+{
+    // Start of image marker
+    QByteArray soi = device.read(2);
+    if (soi.size() != 2 || (uchar)soi[0] != 0xff || (uchar)soi[1] != 0xd8) {
+        return QByteArray();
+    }
+
+    // Walk the segments which come before the image data (APP0/JFIF is often first) until APP1 shows up
+    while (true) {
+        QByteArray segmentHeader = device.read(4);
+        if (segmentHeader.size() != 4 || (uchar)segmentHeader[0] != 0xff) {
+            return QByteArray();
+        }
+        uchar marker = segmentHeader[1];
+        // Segment length includes the length field itself
+        uint16_t length = qFromBigEndian<quint16>((const uchar*)segmentHeader.constData() + 2);
+        if (marker == 0xe1) {
+            return segmentHeader + device.read(length - 2);
+        }
+        // Start of scan means there is no metadata left
+        if (marker == 0xda || length < 2 || !device.seek(device.pos() + length - 2)) {
+            return QByteArray();
+        }
+    }
+}
+
 bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag)
 {
     QByteArray app1Header("\xff\xe1", 2);
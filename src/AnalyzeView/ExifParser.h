@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -12,6 +13,9 @@ public:
     ExifParser();
     ~ExifParser();
     double readTime(QByteArray& buf);
+    /// Reads just the APP1 (EXIF) segment of a JPEG, which is all readTime needs
+    /// @return Empty if the segment couldn't be found
+    QByteArray readApp1(QIODevice& device);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
 };
 
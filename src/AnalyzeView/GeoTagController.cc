@@ -16,10 +16,12 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <cfloat>
+#include <QtConcurrent>
 
 #include "ExifParser.h"
 #include "ULogParser.h"
 #include "PX4LogParser.h"
+#include "LogFileView.h"
 
 GeoTagController::GeoTagController(void)
     : _progress(0)
@@ -174,28 +176,43 @@ void GeoTagWorker::run(void)
     }
     emit progressChanged((100/nSteps));
 
-    // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
+    // Parse EXIF, spread over the thread pool
+    QVector<double> imageTimes(_imageList.size());
+    QVector<int>    imageJobs;
+    QAtomicInt      openFailed(0);
+    double*         imageTimesData = imageTimes.data();
     for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
+        imageJobs.append(i);
+    }
+    QFuture<void> readFuture = QtConcurrent::map(imageJobs, [this, imageTimesData, &openFailed](int& index) {
+        if (_cancel || openFailed.load()) {
             return;
         }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
+        QFile file(_imageList.at(index).absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            openFailed.store(1);
             return;
         }
+        // Only the EXIF segment is needed for the timestamp
+        ExifParser exifParser;
+        QByteArray imageBuffer = exifParser.readApp1(file);
+        if (imageBuffer.isEmpty()) {
+            file.reset();
+            imageBuffer = file.readAll();
+        }
+        imageTimesData[index] = exifParser.readTime(imageBuffer);
+    });
+    bool readComplete = _waitForJobs(readFuture, 100/nSteps, 100/nSteps);
+    if (_cancel) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
     }
+    if (!readComplete || openFailed.load()) {
+        emit error(tr("Geotagging failed. Couldn't open an image."));
+        return;
+    }
+    _imageTime = imageTimes.toList();
 
     // Load log
     bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
@@ -204,8 +221,8 @@ void GeoTagWorker::run(void)
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
+    // Logs can be larger than memory, the parsers look at them through a window
+    LogFileView log(file);
 
     // Instantiate appropriate parser
     _triggerList.clear();
@@ -255,42 +272,36 @@ void GeoTagWorker::run(void)
         return;
     }
 
-    // Tag images
+    // Tag images, spread over the thread pool
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
+    QVector<int> tagJobs;
+    QAtomicInt   tagResult(TagOk);
     for(int i = 0; i < maxIndex; i++) {
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
+        tagJobs.append(i);
+    }
+    QFuture<void> tagFuture = QtConcurrent::map(tagJobs, [this, &tagResult](int& index) {
+        if (_cancel || tagResult.load() != TagOk) {
             return;
         }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
-
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
-        } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
-        }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
+        TagResult result = _tagImage(index);
+        if (result != TagOk) {
+            tagResult.testAndSetOrdered(TagOk, result);
         }
+    });
+    _waitForJobs(tagFuture, 4*(100/nSteps), 100/nSteps);
+    switch (tagResult.load()) {
+    case TagOpenFailed:
+        emit error(tr("Geotagging failed. Couldn't open an image."));
+        return;
+    case TagExifFailed:
+        emit error(tr("Geotagging failed. Couldn't write to image."));
+        return;
+    case TagSaveFailed:
+        emit error(tr("Geotagging failed. Couldn't write to an image."));
+        return;
+    default:
+        break;
     }
 
     if (_cancel) {
@@ -302,6 +313,78 @@ void GeoTagWorker::run(void)
     emit progressChanged(100);
 }
 
+/// Waits for a pool job to finish while reporting its progress and checking for cancellation
+/// @return false: job was cancelled
+bool GeoTagWorker::_waitForJobs(QFuture<void>& future, double progressStart, double progressSpan)
+{
+    while (!future.isFinished()) {
+        if (_cancel) {
+            future.cancel();
+            break;
+        }
+        int progressMaximum = future.progressMaximum();
+        if (progressMaximum > 0) {
+            emit progressChanged(progressStart + (progressSpan * future.progressValue()) / progressMaximum);
+        }
+        QThread::msleep(_progressIntervalMSecs);
+    }
+    future.waitForFinished();
+    return !_cancel;
+}
+
+/// Writes the tagged copy of one image. Only the segments up to and including EXIF are held in memory and
+/// patched, the rest of the image is streamed through. Runs on a pool thread.
+GeoTagWorker::TagResult GeoTagWorker::_tagImage(int index)
+{
+    int imageIndex = _imageIndices[index];
+    if (imageIndex < 0 || imageIndex >= _imageList.count()) {
+        return TagOpenFailed;
+    }
+    const QFileInfo& imageInfo = _imageList.at(imageIndex);
+
+    QFile fileRead(imageInfo.absoluteFilePath());
+    if (!fileRead.open(QIODevice::ReadOnly)) {
+        return TagOpenFailed;
+    }
+    ExifParser exifParser;
+    qint64 headerSize = fileRead.size();
+    if (!exifParser.readApp1(fileRead).isEmpty()) {
+        headerSize = fileRead.pos();
+    }
+    fileRead.reset();
+    QByteArray imageHeader = fileRead.read(headerSize);
+
+    GeoTagWorker::cameraFeedbackPacket geotag = _triggerList.at(_triggerIndices[index]);
+    if (!exifParser.write(imageHeader, geotag)) {
+        return TagExifFailed;
+    }
+
+    QFile fileWrite;
+    if(_saveDirectory == "") {
+        fileWrite.setFileName(_imageDirectory + "/TAGGED/" + imageInfo.fileName());
+    } else {
+        fileWrite.setFileName(_saveDirectory + "/" + imageInfo.fileName());
+    }
+    if (!fileWrite.open(QFile::WriteOnly)) {
+        return TagSaveFailed;
+    }
+    if (fileWrite.write(imageHeader) != imageHeader.size()) {
+        return TagSaveFailed;
+    }
+    QByteArray chunk;
+    while (!(chunk = fileRead.read(_copyChunkSize)).isEmpty()) {
+        if (fileWrite.write(chunk) != chunk.size()) {
+            return TagSaveFailed;
+        }
+        if (_cancel) {
+            // Don't leave a truncated image behind
+            fileWrite.remove();
+            break;
+        }
+    }
+    return TagOk;
+}
+
 bool GeoTagWorker::triggerFiltering()
 {
     _imageIndices.clear();
@@ -20,6 +20,7 @@
 #include <QElapsedTimer>
 #include <QDebug>
 #include <QGeoCoordinate>
+#include <QFuture>
 
 class GeoTagWorker : public QThread
 {
@@ -59,7 +60,16 @@ signals:
     void progressChanged    (double progress);
 
 private:
+    typedef enum {
+        TagOk,
+        TagOpenFailed,  ///< Couldn't open the image
+        TagExifFailed,  ///< Couldn't add the tags to the image
+        TagSaveFailed   ///< Couldn't write the tagged image
+    } TagResult;
+
     bool triggerFiltering();
+    bool _waitForJobs(QFuture<void>& future, double progressStart, double progressSpan);
+    TagResult _tagImage(int index);
 
     bool                    _cancel;
     QString                 _logFile;
@@ -71,6 +81,9 @@ private:
     QList<int>              _imageIndices;
     QList<int>              _triggerIndices;
 
+    static const int        _progressIntervalMSecs = 100;
+    static const qint64     _copyChunkSize = 1024 * 1024;
+
 };
 
 /// Controller for GeoTagPage.qml. Supports geotagging images based on logfile camera tags.
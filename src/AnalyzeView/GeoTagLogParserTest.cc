@@ -0,0 +1,283 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "GeoTagLogParserTest.h"
+#include "PX4LogParser.h"
+#include "ULogParser.h"
+#include "LogFileView.h"
+
+const GeoTagLogParserTest::Position_t GeoTagLogParserTest::_positionA = { 473977419, 85455938, 488.5f };
+const GeoTagLogParserTest::Position_t GeoTagLogParserTest::_positionB = { 473981234, 85461122, 502.25f };
+
+// sdlog2 message types
+static const uint8_t _fmtType =     0x80;
+static const uint8_t _attType =     0x02;
+static const uint8_t _gposType =    0x10;
+static const uint8_t _camtType =    0x37;
+
+// Both log formats are little endian, as are the hosts the tests run on
+template<typename T>
+static void _append(QByteArray& bytes, T value)
+{
+    bytes.append((const char*)&value, sizeof(value));
+}
+
+static void _appendPadded(QByteArray& bytes, const char* value, int length)
+{
+    QByteArray padded(value);
+    padded.resize(length);
+    bytes.append(padded);
+}
+
+static void _appendSdlog2Header(QByteArray& bytes, uint8_t type)
+{
+    bytes.append((char)0xA3);
+    bytes.append((char)0x95);
+    bytes.append((char)type);
+}
+
+static void _appendSdlog2Fmt(QByteArray& bytes, uint8_t type, uint8_t length, const char* name, const char* format, const char* labels)
+{
+    _appendSdlog2Header(bytes, _fmtType);
+    _append<uint8_t>(bytes, type);
+    _append<uint8_t>(bytes, length);
+    _appendPadded(bytes, name, 4);
+    _appendPadded(bytes, format, 16);
+    _appendPadded(bytes, labels, 64);
+}
+
+static void _appendSdlog2Att(QByteArray& bytes)
+{
+    _appendSdlog2Header(bytes, _attType);
+    _append<float>(bytes, 0.1f);
+    _append<float>(bytes, -0.2f);
+    _append<float>(bytes, 1.5f);
+}
+
+static void _appendSdlog2Camt(QByteArray& bytes, uint32_t seq)
+{
+    _appendSdlog2Header(bytes, _camtType);
+    _append<quint64>(bytes, seq * 1000000ull);
+    _append<uint32_t>(bytes, seq);
+}
+
+static void _appendULogMessage(QByteArray& bytes, char type, const QByteArray& payload)
+{
+    _append<uint16_t>(bytes, payload.size());
+    bytes.append(type);
+    bytes.append(payload);
+}
+
+GeoTagLogParserTest::GeoTagLogParserTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void GeoTagLogParserTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+}
+
+void GeoTagLogParserTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanup();
+}
+
+void GeoTagLogParserTest::_writeFile(const QString& filename, const QByteArray& bytes)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QFile::WriteOnly));
+    QCOMPARE(file.write(bytes), (qint64)bytes.size());
+}
+
+/// Writes an sdlog2 log with: trigger 1, position A, trigger 2, trigger 3, position B, trigger 4. Two corrupt message
+/// headers are in between, one of an unknown type and one a trigger cut short by the next message.
+void GeoTagLogParserTest::_writePX4Log(const QString& filename)
+{
+    const Position_t* positions[2] = { &_positionA, &_positionB };
+    QByteArray bytes;
+
+    _appendSdlog2Fmt(bytes, _fmtType,  89, "FMT",  "BBnNZ",     "Type,Length,Name,Format,Columns");
+    _appendSdlog2Fmt(bytes, _attType,  15, "ATT",  "fff",       "Roll,Pitch,Yaw");
+    _appendSdlog2Fmt(bytes, _gposType, 35, "GPOS", "LLffffff",  "Lat,Lon,Alt,VelN,VelE,VelD,EPH,EPV");
+    _appendSdlog2Fmt(bytes, _camtType, 15, "CAMT", "QI",        "T,seq");
+
+    _appendSdlog2Att(bytes);
+    _appendSdlog2Camt(bytes, 1);
+    _appendSdlog2Att(bytes);
+    for (int i=0; i<2; i++) {
+        _appendSdlog2Header(bytes, _gposType);
+        _append<qint32>(bytes, positions[i]->latE7);
+        _append<qint32>(bytes, positions[i]->lonE7);
+        _append<float>(bytes, positions[i]->alt);
+        for (int j=0; j<5; j++) {
+            _append<float>(bytes, 0.0f);
+        }
+        if (i == 0) {
+            bytes.append("\xA3\x95\xEE", 3);
+            _appendSdlog2Att(bytes);
+            _appendSdlog2Camt(bytes, 2);
+            bytes.append("\xA3\x95\x37\x05\x06", 5);
+            _appendSdlog2Camt(bytes, 3);
+            _appendSdlog2Att(bytes);
+        }
+    }
+    _appendSdlog2Camt(bytes, 4);
+
+    _writeFile(filename, bytes);
+}
+
+/// Writes a ULog with the same three captures as the sdlog2 log, between data of another topic
+void GeoTagLogParserTest::_writeULog(const QString& filename)
+{
+    const Position_t*   positions[3] = { &_positionA, &_positionB, &_positionB };
+    const uint16_t      sensorMsgID = 0;
+    const uint16_t      captureMsgID = 1;
+    QByteArray          bytes;
+    QByteArray          payload;
+
+    bytes.append("ULog\x01\x12\x35", 7);
+    _append<uint8_t>(bytes, 1);
+    _append<quint64>(bytes, 0);
+
+    _appendULogMessage(bytes, 'F', "sensor_combined:uint64_t timestamp;float[3] gyro_rad;");
+    _appendULogMessage(bytes, 'F', "camera_capture:uint64_t timestamp;uint64_t timestamp_utc;uint32_t seq;double lat;double lon;"
+                                   "float alt;float ground_distance;float[4] q;int8_t result;uint8_t[3] _padding0;");
+    payload.clear();
+    _append<uint8_t>(payload, 0);
+    _append<uint16_t>(payload, sensorMsgID);
+    payload.append("sensor_combined");
+    _appendULogMessage(bytes, 'A', payload);
+    payload.clear();
+    _append<uint8_t>(payload, 0);
+    _append<uint16_t>(payload, captureMsgID);
+    payload.append("camera_capture");
+    _appendULogMessage(bytes, 'A', payload);
+
+    for (int i=0; i<3; i++) {
+        payload.clear();
+        _append<uint16_t>(payload, sensorMsgID);
+        _append<quint64>(payload, i * 1000000ull);
+        for (int j=0; j<3; j++) {
+            _append<float>(payload, 0.01f);
+        }
+        _appendULogMessage(bytes, 'D', payload);
+
+        uint32_t seq = i + 1;
+        payload.clear();
+        _append<uint16_t>(payload, captureMsgID);
+        _append<quint64>(payload, seq * 1000000ull);
+        _append<quint64>(payload, 1500000000000000ull + seq * 1000000ull);
+        _append<uint32_t>(payload, seq);
+        _append<double>(payload, static_cast<double>(positions[i]->latE7) / 1.0e7);
+        _append<double>(payload, static_cast<double>(positions[i]->lonE7) / 1.0e7);
+        _append<float>(payload, positions[i]->alt);
+        _append<float>(payload, 12.0f);
+        for (int j=0; j<4; j++) {
+            _append<float>(payload, 0.5f);
+        }
+        _append<int8_t>(payload, 1);
+        payload.append(QByteArray(3, 0));
+        _appendULogMessage(bytes, 'D', payload);
+    }
+
+    _writeFile(filename, bytes);
+}
+
+/// Checks for captures 1 at position A, 2 and 3 at position B
+void GeoTagLogParserTest::_checkFeedback(const QList<GeoTagWorker::cameraFeedbackPacket>& feedback)
+{
+    const Position_t* positions[3] = { &_positionA, &_positionB, &_positionB };
+
+    QCOMPARE(feedback.count(), 3);
+    for (int i=0; i<feedback.count(); i++) {
+        QCOMPARE(feedback[i].imageSequence, (uint32_t)(i + 1));
+        QCOMPARE(feedback[i].timestamp, (double)(i + 1));
+        QCOMPARE(feedback[i].latitude, static_cast<double>(positions[i]->latE7) / 1.0e7);
+        QCOMPARE(feedback[i].longitude, static_cast<double>(positions[i]->lonE7) / 1.0e7);
+        QCOMPARE(feedback[i].altitude, positions[i]->alt);
+    }
+}
+
+void GeoTagLogParserTest::_px4Log_test(void)
+{
+    QString filename = _tempDir->path() + QStringLiteral("/GeoTagLogParserTest.px4log");
+    _writePX4Log(filename);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    const qint64 windowSizes[2] = { 64 * 1024 * 1024, _smallWindowSize };
+    for (int i=0; i<2; i++) {
+        QFile file(filename);
+        QVERIFY(file.open(QFile::ReadOnly));
+        LogFileView log(file, windowSizes[i]);
+        PX4LogParser parser;
+        QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+
+        // Trigger 4 has no position after it and is dropped
+        QVERIFY(parser.getTagsFromLog(log, feedback));
+        _checkFeedback(feedback);
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+    }
+}
+
+void GeoTagLogParserTest::_ulog_test(void)
+{
+    QString filename = _tempDir->path() + QStringLiteral("/GeoTagLogParserTest.ulg");
+    _writeULog(filename);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    const qint64 windowSizes[2] = { 64 * 1024 * 1024, _smallWindowSize };
+    for (int i=0; i<2; i++) {
+        QFile file(filename);
+        QVERIFY(file.open(QFile::ReadOnly));
+        LogFileView log(file, windowSizes[i]);
+        ULogParser parser;
+        QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+
+        QVERIFY(parser.getTagsFromLog(log, feedback));
+        _checkFeedback(feedback);
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        for (int j=0; j<feedback.count(); j++) {
+            QCOMPARE(feedback[j].groundDistance, 12.0f);
+            QCOMPARE(feedback[j].captureResult, (uint8_t)1);
+        }
+    }
+}
+
+void GeoTagLogParserTest::_ulogBadMagic_test(void)
+{
+    // An sdlog2 log is not a ULog
+    QString filename = _tempDir->path() + QStringLiteral("/GeoTagLogParserTest.px4log");
+    _writePX4Log(filename);
+
+    QFile file(filename);
+    QVERIFY(file.open(QFile::ReadOnly));
+    LogFileView log(file);
+    ULogParser parser;
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+
+    QVERIFY(!parser.getTagsFromLog(log, feedback));
+    QCOMPARE(feedback.count(), 0);
+}
@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef GEOTAGLOGPARSERTEST_H
+#define GEOTAGLOGPARSERTEST_H
+
+#include "UnitTest.h"
+#include "GeoTagController.h"
+
+#include <QTemporaryDir>
+
+/// @file
+///     @brief Unit test for the geotag log parsers (PX4LogParser, ULogParser) reading through LogFileView
+
+class GeoTagLogParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    GeoTagLogParserTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _px4Log_test(void);
+    void _ulog_test(void);
+    void _ulogBadMagic_test(void);
+
+private:
+    struct Position_t {
+        qint32  latE7;
+        qint32  lonE7;
+        float   alt;
+    };
+
+    void _writeFile     (const QString& filename, const QByteArray& bytes);
+    void _writePX4Log   (const QString& filename);
+    void _writeULog     (const QString& filename);
+    void _checkFeedback (const QList<GeoTagWorker::cameraFeedbackPacket>& feedback);
+
+    QTemporaryDir*  _tempDir;
+
+    static const Position_t _positionA;
+    static const Position_t _positionB;
+
+    /// Window sizes the logs are read with. The small one moves the window every few messages.
+    static const qint64     _smallWindowSize = 40;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogFileView.h"
+
+LogFileView::LogFileView(QFile& file, qint64 windowSize)
+    : _file(file)
+    , _fileSize(file.size())
+    , _windowSize(windowSize)
+    , _windowStart(0)
+    , _windowLength(0)
+    , _mappedWindow(NULL)
+{
+
+}
+
+LogFileView::~LogFileView()
+{
+    _releaseWindow();
+}
+
+const char* LogFileView::data(qint64 offset, qint64 len)
+{
+    if (offset < 0 || len < 0 || offset + len > _fileSize) {
+        return NULL;
+    }
+    if (offset < _windowStart || offset + len > _windowStart + _windowLength) {
+        if (!_moveWindow(offset, len)) {
+            return NULL;
+        }
+    }
+    qint64 windowOffset = offset - _windowStart;
+    if (_mappedWindow) {
+        return reinterpret_cast<const char*>(_mappedWindow) + windowOffset;
+    }
+    return _bufferedWindow.constData() + windowOffset;
+}
+
+bool LogFileView::_moveWindow(qint64 offset, qint64 len)
+{
+    _releaseWindow();
+
+    _windowStart = offset;
+    _windowLength = qMin(qMax(_windowSize, len), _fileSize - offset);
+
+    _mappedWindow = _file.map(_windowStart, _windowLength);
+    if (!_mappedWindow) {
+        if (!_file.seek(_windowStart)) {
+            _windowLength = 0;
+            return false;
+        }
+        _bufferedWindow = _file.read(_windowLength);
+        if (_bufferedWindow.size() != _windowLength) {
+            _bufferedWindow.clear();
+            _windowLength = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+void LogFileView::_releaseWindow(void)
+{
+    if (_mappedWindow) {
+        _file.unmap(_mappedWindow);
+        _mappedWindow = NULL;
+    }
+    _bufferedWindow.clear();
+    _windowLength = 0;
+}
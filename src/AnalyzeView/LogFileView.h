@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#ifndef LOGFILEVIEW_H
+#define LOGFILEVIEW_H
+
+#include <QFile>
+#include <QByteArray>
+
+/// Read-only random access to a large log file, one window at a time. The window is memory mapped
+/// when possible and read into a buffer otherwise, so memory use stays bounded by the window size
+/// no matter how large the file is.
+class LogFileView
+{
+public:
+    /// @param file Must already be open for reading
+    LogFileView(QFile& file, qint64 windowSize = _defaultWindowSize);
+    ~LogFileView();
+
+    qint64 size(void) const { return _fileSize; }
+
+    /// Returns a pointer to len bytes at offset. The pointer is valid until the next call.
+    /// @return NULL if the range is past the end of the file or can't be read
+    const char* data(qint64 offset, qint64 len);
+
+private:
+    bool _moveWindow(qint64 offset, qint64 len);
+    void _releaseWindow(void);
+
+    QFile&      _file;
+    qint64      _fileSize;
+    qint64      _windowSize;
+    qint64      _windowStart;
+    qint64      _windowLength;
+    uchar*      _mappedWindow;
+    QByteArray  _bufferedWindow;    ///< Used if the file can't be mapped
+
+    static const qint64 _defaultWindowSize = 64 * 1024 * 1024;
+};
+
+#endif // LOGFILEVIEW_H
@@ -1,8 +1,12 @@
 #include "PX4LogParser.h"
+#include "LogFileView.h"
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
 
+const char PX4LogParser::_headByte1 = (char)0xA3;
+const char PX4LogParser::_headByte2 = (char)0x95;
+
 PX4LogParser::PX4LogParser()
 {
 
@@ -13,86 +17,109 @@ PX4LogParser::~PX4LogParser()
 
 }
 
-bool PX4LogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+bool PX4LogParser::_isMessageStart(LogFileView& log, qint64 index)
 {
+    const char* header = log.data(index, 2);
+    return header && header[0] == _headByte1 && header[1] == _headByte2;
+}
 
-     // general message header
-    char header[] = {(char)0xA3, (char)0x95, (char)0x00};
-    // header for GPOS message header
-    char gposHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x10, (char)0x00};
-    int gposHeaderOffset;
-    // header for GPOS message
-    char gposHeader[] = {(char)0xA3, (char)0x95, (char)0x10, (char)0x00};
-    int gposOffsets[3] = {3, 7, 11};
-    int gposLengths[3] = {4, 4, 4};
-    // header for trigger message header
-    char triggerHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x37, (char)0x00};
-    int triggerHeaderOffset;
-    // header for trigger message
-    char triggerHeader[] = {(char)0xA3, (char)0x95, (char)0x37, (char)0x00};
-    int triggerOffsets[2] = {3, 11};
-    int triggerLengths[2] = {8, 4};
+/// @return Index of the first message header at or after from, -1 if there is none
+qint64 PX4LogParser::_findNextMessage(LogFileView& log, qint64 from)
+{
+    const qint64 chunkSize = 64 * 1024;
 
-    // extract header information: message lengths
-    uint8_t* iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(gposHeaderHeader) + 4, 1).data());
-    gposHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
-    iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(triggerHeaderHeader) + 4, 1).data());
-    triggerHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
+    for (qint64 index = from; index < log.size() - 1; index += chunkSize) {
+        qint64 len = qMin(chunkSize + 1, log.size() - index);
+        const char* chunk = log.data(index, len);
+        if (!chunk) {
+            break;
+        }
+        const char* scan = chunk;
+        const char* end = chunk + len - 1;
+        while (scan < end && (scan = (const char*)memchr(scan, _headByte1, end - scan)) != NULL) {
+            if (scan[1] == _headByte2) {
+                return index + (scan - chunk);
+            }
+            scan++;
+        }
+    }
+    return -1;
+}
 
-    // extract trigger data
-    int index = 1;
+bool PX4LogParser::getTagsFromLog(LogFileView& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+{
+    // Message types we are interested in
+    const uint8_t fmtType =     0x80;
+    const uint8_t gposType =    0x10;
+    const uint8_t triggerType = 0x37;
+    // Field offsets from the start of the message, including the 3 byte header
+    const int gposOffsets[3] =      {3, 7, 11};
+    const int triggerOffsets[2] =   {3, 11};
+    // FMT: header, type, length, name[4], format[16], labels[64]
+    const int fmtLength =           89;
+
+    memset(_messageLengths, 0, sizeof(_messageLengths));
+    _messageLengths[fmtType] = fmtLength;
+
+    // Walk the log message by message. Message lengths come from the FMT messages at the start of the log,
+    // a message is only trusted if the next one starts right after it. Anything else is skipped by
+    // resyncing on the next message header. Only trigger and global position payloads are read.
+    qint64 index = _findNextMessage(log, 0);
     int sequence = -1;
-    while(index < log.count() - 1) {
+    QList<GeoTagWorker::cameraFeedbackPacket> pendingTriggers;   ///< Triggers still waiting for a position
 
-        // first extract trigger
-        index = log.indexOf(triggerHeader, index + 1);
-        // check for whether last entry has been passed
-        if (index < 0) {
+    while (index >= 0 && index < log.size() - 2) {
+        const char* header = log.data(index, 3);
+        if (!header) {
             break;
         }
-
-        if (log.indexOf(header, index + 1) != index + triggerHeaderOffset) {
+        uint8_t type = (uint8_t)header[2];
+        int length = _messageLengths[type];
+        if (!length || (index + length < log.size() && !_isMessageStart(log, index + length))) {
+            index = _findNextMessage(log, index + 1);
             continue;
         }
-
-        GeoTagWorker::cameraFeedbackPacket feedback;
-        memset(&feedback, 0, sizeof(feedback));
-
-        uint64_t* time = reinterpret_cast<uint64_t*>(log.mid(index + triggerOffsets[0], triggerLengths[0]).data());
-        double timeDouble = static_cast<double>(qFromLittleEndian(*time)) / 1.0e6;
-        uint32_t* seq = reinterpret_cast<uint32_t*>(log.mid(index + triggerOffsets[1], triggerLengths[1]).data());
-        int seqInt = static_cast<int>(qFromLittleEndian(*seq));
-        if (sequence >= seqInt || sequence + 20 < seqInt) { // assume that logging has not skipped more than 20 triggers. this prevents wrong header detection
-            continue;
+        // Checking the next header may have moved the view, so the message is fetched last
+        const char* msg = log.data(index, length);
+        if (!msg) {
+            break;
         }
-        feedback.timestamp = timeDouble;
-        feedback.imageSequence = seqInt;
-        sequence = seqInt;
 
-        // second extract position
-        bool lookForGpos = true;
-        while (lookForGpos) {
-
-            int gposIndex = log.indexOf(gposHeader, index + 1);
-            if (gposIndex < 0) {
-                cameraFeedback.append(feedback);
-                break;
+        if (type == fmtType) {
+            _messageLengths[(uint8_t)msg[3]] = (uint8_t)msg[4];
+        } else if (type == triggerType && length >= triggerOffsets[1] + 4) {
+            quint64 time = qFromLittleEndian<quint64>((const uchar*)msg + triggerOffsets[0]);
+            int seqInt = static_cast<int>(qFromLittleEndian<quint32>((const uchar*)msg + triggerOffsets[1]));
+            // assume that logging has not skipped more than 20 triggers. this prevents wrong header detection
+            if (sequence < seqInt && sequence + 20 >= seqInt) {
+                GeoTagWorker::cameraFeedbackPacket feedback;
+                memset(&feedback, 0, sizeof(feedback));
+                feedback.timestamp = static_cast<double>(time) / 1.0e6;
+                feedback.imageSequence = seqInt;
+                sequence = seqInt;
+                pendingTriggers.append(feedback);
             }
-            index = gposIndex;
-
-            // verify that at an offset of gposHeaderOffset the next log message starts
-            if (gposIndex + gposHeaderOffset == log.indexOf(header, gposIndex + 1)) {
-                int32_t* lat = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[0], gposLengths[0]).data());
-                feedback.latitude = static_cast<double>(qFromLittleEndian(*lat))/1.0e7;
-                int32_t* lon = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[1], gposLengths[1]).data());
-                feedback.longitude = static_cast<double>(qFromLittleEndian(*lon))/1.0e7;
-                feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                float* alt = reinterpret_cast<float*>(log.mid(gposIndex + gposOffsets[2], gposLengths[2]).data());
-                feedback.altitude = qFromLittleEndian(*alt);
+        } else if (type == gposType && !pendingTriggers.isEmpty() && length >= gposOffsets[2] + 4) {
+            // The first position after a trigger is the position of the trigger
+            double latitude = static_cast<double>(qFromLittleEndian<qint32>((const uchar*)msg + gposOffsets[0])) / 1.0e7;
+            double longitude = static_cast<double>(qFromLittleEndian<qint32>((const uchar*)msg + gposOffsets[1])) / 1.0e7;
+            longitude = fmod(180.0 + longitude, 360.0) - 180.0;
+            quint32 alt = qFromLittleEndian<quint32>((const uchar*)msg + gposOffsets[2]);
+            for (int i=0; i<pendingTriggers.count(); i++) {
+                GeoTagWorker::cameraFeedbackPacket& feedback = pendingTriggers[i];
+                feedback.latitude = latitude;
+                feedback.longitude = longitude;
+                memcpy(&feedback.altitude, &alt, sizeof(feedback.altitude));
                 cameraFeedback.append(feedback);
-                break;
             }
+            pendingTriggers.clear();
         }
+
+        index += length;
+    }
+    // Triggers after the last position have no position to tag their images with
+    if (!pendingTriggers.isEmpty()) {
+        qWarning() << "Dropping" << pendingTriggers.count() << "camera triggers without a position at the end of the log";
     }
 
     return true;
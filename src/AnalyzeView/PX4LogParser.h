@@ -6,14 +6,23 @@
 
 #include "GeoTagController.h"
 
+class LogFileView;
+
 class PX4LogParser
 {
 public:
     PX4LogParser();
     ~PX4LogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+    bool getTagsFromLog(LogFileView& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
 private:
+    qint64 _findNextMessage(LogFileView& log, qint64 from);
+    bool   _isMessageStart (LogFileView& log, qint64 index);
+
+    int    _messageLengths[256];    ///< Message length by type from the FMT messages, 0 if unknown
+
+    static const char _headByte1;
+    static const char _headByte2;
 
 };
 
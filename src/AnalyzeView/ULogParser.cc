@@ -1,4 +1,5 @@
 #include "ULogParser.h"
+#include "LogFileView.h"
 #include <math.h>
 #include <QDateTime>
 
@@ -83,32 +84,44 @@ bool ULogParser::parseFieldFormat(QString& fields)
         prevFieldEnd = fieldEnd + 1;
         fieldEnd = fields.indexOf(';', prevFieldEnd);
     }
+    _cameraCaptureDataSize = offset;
     return false;
 }
 
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+bool ULogParser::getTagsFromLog(LogFileView& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
     //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
+    const char* fileHeader = log.data(0, ULOG_FILE_HEADER_LEN);
+    if(!fileHeader || memcmp(fileHeader, _ULogMagic, sizeof(_ULogMagic) - 1) != 0) {
         qWarning() << "Could not detect ULog file header magic";
         return false;
     }
 
-    int index = ULOG_FILE_HEADER_LEN;
+    // Messages are walked one header at a time. Only camera_capture definitions and data are looked at,
+    // so most of the log is never read past its message header.
+    qint64 index = ULOG_FILE_HEADER_LEN;
     bool geotagFound = false;
 
-    while(index < log.count() - 1) {
+    while(index < log.size() - 1) {
 
+        const char* headerData = log.data(index, ULOG_MSG_HEADER_LEN);
+        if (!headerData) {
+            break;
+        }
         ULogMessageHeader header;
         memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
+        memcpy(&header, headerData, ULOG_MSG_HEADER_LEN);
 
         switch (header.msgType) {
             case (int)ULogMessageType::FORMAT:
             {
+                const char* msg = log.data(index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                if (!msg) {
+                    break;
+                }
                 ULogMessageFormat format_msg;
                 memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                memcpy(&format_msg, msg, qMin((size_t)(ULOG_MSG_HEADER_LEN + header.msgSize), sizeof(format_msg) - 1));
 
                 QString fmt(format_msg.format);
                 int posSeparator = fmt.indexOf(':');
@@ -123,9 +136,13 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
 
             case (int)ULogMessageType::ADD_LOGGED_MSG:
             {
+                const char* msg = log.data(index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                if (!msg) {
+                    break;
+                }
                 ULogMessageAddLogged addLoggedMsg;
                 memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                memcpy(&addLoggedMsg, msg, qMin((size_t)(ULOG_MSG_HEADER_LEN + header.msgSize), sizeof(addLoggedMsg) - 1));
 
                 QString messageName(addLoggedMsg.msgName);
 
@@ -144,25 +161,35 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
                     return false;
                 }
 
+                const char* msg = log.data(index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                if (!msg || header.msgSize < 2) {
+                    break;
+                }
+
                 uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
+                memcpy(&msgID, msg + ULOG_MSG_HEADER_LEN, 2);
 
                 if(msgID == _cameraCaptureMsgID) {
+                    // Make sure all the fields are readable even if the message is shorter than its format
+                    msg = log.data(index, qMax(ULOG_MSG_HEADER_LEN + header.msgSize, 5 + _cameraCaptureDataSize));
+                    if (!msg) {
+                        break;
+                    }
 
                     // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
                     GeoTagWorker::cameraFeedbackPacket feedback;
                     memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp"), 8);
+                    memcpy(&feedback.timestamp, msg + 5 + _cameraCaptureOffsets.value("timestamp"), 8);
                     feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp_utc"), 8);
+                    memcpy(&feedback.timestampUTC, msg + 5 + _cameraCaptureOffsets.value("timestamp_utc"), 8);
                     feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value("seq"), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lat"), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lon"), 8);
+                    memcpy(&feedback.imageSequence, msg + 5 + _cameraCaptureOffsets.value("seq"), 4);
+                    memcpy(&feedback.latitude, msg + 5 + _cameraCaptureOffsets.value("lat"), 8);
+                    memcpy(&feedback.longitude, msg + 5 + _cameraCaptureOffsets.value("lon"), 8);
                     feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value("alt"), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value("ground_distance"), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value("result"), 1);
+                    memcpy(&feedback.altitude, msg + 5 + _cameraCaptureOffsets.value("alt"), 4);
+                    memcpy(&feedback.groundDistance, msg + 5 + _cameraCaptureOffsets.value("ground_distance"), 4);
+                    memcpy(&feedback.captureResult, msg + 5 + _cameraCaptureOffsets.value("result"), 1);
 
                     cameraFeedback.append(feedback);
 
@@ -6,6 +6,8 @@
 
 #include "GeoTagController.h"
 
+class LogFileView;
+
 #define ULOG_FILE_HEADER_LEN 16
 
 class ULogParser
@@ -13,12 +15,13 @@ class ULogParser
 public:
     ULogParser();
     ~ULogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+    bool getTagsFromLog(LogFileView& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
 private:
 
     QMap<QString, int> _cameraCaptureOffsets; // <fieldName, fieldOffset>
     int _cameraCaptureMsgID;
+    int _cameraCaptureDataSize = 0; // Size of the camera_capture fields
 
     const char _ULogMagic[8] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
 
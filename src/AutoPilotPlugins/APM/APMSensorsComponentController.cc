@@ -77,7 +77,12 @@ APMSensorsComponentController::APMSensorsComponentController(void)
         qWarning() << "Sensors component is missing";
     }
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    QList<uint32_t> msgIds;
+    msgIds << MAVLINK_MSG_ID_COMMAND_ACK << MAVLINK_MSG_ID_MAG_CAL_PROGRESS << MAVLINK_MSG_ID_MAG_CAL_REPORT;
+    qgcApp()->toolbox()->mavlinkProtocol()->subscribeMessages(this, QStringLiteral("APMSensorsComponentController"), _vehicle->id(), msgIds,
+                                                              [this](LinkInterface* link, const mavlink_message_t& message) {
+        _mavlinkMessageReceived(link, message);
+    });
 }
 
 APMSensorsComponentController::~APMSensorsComponentController()
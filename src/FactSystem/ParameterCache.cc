@@ -0,0 +1,317 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterCache.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QSaveFile>
+#include <QHash>
+#include <QDebug>
+
+#include <string.h>
+
+ParameterCache::ParameterCache(void)
+    : _map(NULL)
+    , _header(NULL)
+    , _records(NULL)
+    , _names(NULL)
+    , _count(0)
+{
+    Q_STATIC_ASSERT(sizeof(Header_t) == 24);
+    Q_STATIC_ASSERT(sizeof(Record_t) == 24);
+}
+
+ParameterCache::~ParameterCache()
+{
+    close();
+}
+
+bool ParameterCache::open(const QString& fileName)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 fileSize = _file.size();
+    if (fileSize < (qint64)sizeof(Header_t)) {
+        qCDebug(ParameterManagerLog) << "Parameter cache too small" << fileName;
+        close();
+        return false;
+    }
+
+    _map = _file.map(0, fileSize);
+    if (!_map) {
+        qWarning() << "Unable to map parameter cache" << fileName << _file.errorString();
+        close();
+        return false;
+    }
+
+    _header = reinterpret_cast<const Header_t*>(_map);
+    if (_header->magic != _magic || _header->version != _version || _header->recordSize != sizeof(Record_t)) {
+        // Most likely a cache written by an older version, it is replaced once the parameters are loaded
+        qCDebug(ParameterManagerLog) << "Parameter cache format not supported" << fileName;
+        close();
+        return false;
+    }
+    if ((qint64)sizeof(Header_t) + ((qint64)_header->count * sizeof(Record_t)) + _header->namesSize != fileSize) {
+        qWarning() << "Parameter cache size mismatch" << fileName;
+        close();
+        return false;
+    }
+
+    _records = reinterpret_cast<const Record_t*>(_map + sizeof(Header_t));
+    _names = reinterpret_cast<const char*>(_records + _header->count);
+    for (quint32 i = 0; i < _header->count; i++) {
+        const Record_t& record = _records[i];
+        if ((quint64)record.nameOffset + record.nameLength > _header->namesSize || !_isSupportedType(record.type)) {
+            qWarning() << "Parameter cache record malformed" << fileName << i;
+            close();
+            return false;
+        }
+    }
+    _count = _header->count;
+
+    return true;
+}
+
+void ParameterCache::close(void)
+{
+    if (_map) {
+        _file.unmap(const_cast<uchar*>(_map));
+    }
+    _file.close();
+    _map = NULL;
+    _header = NULL;
+    _records = NULL;
+    _names = NULL;
+    _count = 0;
+}
+
+quint32 ParameterCache::hash(void) const
+{
+    return _header ? _header->hash : 0;
+}
+
+bool ParameterCache::verify(void) const
+{
+    quint32 crc = 0;
+    for (int i = 0; i < _count; i++) {
+        const Record_t& record = _records[i];
+        crc = _crc(_names + record.nameOffset, record.nameLength, record.value, (FactMetaData::ValueType_t)record.type, crc);
+        if (crc != record.crc) {
+            qWarning() << "Parameter cache record CRC mismatch" << _file.fileName() << name(i);
+            return false;
+        }
+    }
+    return crc == hash();
+}
+
+int ParameterCache::index(int record) const
+{
+    return _records[record].index;
+}
+
+QString ParameterCache::name(int record) const
+{
+    return QString::fromLatin1(_names + _records[record].nameOffset, _records[record].nameLength);
+}
+
+FactMetaData::ValueType_t ParameterCache::type(int record) const
+{
+    return (FactMetaData::ValueType_t)_records[record].type;
+}
+
+QVariant ParameterCache::value(int record) const
+{
+    const quint8* bytes = _records[record].value;
+
+    // Match the QVariant types UAS::processParamValueMsg creates, so the first real update does not look like a change
+    switch (type(record)) {
+    case FactMetaData::valueTypeUint8:
+    {
+        quint8 value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeInt8:
+    {
+        qint8 value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeUint16:
+    {
+        quint16 value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeInt16:
+    {
+        qint16 value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeUint32:
+    {
+        quint32 value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeInt32:
+    {
+        qint32 value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeFloat:
+    {
+        float value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double value;
+        memcpy(&value, bytes, sizeof(value));
+        return QVariant(value);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+bool ParameterCache::save(const QString& fileName, const QList<Entry_t>& entries, quint32& hash)
+{
+    QVector<Record_t> records(entries.count());
+    QByteArray names;
+    QHash<QString, quint32> nameOffsets;
+
+    quint32 crc = 0;
+    for (int i = 0; i < entries.count(); i++) {
+        const Entry_t& entry = entries[i];
+        Record_t& record = records[i];
+        memset(&record, 0, sizeof(record));
+
+        if (!_isSupportedType(entry.type)) {
+            qWarning() << "Unsupported parameter cache type" << entry.name << entry.type;
+            return false;
+        }
+
+        QByteArray name = entry.name.toLatin1();
+        QHash<QString, quint32>::const_iterator interned = nameOffsets.constFind(entry.name);
+        if (interned == nameOffsets.constEnd()) {
+            record.nameOffset = names.size();
+            nameOffsets.insert(entry.name, record.nameOffset);
+            names.append(name);
+        } else {
+            record.nameOffset = interned.value();
+        }
+        record.index = entry.index;
+        record.nameLength = name.size();
+        record.type = entry.type;
+
+        switch (entry.type) {
+        case FactMetaData::valueTypeUint8:
+        case FactMetaData::valueTypeInt8:
+        {
+            quint8 value = (quint8)entry.value.toInt();
+            memcpy(record.value, &value, sizeof(value));
+            break;
+        }
+        case FactMetaData::valueTypeUint16:
+        case FactMetaData::valueTypeInt16:
+        {
+            quint16 value = (quint16)entry.value.toInt();
+            memcpy(record.value, &value, sizeof(value));
+            break;
+        }
+        case FactMetaData::valueTypeUint32:
+        {
+            quint32 value = entry.value.toUInt();
+            memcpy(record.value, &value, sizeof(value));
+            break;
+        }
+        case FactMetaData::valueTypeInt32:
+        {
+            qint32 value = entry.value.toInt();
+            memcpy(record.value, &value, sizeof(value));
+            break;
+        }
+        case FactMetaData::valueTypeFloat:
+        {
+            float value = entry.value.toFloat();
+            memcpy(record.value, &value, sizeof(value));
+            break;
+        }
+        default:
+        {
+            double value = entry.value.toDouble();
+            memcpy(record.value, &value, sizeof(value));
+            break;
+        }
+        }
+
+        crc = _crc(name.constData(), name.size(), record.value, entry.type, crc);
+        record.crc = crc;
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = _magic;
+    header.version = _version;
+    header.recordSize = sizeof(Record_t);
+    header.count = records.count();
+    header.hash = crc;
+    header.namesSize = names.size();
+
+    // Write through a temporary file so a reader never maps a partially written cache
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write parameter cache" << fileName << file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.constData()), records.count() * sizeof(Record_t));
+    file.write(names);
+    if (!file.commit()) {
+        qWarning() << "Unable to write parameter cache" << fileName << file.errorString();
+        return false;
+    }
+
+    hash = crc;
+    return true;
+}
+
+bool ParameterCache::_isSupportedType(int type)
+{
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeUint32:
+    case FactMetaData::valueTypeInt32:
+    case FactMetaData::valueTypeFloat:
+    case FactMetaData::valueTypeDouble:
+        return true;
+    default:
+        return false;
+    }
+}
+
+quint32 ParameterCache::_crc(const char* name, int nameLength, const quint8* value, FactMetaData::ValueType_t type, quint32 crc)
+{
+    crc = QGC::crc32(reinterpret_cast<const quint8*>(name), nameLength, crc);
+    return QGC::crc32(value, FactMetaData::typeToSize(type), crc);
+}
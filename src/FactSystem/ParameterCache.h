@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterCache_H
+#define ParameterCache_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+#include "FactMetaData.h"
+
+/// Binary parameter cache for one vehicle component, read straight from a memory map.
+///
+/// The file is a fixed size header holding the hash of the whole parameter set, followed by one fixed width
+/// record per parameter in index order and a table with the parameter names. Each record stores the running
+/// parameter set CRC up to and including itself, so a damaged record is found while checking the set hash.
+/// The hash is computed the same way as the vehicle computes its _HASH_CHECK value.
+class ParameterCache
+{
+public:
+    ParameterCache(void);
+    ~ParameterCache();
+
+    /// Parameter to write to a cache file
+    typedef struct {
+        int                         index;
+        QString                     name;
+        FactMetaData::ValueType_t   type;
+        QVariant                    value;
+    } Entry_t;
+
+    /// Maps the specified cache file
+    /// @return false: file missing, in an older format or malformed
+    bool open(const QString& fileName);
+
+    void close(void);
+
+    /// @return Number of parameters in the open cache
+    int count(void) const { return _count; }
+
+    /// @return Parameter set hash stored in the header of the open cache
+    quint32 hash(void) const;
+
+    /// Recomputes the parameter set hash from the records
+    /// @return false: a record does not match its stored CRC, or the set does not match the header hash
+    bool verify(void) const;
+
+    int                         index   (int record) const;
+    QString                     name    (int record) const;
+    FactMetaData::ValueType_t   type    (int record) const;
+
+    /// @return Value with the same QVariant type as a parameter value received from the vehicle
+    QVariant                    value   (int record) const;
+
+    /// Writes a cache file for the specified parameters, which must be sorted by index
+    ///     @param[out] hash Parameter set hash of the written file
+    /// @return false: unable to write file
+    static bool save(const QString& fileName, const QList<Entry_t>& entries, quint32& hash);
+
+private:
+    typedef struct {
+        quint32 magic;
+        quint16 version;
+        quint16 recordSize;
+        quint32 count;
+        quint32 hash;
+        quint32 namesSize;
+        quint32 reserved;
+    } Header_t;
+
+    typedef struct {
+        quint32 index;
+        quint32 nameOffset;     ///< Offset into name table
+        quint16 nameLength;
+        quint8  type;           ///< FactMetaData::ValueType_t
+        quint8  reserved;
+        quint32 crc;            ///< Parameter set CRC up to and including this parameter
+        quint8  value[8];       ///< Value bytes as sent by the vehicle, zero padded
+    } Record_t;
+
+    static bool _isSupportedType(int type);
+    static quint32 _crc(const char* name, int nameLength, const quint8* value, FactMetaData::ValueType_t type, quint32 crc);
+
+    QFile           _file;
+    const uchar*    _map;
+    const Header_t* _header;
+    const Record_t* _records;
+    const char*     _names;
+    int             _count;
+
+    static const quint32 _magic = 0x43504751;  ///< "QGPC"
+    static const quint16 _version = 1;
+};
+
+#endif
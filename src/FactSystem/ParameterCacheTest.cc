@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterCacheTest.h"
+#include "QGC.h"
+
+#include <QDataStream>
+
+ParameterCacheTest::ParameterCacheTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void ParameterCacheTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+    _cacheFilename = _tempDir->path() + QStringLiteral("/1_1");
+}
+
+void ParameterCacheTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanup();
+}
+
+/// One parameter of each supported type, with the QVariant types UAS creates for them
+QList<ParameterCache::Entry_t> ParameterCacheTest::_entries(void)
+{
+    QList<ParameterCache::Entry_t> entries;
+
+    ParameterCache::Entry_t entry;
+    entry = { 0, QStringLiteral("BAT_N_CELLS"),     FactMetaData::valueTypeUint8,   QVariant((int)200) };          entries.append(entry);
+    entry = { 1, QStringLiteral("CAL_ACC0_ID"),     FactMetaData::valueTypeInt8,    QVariant((int)-5) };           entries.append(entry);
+    entry = { 2, QStringLiteral("COM_RC_LOSS_T"),   FactMetaData::valueTypeUint16,  QVariant((int)60000) };        entries.append(entry);
+    entry = { 3, QStringLiteral("MAV_SYS_ID"),      FactMetaData::valueTypeInt16,   QVariant((int)-30000) };       entries.append(entry);
+    entry = { 4, QStringLiteral("SYS_AUTOSTART"),   FactMetaData::valueTypeUint32,  QVariant((uint)4001) };        entries.append(entry);
+    entry = { 5, QStringLiteral("SYS_AUTOCONFIG"),  FactMetaData::valueTypeInt32,   QVariant((int)-1) };           entries.append(entry);
+    entry = { 7, QStringLiteral("MPC_XY_VEL_MAX"),  FactMetaData::valueTypeFloat,   QVariant(12.5f) };             entries.append(entry);
+    entry = { 8, QStringLiteral("SENS_BOARD_X_OFF"),FactMetaData::valueTypeDouble,  QVariant(0.125) };             entries.append(entry);
+
+    return entries;
+}
+
+void ParameterCacheTest::_saveLoad_test(void)
+{
+    QList<ParameterCache::Entry_t> entries = _entries();
+
+    quint32 hash;
+    QVERIFY(ParameterCache::save(_cacheFilename, entries, hash));
+
+    ParameterCache cache;
+    QVERIFY(cache.open(_cacheFilename));
+    QCOMPARE(cache.count(), entries.count());
+    QCOMPARE(cache.hash(), hash);
+    QVERIFY(cache.verify());
+
+    for (int i = 0; i < entries.count(); i++) {
+        QCOMPARE(cache.index(i), entries[i].index);
+        QCOMPARE(cache.name(i), entries[i].name);
+        QCOMPARE(cache.type(i), entries[i].type);
+        QCOMPARE(cache.value(i), entries[i].value);
+        QCOMPARE(cache.value(i).type(), entries[i].value.type());
+    }
+}
+
+/// The header hash must match the _HASH_CHECK value the vehicle computes over names and value bytes
+void ParameterCacheTest::_hash_test(void)
+{
+    QList<ParameterCache::Entry_t> entries = _entries();
+
+    quint32 crc = 0;
+    foreach (const ParameterCache::Entry_t& entry, entries) {
+        quint8 bytes[8];
+        memset(bytes, 0, sizeof(bytes));
+        switch (entry.type) {
+        case FactMetaData::valueTypeFloat:
+        {
+            float value = entry.value.toFloat();
+            memcpy(bytes, &value, sizeof(value));
+            break;
+        }
+        case FactMetaData::valueTypeDouble:
+        {
+            double value = entry.value.toDouble();
+            memcpy(bytes, &value, sizeof(value));
+            break;
+        }
+        default:
+        {
+            qint32 value = entry.value.toInt();
+            memcpy(bytes, &value, sizeof(value));
+            break;
+        }
+        }
+        QByteArray name = entry.name.toLatin1();
+        crc = QGC::crc32((const quint8*)name.constData(), name.size(), crc);
+        crc = QGC::crc32(bytes, FactMetaData::typeToSize(entry.type), crc);
+    }
+
+    quint32 hash;
+    QVERIFY(ParameterCache::save(_cacheFilename, entries, hash));
+    QCOMPARE(hash, crc);
+}
+
+void ParameterCacheTest::_corrupt_test(void)
+{
+    quint32 hash;
+    QVERIFY(ParameterCache::save(_cacheFilename, _entries(), hash));
+
+    // Flip a byte in the name table, the header still matches but the records do not
+    QFile file(_cacheFilename);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray bytes = file.readAll();
+    bytes[bytes.size() - 1] = bytes[bytes.size() - 1] ^ 0x20;
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.write(bytes), (qint64)bytes.size());
+    file.close();
+
+    ParameterCache cache;
+    QVERIFY(cache.open(_cacheFilename));
+    QCOMPARE(cache.hash(), hash);
+    QVERIFY(!cache.verify());
+    cache.close();
+
+    // Truncated file
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(bytes.size() - 3));
+    file.close();
+    QVERIFY(!cache.open(_cacheFilename));
+}
+
+/// Caches written by previous versions through QDataStream are ignored
+void ParameterCacheTest::_oldFormat_test(void)
+{
+    QMap<int, QPair<QString, QPair<int, QVariant> > > oldMap;
+    oldMap[0] = qMakePair(QStringLiteral("SYS_AUTOSTART"), qMakePair((int)FactMetaData::valueTypeUint32, QVariant((uint)4001)));
+
+    QFile file(_cacheFilename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QDataStream ds(&file);
+    ds << oldMap;
+    file.close();
+
+    ParameterCache cache;
+    QVERIFY(!cache.open(_cacheFilename));
+    QCOMPARE(cache.count(), 0);
+}
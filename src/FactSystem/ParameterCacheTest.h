@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterCacheTest_H
+#define ParameterCacheTest_H
+
+#include "UnitTest.h"
+#include "ParameterCache.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for the binary parameter cache file
+class ParameterCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterCacheTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _saveLoad_test(void);
+    void _hash_test(void);
+    void _corrupt_test(void);
+    void _oldFormat_test(void);
+
+private:
+    QList<ParameterCache::Entry_t> _entries(void);
+
+    QTemporaryDir*  _tempDir;
+    QString         _cacheFilename;
+};
+
+#endif
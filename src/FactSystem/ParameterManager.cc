@@ -19,6 +19,7 @@
 #include "FirmwarePlugin.h"
 #include "UAS.h"
 #include "JsonHelper.h"
+#include "ParameterCache.h"
 
 #include <QEasingCurve>
 #include <QFile>
@@ -26,11 +27,6 @@
 #include <QVariantAnimation>
 #include <QJsonArray>
 
-/* types for local parameter cache */
-typedef QPair<int, QVariant> ParamTypeVal;
-typedef QPair<QString, ParamTypeVal> NamedParam;
-typedef QMap<int, NamedParam> MapID2NamedParam;
-
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose1Log, "ParameterManagerVerbose1Log")
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose2Log, "ParameterManagerVerbose2Log")
 
@@ -77,14 +73,18 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     connect(&_initialRequestTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_initialRequestTimeout);
 
     _waitingParamTimeoutTimer.setSingleShot(true);
-    _waitingParamTimeoutTimer.setInterval(3000);
+    _waitingParamTimeoutTimer.setInterval(_waitingParamTimeoutMSecs);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _indexRequestTimeoutTimer.setSingleShot(true);
+    connect(&_indexRequestTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_indexRequestTimeout);
+
     connect(_vehicle->uas(), &UASInterface::parameterUpdate, this, &ParameterManager::_parameterUpdate);
 
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 
+    _loadTimer.start();
     refreshAllParameters();
 }
 
@@ -159,40 +159,39 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     // If we've never seen this component id before, setup the wait lists.
     if (!_waitingReadParamIndexMap.contains(componentId)) {
         // Add all indices to the wait list, parameter index is 0-based
-        for (int waitingIndex=0; waitingIndex<parameterCount; waitingIndex++) {
-            // This will add the new component id, as well as the the new waiting index and set the retry count for that index to 0
-            _waitingReadParamIndexMap[componentId][waitingIndex] = 0;
-        }
+        _setWaitingIndices(componentId, parameterCount);
 
         // The read and write waiting lists for this component are initialized the empty
-        _waitingReadParamNameMap[componentId] = QMap<QString, int>();
-        _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
+        _waitingReadParamNameMap[componentId] = QHash<QString, int>();
+        _waitingWriteParamNameMap[componentId] = QHash<QString, int>();
 
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Seeing component for first time - paramcount:" << parameterCount;
     }
 
+    const WaitingIndices_t& waitingIndices = _waitingReadParamIndexMap[componentId];
+
     bool componentParamsComplete = false;
-    if (_waitingReadParamIndexMap[componentId].count() == 1) {
+    if (waitingIndices.waitingCount == 1) {
         // We need to know when we get the last param from a component in order to complete setup
         componentParamsComplete = true;
     }
 
-    if (!_waitingReadParamIndexMap[componentId].contains(parameterId) &&
+    bool waitingIndex = parameterId >= 0 && parameterId < waitingIndices.waiting.size() && waitingIndices.waiting.testBit(parameterId);
+    if (!waitingIndex &&
         !_waitingReadParamNameMap[componentId].contains(parameterName) &&
         !_waitingWriteParamNameMap[componentId].contains(parameterName)) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "Unrequested param update" << parameterName;
     }
 
     // Remove this parameter from the waiting lists
-    if (_waitingReadParamIndexMap[componentId].contains(parameterId)) {
-        _waitingReadParamIndexMap[componentId].remove(parameterId);
-        _indexBatchQueue.removeOne(parameterId);
+    if (waitingIndex) {
+        _clearWaitingIndex(componentId, parameterId);
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
     _waitingWriteParamNameMap[componentId].remove(parameterName);
-    if (_waitingReadParamIndexMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
+    if (_waitingReadParamIndexMap[componentId].waitingCount) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count:" << _waitingReadParamIndexMap[componentId].waitingCount;
     }
     if (_waitingReadParamNameMap[componentId].count()) {
         qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
@@ -208,7 +207,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
     int waitingWriteParamNameCount = 0;
 
     foreach(int waitingComponentId, _waitingReadParamIndexMap.keys()) {
-        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].count();
+        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].waitingCount;
     }
     if (waitingReadParamIndexCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamIndexCount:" << waitingReadParamIndexCount;
@@ -235,7 +234,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         _waitingParamTimeoutTimer.start();
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
     } else {
-        if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+        if (!_parameters.contains(_vehicle->defaultComponentId())) {
             // Still waiting for parameters from default component
             qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer (still waiting for default component params)";
             _waitingParamTimeoutTimer.start();
@@ -260,7 +259,8 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         _parameterSetMajorVersion = value.toInt();
     }
 
-    if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(parameterName)) {
+    Fact* fact = _parameters.find(componentId, parameterName);
+    if (!fact) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
         FactMetaData::ValueType_t factType;
@@ -295,9 +295,9 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
                 break;
         }
 
-        Fact* fact = new Fact(componentId, parameterName, factType, this);
+        fact = new Fact(componentId, parameterName, factType, this);
 
-        _mapParameterName2Variant[componentId][parameterName] = QVariant::fromValue(fact);
+        _parameters.insert(fact);
 
         // We need to know when the fact changes from QML so that we can send the new value to the parameter manager
         connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_valueUpdated);
@@ -305,15 +305,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
 
     _dataMutex.unlock();
 
-    Fact* fact = NULL;
-    if (_mapParameterName2Variant[componentId].contains(parameterName)) {
-        fact = _mapParameterName2Variant[componentId][parameterName].value<Fact*>();
-    }
-    if (fact) {
-        fact->_containerSetRawValue(value);
-    } else {
-        qWarning() << "Internal error";
-    }
+    fact->_containerSetRawValue(value);
 
     if (componentParamsComplete) {
         if (componentId == _vehicle->defaultComponentId()) {
@@ -404,10 +396,7 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
         // Add/Update all indices to the wait list, parameter index is 0-based
         if(componentId != MAV_COMP_ID_ALL && componentId != cid)
             continue;
-        for (int waitingIndex = 0; waitingIndex < _paramCountMap[cid]; waitingIndex++) {
-            // This will add a new waiting index if needed and set the retry count for that index to 0
-            _waitingReadParamIndexMap[cid][waitingIndex] = 0;
-        }
+        _setWaitingIndices(cid, _paramCountMap[cid]);
     }
 
     _dataMutex.unlock();
@@ -468,7 +457,7 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
     componentId = _actualComponentId(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "refreshParametersPrefix - name:" << namePrefix << ")";
 
-    foreach(const QString &name, _mapParameterName2Variant[componentId].keys()) {
+    foreach(const QString &name, _parameters.names(componentId)) {
         if (name.startsWith(namePrefix)) {
             refreshParameter(componentId, name);
         }
@@ -477,14 +466,7 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
 
 bool ParameterManager::parameterExists(int componentId, const QString&  name)
 {
-    bool ret = false;
-
-    componentId = _actualComponentId(componentId);
-    if (_mapParameterName2Variant.contains(componentId)) {
-        ret = _mapParameterName2Variant[componentId].contains(_remapParamNameToVersion(name));
-    }
-
-    return ret;
+    return _parameters.contains(_actualComponentId(componentId), _remapParamNameToVersion(name));
 }
 
 Fact* ParameterManager::getParameter(int componentId, const QString& name)
@@ -492,23 +474,18 @@ Fact* ParameterManager::getParameter(int componentId, const QString& name)
     componentId = _actualComponentId(componentId);
 
     QString mappedParamName = _remapParamNameToVersion(name);
-    if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(mappedParamName)) {
+    Fact* fact = _parameters.find(componentId, mappedParamName);
+    if (!fact) {
         qgcApp()->reportMissingParameter(componentId, mappedParamName);
         return &_defaultFact;
     }
 
-    return _mapParameterName2Variant[componentId][mappedParamName].value<Fact*>();
+    return fact;
 }
 
 QStringList ParameterManager::parameterNames(int componentId)
 {
-    QStringList names;
-
-    foreach(const QString &paramName, _mapParameterName2Variant[_actualComponentId(componentId)].keys()) {
-        names << paramName;
-    }
-
-    return names;
+    return _parameters.names(_actualComponentId(componentId));
 }
 
 void ParameterManager::_setupGroupMap(void)
@@ -516,10 +493,9 @@ void ParameterManager::_setupGroupMap(void)
     // Must be able to handle being called multiple times
     _mapGroup2ParameterName.clear();
 
-    foreach (int componentId, _mapParameterName2Variant.keys()) {
-        foreach (const QString &name, _mapParameterName2Variant[componentId].keys()) {
-            Fact* fact = _mapParameterName2Variant[componentId][name].value<Fact*>();
-            _mapGroup2ParameterName[componentId][fact->group()] += name;
+    foreach (int componentId, _parameters.componentIds()) {
+        foreach (Fact* fact, _parameters.facts(componentId)) {
+            _mapGroup2ParameterName[componentId][fact->group()] += fact->name();
         }
     }
 }
@@ -529,8 +505,8 @@ const QMap<int, QMap<QString, QStringList> >& ParameterManager::getGroupMap(void
     return _mapGroup2ParameterName;
 }
 
-/// Requests missing index based parameters from the vehicle.
-///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the batch queue
+/// Requests missing index based parameters from the vehicle, as many as the request window allows.
+///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the request window
 /// return true: Parameters were requested, false: No more requests needed
 bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
 {
@@ -538,48 +514,104 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         return false;
     }
 
-    const int maxBatchSize = 10;
-
     if (waitingParamTimeout) {
-        // We timed out, clear the queue and try again
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to timeout";
-        _indexBatchQueue.clear();
+        // We timed out, whatever is still in flight is lost
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Refilling index based request window due to timeout - window:" << _requestWindow.window() << "inFlight:" << _requestWindow.inFlight();
+        for (QMap<int, WaitingIndices_t>::iterator ite = _waitingReadParamIndexMap.begin(); ite != _waitingReadParamIndexMap.end(); ++ite) {
+            ite.value().requested.fill(false);
+            ite.value().requestedCount = 0;
+        }
+        _requestWindow.requestsLost();
     } else {
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "Refilling index based request window due to received parameter - window:" << _requestWindow.window();
     }
 
-    foreach(int componentId, _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
+    for (QMap<int, WaitingIndices_t>::iterator ite = _waitingReadParamIndexMap.begin(); ite != _waitingReadParamIndexMap.end(); ++ite) {
+        int componentId = ite.key();
+        WaitingIndices_t& waitingIndices = ite.value();
+
+        if (waitingParamTimeout && waitingIndices.waitingCount) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << waitingIndices.waitingCount;
         }
 
-        foreach(int paramIndex, _waitingReadParamIndexMap[componentId].keys()) {
-            if (_indexBatchQueue.contains(paramIndex)) {
-                // Don't add more than once
+        // Continue the scan where the last one stopped, so each missing index gets its turn
+        int indexCount = waitingIndices.waiting.size();
+        while (_requestWindow.isOpen() && waitingIndices.waitingCount > waitingIndices.requestedCount) {
+            int paramIndex = waitingIndices.scanIndex;
+            waitingIndices.scanIndex = (paramIndex + 1) % indexCount;
+            if (!waitingIndices.waiting.testBit(paramIndex) || waitingIndices.requested.testBit(paramIndex)) {
                 continue;
             }
 
-            if (_indexBatchQueue.count() > maxBatchSize) {
-                break;
-            }
-
-            _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
-            if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
+            waitingIndices.retryCount[paramIndex]++;
+            if (_disableAllRetries || waitingIndices.retryCount[paramIndex] > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
                 _failedReadParamIndexMap[componentId] << paramIndex;
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-                _waitingReadParamIndexMap[componentId].remove(paramIndex);
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << waitingIndices.retryCount[paramIndex] << ")";
+                waitingIndices.waiting.clearBit(paramIndex);
+                waitingIndices.waitingCount--;
             } else {
                 // Retry again
-                _indexBatchQueue.append(paramIndex);
+                waitingIndices.requested.setBit(paramIndex);
+                waitingIndices.requestedCount++;
+                waitingIndices.requestTime[paramIndex] = _loadTimer.elapsed();
+                _requestWindow.requestSent();
                 _readParameterRaw(componentId, "", paramIndex);
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
+                qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << waitingIndices.retryCount[paramIndex] << ")";
             }
         }
     }
 
-    return _indexBatchQueue.count() != 0;
+    // Re-requests in flight time out after the link round trip time. This has its own timer, the name based
+    // read/write retries keep the fixed _waitingParamTimeoutTimer interval.
+    bool paramsRequested = _requestWindow.inFlight() != 0;
+    if (paramsRequested) {
+        _indexRequestTimeoutTimer.start(_requestWindow.retransmitTimeoutMSecs());
+    } else {
+        _indexRequestTimeoutTimer.stop();
+    }
+
+    return paramsRequested;
+}
+
+/// Marks all parameter indices of a component as waiting, dropping any re-requests in flight
+void ParameterManager::_setWaitingIndices(int componentId, int parameterCount)
+{
+    WaitingIndices_t& waitingIndices = _waitingReadParamIndexMap[componentId];
+
+    _requestWindow.requestsCancelled(waitingIndices.requestedCount);
+
+    waitingIndices.waiting.fill(true, parameterCount);
+    waitingIndices.requested.fill(false, parameterCount);
+    waitingIndices.retryCount.fill(0, parameterCount);
+    waitingIndices.requestTime.fill(0, parameterCount);
+    waitingIndices.waitingCount = parameterCount;
+    waitingIndices.requestedCount = 0;
+    waitingIndices.scanIndex = 0;
+}
+
+void ParameterManager::_clearWaitingIndex(int componentId, int paramIndex)
+{
+    WaitingIndices_t& waitingIndices = _waitingReadParamIndexMap[componentId];
+
+    waitingIndices.waiting.clearBit(paramIndex);
+    waitingIndices.waitingCount--;
+    if (waitingIndices.requested.testBit(paramIndex)) {
+        waitingIndices.requested.clearBit(paramIndex);
+        waitingIndices.requestedCount--;
+        // A response to a repeated request may belong to any of them, which makes its round trip time useless
+        qint64 rtt = waitingIndices.retryCount[paramIndex] == 1 ? _loadTimer.elapsed() - waitingIndices.requestTime[paramIndex] : -1;
+        _requestWindow.responseReceived(rtt);
+    }
+}
+
+/// Index based re-requests went unanswered for the retransmit timeout, they are lost
+void ParameterManager::_indexRequestTimeout(void)
+{
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "_indexRequestTimeout";
+
+    // Completion and the remaining retries are handled by _waitingParamTimeout, which still runs
+    _fillIndexBatchQueue(true /* waitingParamTimeout */);
 }
 
 void ParameterManager::_waitingParamTimeout(void)
@@ -596,10 +628,10 @@ void ParameterManager::_waitingParamTimeout(void)
     // First check for any missing parameters from the initial index based load
     paramsRequested = _fillIndexBatchQueue(true /* waitingParamTimeout */);
 
-    if (!paramsRequested && !_waitingForDefaultComponent && !_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+    if (!paramsRequested && !_waitingForDefaultComponent && !_parameters.contains(_vehicle->defaultComponentId())) {
         // Initial load is complete but we still don't have any default component params. Wait one more cycle to see if the
         // any show up.
-        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId() << _mapParameterName2Variant.keys();
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId() << _parameters.componentIds();
         _waitingParamTimeoutTimer.start();
         _waitingForDefaultComponent = true;
         return;
@@ -737,19 +769,20 @@ void ParameterManager::_writeParameterRaw(int componentId, const QString& paramN
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    MapID2NamedParam cache_map;
+    QList<ParameterCache::Entry_t> entries;
 
-    foreach(int id, _mapParameterId2Name[componentId].keys()) {
-        const QString name(_mapParameterId2Name[componentId][id]);
-        const Fact *fact = _mapParameterName2Variant[componentId][name].value<Fact*>();
-        cache_map[id] = NamedParam(name, ParamTypeVal(fact->type(), fact->rawValue()));
+    // Parameter set hash is computed in index order
+    const QMap<int, QString>& id2Name = _mapParameterId2Name[componentId];
+    for (QMap<int, QString>::const_iterator ite = id2Name.constBegin(); ite != id2Name.constEnd(); ++ite) {
+        const Fact* fact = _parameters.find(componentId, ite.value());
+        ParameterCache::Entry_t entry = { ite.key(), ite.value(), fact->type(), fact->rawValue() };
+        entries.append(entry);
     }
 
-    QFile cache_file(parameterCacheFile(vehicleId, componentId));
-    cache_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
-
-    QDataStream ds(&cache_file);
-    ds << cache_map;
+    quint32 hash;
+    if (ParameterCache::save(parameterCacheFile(vehicleId, componentId), entries, hash)) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Parameter cache written - count:hash" << entries.count() << hash;
+    }
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -765,41 +798,24 @@ QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    MapID2NamedParam cache_map;
-    QFile cache_file(parameterCacheFile(vehicleId, componentId));
-    if (!cache_file.exists()) {
-        /* no local cache, just wait for them to come in*/
+    ParameterCache cache;
+    if (!cache.open(parameterCacheFile(vehicleId, componentId))) {
+        /* no usable local cache, just wait for them to come in*/
         return;
     }
-    cache_file.open(QIODevice::ReadOnly);
 
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cache_file);
-    ds >> cache_map;
-
-    /* compute the crc of the local cache to check against the remote */
-
-    foreach(int id, cache_map.keys()) {
-        const QString name(cache_map[id].first);
-        const void *vdat = cache_map[id].second.second.constData();
-        const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(cache_map[id].second.first);
-        crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-        crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
+    /* the header carries the hash of the cached set, only check the records if it matches the remote */
+    uint32_t crc32_value = cache.hash();
+    if (crc32_value != hash_value.toUInt()) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Parameter cache out of date - local:remote" << crc32_value << hash_value.toUInt();
+        return;
     }
 
-    if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cache_file).absoluteFilePath());
+    if (cache.verify()) {
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(parameterCacheFile(vehicleId, componentId));
         /* if the two param set hashes match, just load from the disk */
-        int count = cache_map.count();
-        foreach(int id, cache_map.keys()) {
-            const QString &name = cache_map[id].first;
-            const QVariant &value = cache_map[id].second.second;
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(cache_map[id].second.first);
-            const int mavType = _factTypeToMavType(fact_type);
-            _parameterUpdate(vehicleId, componentId, name, count, id, mavType, value);
-        }
+        _loadParameterCache(componentId, cache);
+
         // Return the hash value to notify we don't want any more updates
         mavlink_param_set_t     p;
         mavlink_param_union_t   union_value;
@@ -840,6 +856,83 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     }
 }
 
+/// Creates the Facts for a component from a parameter cache hit. The whole set is known at once, so this skips the
+/// per parameter wait list bookkeeping and progress updates of _parameterUpdate.
+void ParameterManager::_loadParameterCache(int componentId, const ParameterCache& cache)
+{
+    int count = cache.count();
+
+    _initialRequestTimeoutTimer.stop();
+    _waitingParamTimeoutTimer.stop();
+
+    _dataMutex.lock();
+
+    if (!_paramCountMap.contains(componentId)) {
+        _paramCountMap[componentId] = count;
+        _totalParamCount += count;
+    }
+
+    QMap<int, QString>& id2Name = _mapParameterId2Name[componentId];
+    QVector<Fact*> facts(count);
+    for (int i = 0; i < count; i++) {
+        QString name = cache.name(i);
+        id2Name[cache.index(i)] = name;
+
+        Fact* fact = _parameters.find(componentId, name);
+        if (!fact) {
+            fact = new Fact(componentId, name, cache.type(i), this);
+            _parameters.insert(fact);
+            connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_valueUpdated);
+        }
+        facts[i] = fact;
+
+        if (!_versionParam.isEmpty() && _versionParam == name) {
+            _parameterSetMajorVersion = cache.value(i).toInt();
+        }
+    }
+
+    // Nothing left to read from this component
+    _setWaitingIndices(componentId, 0);
+    _waitingReadParamNameMap[componentId].clear();
+    if (!_waitingWriteParamNameMap.contains(componentId)) {
+        _waitingWriteParamNameMap[componentId] = QHash<QString, int>();
+    }
+
+    int waitingReadParamIndexCount = 0;
+    int waitingReadParamNameCount = 0;
+    int waitingWriteParamNameCount = 0;
+    foreach(int waitingComponentId, _waitingReadParamIndexMap.keys()) {
+        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].waitingCount;
+    }
+    foreach(int waitingComponentId, _waitingReadParamNameMap.keys()) {
+        waitingReadParamNameCount += _waitingReadParamNameMap[waitingComponentId].count();
+    }
+    foreach(int waitingComponentId, _waitingWriteParamNameMap.keys()) {
+        waitingWriteParamNameCount += _waitingWriteParamNameMap[waitingComponentId].count();
+    }
+    _dataMutex.unlock();
+
+    for (int i = 0; i < count; i++) {
+        facts[i]->_containerSetRawValue(cache.value(i));
+    }
+
+    if (componentId == _vehicle->defaultComponentId()) {
+        _addMetaDataToDefaultComponent();
+    }
+    _setupGroupMap();
+
+    if (waitingReadParamIndexCount + waitingReadParamNameCount + waitingWriteParamNameCount != 0) {
+        // Other components are still loading
+        _waitingParamTimeoutTimer.start();
+    }
+
+    _prevWaitingReadParamIndexCount = waitingReadParamIndexCount;
+    _prevWaitingReadParamNameCount = waitingReadParamNameCount;
+    _prevWaitingWriteParamNameCount = waitingWriteParamNameCount;
+
+    _checkInitialLoadComplete();
+}
+
 void ParameterManager::_saveToEEPROM(void)
 {
     if (_saveRequired) {
@@ -919,11 +1012,10 @@ void ParameterManager::writeParametersToStream(QTextStream &stream)
     stream << "#\n";
     stream << "# Vehicle-Id Component-Id Name Value Type\n";
 
-    foreach (int componentId, _mapParameterName2Variant.keys()) {
-        foreach (const QString &paramName, _mapParameterName2Variant[componentId].keys()) {
-            Fact* fact = _mapParameterName2Variant[componentId][paramName].value<Fact*>();
+    foreach (int componentId, _parameters.componentIds()) {
+        foreach (Fact* fact, _parameters.facts(componentId)) {
             if (fact) {
-                stream << _vehicle->id() << "\t" << componentId << "\t" << paramName << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(_factTypeToMavType(fact->type())) << "\n";
+                stream << _vehicle->id() << "\t" << componentId << "\t" << fact->name() << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(_factTypeToMavType(fact->type())) << "\n";
             } else {
                 qWarning() << "Internal error: missing fact";
             }
@@ -1009,9 +1101,8 @@ void ParameterManager::_addMetaDataToDefaultComponent(void)
      _parameterMetaData = _vehicle->firmwarePlugin()->loadParameterMetaData(metaDataFile);
 
     // Loop over all parameters in default component adding meta data
-    QVariantMap& factMap = _mapParameterName2Variant[_vehicle->defaultComponentId()];
-    foreach (const QString& key, factMap.keys()) {
-        _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, factMap[key].value<Fact*>(), _vehicle->vehicleType());
+    foreach (Fact* fact, _parameters.facts(_vehicle->defaultComponentId())) {
+        _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, fact, _vehicle->vehicleType());
     }
 }
 
@@ -1023,13 +1114,13 @@ void ParameterManager::_checkInitialLoadComplete(void)
     }
 
     foreach (int componentId, _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
+        if (_waitingReadParamIndexMap[componentId].waitingCount) {
             // We are still waiting on some parameters, not done yet
             return;
         }
     }
 
-    if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+    if (!_parameters.contains(_vehicle->defaultComponentId())) {
         // No default component params yet, not done yet
         return;
     }
@@ -1037,7 +1128,14 @@ void ParameterManager::_checkInitialLoadComplete(void)
     // We aren't waiting for any more initial parameter updates, initial parameter loading is complete
     _initialLoadComplete = true;
 
-    qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Initial load complete";
+    qCInfo(ParameterManagerLog) << _logVehiclePrefix() << "Initial load complete -" <<
+                                   "msecs:" << _loadTimer.elapsed() <<
+                                   "params:" << _totalParamCount <<
+                                   "re-requests:" << _requestWindow.requestCount() <<
+                                   "responses:" << _requestWindow.responseCount() <<
+                                   "losses:" << _requestWindow.lossCount() <<
+                                   "window:" << _requestWindow.window() <<
+                                   "rtt:" << _requestWindow.smoothedRttMSecs();
 
     // Check for index based load failures
     QString indexList;
@@ -1343,7 +1441,7 @@ void ParameterManager::_loadOfflineEditingParams(void)
         }
 
         Fact* fact = new Fact(defaultComponentId, paramName, _mavTypeToFactType(paramType), this);
-        _mapParameterName2Variant[defaultComponentId][paramName] = QVariant::fromValue(fact);
+        _parameters.insert(fact);
     }
 
     _addMetaDataToDefaultComponent();
@@ -1358,7 +1456,7 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
     QStringList rgParamNames;
 
     if (componentId == MAV_COMP_ID_ALL) {
-        rgCompIds = _mapParameterName2Variant.keys();
+        rgCompIds = _parameters.componentIds();
     } else {
         rgCompIds.append(_actualComponentId(componentId));
     }
@@ -1369,7 +1467,7 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
     for (int i=0; i<rgCompIds.count(); i++) {
         int compId = rgCompIds[i];
 
-        if (!_mapParameterName2Variant.contains(compId)) {
+        if (!_parameters.contains(compId)) {
             qCDebug(ParameterManagerLog) << "ParameterManager::saveToJson no params for compId" << compId;
             continue;
         }
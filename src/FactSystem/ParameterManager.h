@@ -13,17 +13,22 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
 #include <QXmlStreamReader>
 #include <QLoggingCategory>
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QBitArray>
+#include <QElapsedTimer>
 
 #include "FactSystem.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
 #include "Vehicle.h"
+#include "ParameterRequestWindow.h"
+#include "ParameterStore.h"
 
 /// @file
 ///     @author Don Gagne <don@thegagnes.com>
@@ -31,6 +36,8 @@
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose1Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose2Log)
 
+class ParameterCache;
+
 /// Connects to Parameter Manager to load/update Facts
 class ParameterManager : public QObject
 {
@@ -131,6 +138,7 @@ protected:
     void _parameterUpdate(int vehicleId, int componentId, QString parameterName, int parameterCount, int parameterId, int mavType, QVariant value);
     void _valueUpdated(const QVariant& value);
     void _waitingParamTimeout(void);
+    void _indexRequestTimeout(void);
     void _tryCacheLookup(void);
     void _initialRequestTimeout(void);
 
@@ -142,21 +150,22 @@ private:
     void _writeParameterRaw(int componentId, const QString& paramName, const QVariant& value);
     void _writeLocalParamCache(int vehicleId, int componentId);
     void _tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value);
+    void _loadParameterCache(int componentId, const ParameterCache& cache);
     void _addMetaDataToDefaultComponent(void);
     QString _remapParamNameToVersion(const QString& paramName);
     void _loadOfflineEditingParams(void);
     QString _logVehiclePrefix(int componentId = -1);
     void _setLoadProgress(double loadProgress);
     bool _fillIndexBatchQueue(bool waitingParamTimeout);
+    void _setWaitingIndices(int componentId, int parameterCount);
+    void _clearWaitingIndex(int componentId, int paramIndex);
 
     MAV_PARAM_TYPE _factTypeToMavType(FactMetaData::ValueType_t factType);
     FactMetaData::ValueType_t _mavTypeToFactType(MAV_PARAM_TYPE mavType);
     void _saveToEEPROM(void);
     void _checkInitialLoadComplete(void);
 
-    /// First mapping is by component id
-    /// Second mapping is parameter name, to Fact* in QVariant
-    QMap<int, QVariantMap>            _mapParameterName2Variant;
+    ParameterStore                    _parameters;
 
     QMap<int, QMap<int, QString> >    _mapParameterId2Name;
     
@@ -184,21 +193,35 @@ private:
     int                 _initialRequestRetryCount;              ///< Current retry count for request list
     static const int    _maxInitialLoadRetrySingleParam = 5;    ///< Maximum retries for initial index based load of a single param
     static const int    _maxReadWriteRetry = 5;                 ///< Maximum retries read/write
+    static const int    _waitingParamTimeoutMSecs = 3000;       ///< Timeout for reads and writes outside the index re-request window
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
 
-    bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
-    QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
+    bool                    _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
+    ParameterRequestWindow  _requestWindow;         ///< Limits the index re-requests in flight
+    QElapsedTimer           _loadTimer;             ///< Time since the initial request, also time base for round trip times
+
+    /// Parameter indices of a component still waiting for
+    typedef struct {
+        QBitArray           waiting;        ///< Bit per parameter index still waiting for
+        QBitArray           requested;      ///< Bit per parameter index with a re-request in flight
+        QVector<quint8>     retryCount;     ///< Re-requests sent by parameter index
+        QVector<qint64>     requestTime;    ///< _loadTimer time of the last re-request by parameter index
+        int                 waitingCount;   ///< Number of waiting bits set
+        int                 requestedCount; ///< Number of requested bits set
+        int                 scanIndex;      ///< Parameter index the next re-request scan starts at
+    } WaitingIndices_t;
 
     QMap<int, int>                  _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
-    QMap<int, QMap<int, int> >      _waitingReadParamIndexMap;  ///< Key: Component id, Value: Map { Key: parameter index still waiting for, Value: retry count }
-    QMap<int, QMap<QString, int> >  _waitingReadParamNameMap;   ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
-    QMap<int, QMap<QString, int> >  _waitingWriteParamNameMap;  ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
+    QMap<int, WaitingIndices_t>     _waitingReadParamIndexMap;  ///< Key: Component id, Value: parameter indices still waiting for
+    QMap<int, QHash<QString, int> > _waitingReadParamNameMap;   ///< Key: Component id, Value: Hash { Key: parameter name still waiting for, Value: retry count }
+    QMap<int, QHash<QString, int> > _waitingWriteParamNameMap;  ///< Key: Component id, Value: Hash { Key: parameter name still waiting for, Value: retry count }
     QMap<int, QList<int> >          _failedReadParamIndexMap;   ///< Key: Component id, Value: failed parameter index
 
     int _totalParamCount;   ///< Number of parameters across all components
     
     QTimer _initialRequestTimeoutTimer;
     QTimer _waitingParamTimeoutTimer;
+    QTimer _indexRequestTimeoutTimer;   ///< Index based re-requests in flight, follows the link round trip time
     
     QMutex _dataMutex;
     
@@ -0,0 +1,265 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterMetaDataCache.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSettings>
+#include <QFileInfo>
+#include <QDir>
+#include <QMap>
+#include <QVector>
+#include <QDebug>
+
+#include <string.h>
+
+static QDataStream& operator<<(QDataStream& stream, const ParameterMetaDataCache::Entry_t& entry)
+{
+    return stream << entry.type << entry.group << entry.shortDescription << entry.longDescription << entry.defaultValue
+                  << entry.min << entry.max << entry.units << entry.decimalPlaces << entry.increment
+                  << entry.rebootRequired << entry.boolean << entry.values << entry.bitmask;
+}
+
+static QDataStream& operator>>(QDataStream& stream, ParameterMetaDataCache::Entry_t& entry)
+{
+    return stream >> entry.type >> entry.group >> entry.shortDescription >> entry.longDescription >> entry.defaultValue
+                  >> entry.min >> entry.max >> entry.units >> entry.decimalPlaces >> entry.increment
+                  >> entry.rebootRequired >> entry.boolean >> entry.values >> entry.bitmask;
+}
+
+ParameterMetaDataCache::ParameterMetaDataCache(void)
+    : _map(NULL)
+    , _index(NULL)
+    , _data(NULL)
+    , _count(0)
+{
+    Q_STATIC_ASSERT(sizeof(Header_t) == 24);
+    Q_STATIC_ASSERT(sizeof(Index_t) == 16);
+}
+
+ParameterMetaDataCache::~ParameterMetaDataCache()
+{
+    close();
+}
+
+bool ParameterMetaDataCache::readSource(const QString& metaDataFile, QByteArray& xml, quint32& hash)
+{
+    QFile xmlFile(metaDataFile);
+    if (!xmlFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open parameter meta data file:" << metaDataFile << xmlFile.errorString();
+        return false;
+    }
+    xml = xmlFile.readAll();
+    hash = QGC::crc32(reinterpret_cast<const quint8*>(xml.constData()), xml.size(), 0);
+    return true;
+}
+
+QString ParameterMetaDataCache::cacheFileName(quint32 hash)
+{
+    // Same location as the cached xml files
+    QSettings settings;
+    QDir cacheDir = QFileInfo(settings.fileName()).dir();
+    return cacheDir.filePath(QString("ParameterFactMetaData.%1.bin").arg(hash, 8, 16, QLatin1Char('0')));
+}
+
+bool ParameterMetaDataCache::open(quint32 hash)
+{
+    close();
+
+    _file.setFileName(cacheFileName(hash));
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 fileSize = _file.size();
+    _map = fileSize > 0 ? _file.map(0, fileSize) : NULL;
+    if (!_map) {
+        qCDebug(ParameterManagerLog) << "Unable to map parameter meta data cache" << _file.fileName() << _file.errorString();
+        close();
+        return false;
+    }
+
+    if (!_attach(_map, fileSize, hash)) {
+        // Most likely written by an older version, it is replaced after parsing the xml
+        qCDebug(ParameterManagerLog) << "Parameter meta data cache not usable" << _file.fileName();
+        close();
+        return false;
+    }
+
+    qCDebug(ParameterManagerLog) << "Parameter meta data cache mapped" << _file.fileName() << "entries:" << _count;
+    return true;
+}
+
+void ParameterMetaDataCache::setEntries(const QList<Entry_t>& entries, quint32 hash)
+{
+    close();
+
+    _buffer = _serialize(entries, hash);
+    if (!_attach(reinterpret_cast<const uchar*>(_buffer.constData()), _buffer.size(), hash)) {
+        qWarning() << "Internal error: parameter meta data serialization failed";
+        close();
+    }
+}
+
+void ParameterMetaDataCache::close(void)
+{
+    if (_map) {
+        _file.unmap(const_cast<uchar*>(_map));
+    }
+    _file.close();
+    _buffer.clear();
+    _map = NULL;
+    _index = NULL;
+    _data = NULL;
+    _count = 0;
+}
+
+/// Validates the cache contents and sets up the index and data pointers into them
+bool ParameterMetaDataCache::_attach(const uchar* data, qint64 size, quint32 hash)
+{
+    if (size < (qint64)sizeof(Header_t)) {
+        return false;
+    }
+
+    const Header_t* header = reinterpret_cast<const Header_t*>(data);
+    if (header->magic != _magic || header->version != _version || header->indexSize != sizeof(Index_t) || header->hash != hash) {
+        return false;
+    }
+    if ((qint64)sizeof(Header_t) + ((qint64)header->count * sizeof(Index_t)) + header->dataSize != size) {
+        return false;
+    }
+
+    const Index_t* index = reinterpret_cast<const Index_t*>(data + sizeof(Header_t));
+    for (quint32 i = 0; i < header->count; i++) {
+        if ((quint64)index[i].keyOffset + index[i].keyLength > header->dataSize ||
+                (quint64)index[i].entryOffset + index[i].entryLength > header->dataSize) {
+            return false;
+        }
+    }
+
+    _index = index;
+    _data = reinterpret_cast<const char*>(index + header->count);
+    _count = header->count;
+
+    return true;
+}
+
+bool ParameterMetaDataCache::find(const QString& category, const QString& name, Entry_t& entry) const
+{
+    QByteArray key = _key(category, name);
+
+    int low = 0;
+    int high = _count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const Index_t& index = _index[mid];
+
+        int result = memcmp(_data + index.keyOffset, key.constData(), qMin((int)index.keyLength, key.size()));
+        if (result == 0) {
+            result = (int)index.keyLength - key.size();
+        }
+
+        if (result < 0) {
+            low = mid + 1;
+        } else if (result > 0) {
+            high = mid - 1;
+        } else {
+            QDataStream stream(QByteArray::fromRawData(_data + index.entryOffset, index.entryLength));
+            stream.setVersion(QDataStream::Qt_5_0);
+
+            entry = Entry_t();
+            stream >> entry;
+            if (stream.status() != QDataStream::Ok) {
+                qWarning() << "Parameter meta data cache entry malformed" << category << name;
+                return false;
+            }
+            entry.category = category;
+            entry.name = name;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ParameterMetaDataCache::save(const QList<Entry_t>& entries, quint32 hash)
+{
+    QByteArray bytes = _serialize(entries, hash);
+
+    // Write through a temporary file so a reader never maps a partially written cache
+    QSaveFile file(cacheFileName(hash));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write parameter meta data cache" << file.fileName() << file.errorString();
+        return false;
+    }
+    file.write(bytes);
+    if (!file.commit()) {
+        qWarning() << "Unable to write parameter meta data cache" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    qCDebug(ParameterManagerLog) << "Parameter meta data cache written" << file.fileName() << "entries:" << entries.count();
+    return true;
+}
+
+QByteArray ParameterMetaDataCache::_key(const QString& category, const QString& name)
+{
+    return category.toUtf8() + '\x1f' + name.toUtf8();
+}
+
+QByteArray ParameterMetaDataCache::_serialize(const QList<Entry_t>& entries, quint32 hash)
+{
+    // Sorted by key for the binary search, a later entry with the same key replaces the earlier one
+    QMap<QByteArray, int> sortedEntries;
+    for (int i = 0; i < entries.count(); i++) {
+        sortedEntries[_key(entries[i].category, entries[i].name)] = i;
+    }
+
+    QVector<Index_t> index;
+    QByteArray data;
+    index.reserve(sortedEntries.count());
+
+    QMap<QByteArray, int>::const_iterator it;
+    for (it = sortedEntries.constBegin(); it != sortedEntries.constEnd(); ++it) {
+        QByteArray entryBytes;
+        QDataStream stream(&entryBytes, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << entries[it.value()];
+
+        Index_t entryIndex;
+        entryIndex.keyOffset = data.size();
+        entryIndex.keyLength = it.key().size();
+        data.append(it.key());
+        entryIndex.entryOffset = data.size();
+        entryIndex.entryLength = entryBytes.size();
+        data.append(entryBytes);
+        index.append(entryIndex);
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = _magic;
+    header.version = _version;
+    header.indexSize = sizeof(Index_t);
+    header.hash = hash;
+    header.count = index.count();
+    header.dataSize = data.size();
+
+    QByteArray bytes;
+    bytes.reserve(sizeof(header) + index.count() * sizeof(Index_t) + data.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(index.constData()), index.count() * sizeof(Index_t));
+    bytes.append(data);
+
+    return bytes;
+}
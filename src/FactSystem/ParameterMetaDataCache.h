@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterMetaDataCache_H
+#define ParameterMetaDataCache_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/// Precompiled form of a firmware parameter meta data xml file.
+///
+/// The firmware plugins parse the xml once into raw string entries which are written to a binary file keyed by
+/// the CRC of the xml contents. Later loads of the same xml map that file instead of parsing it again. The file
+/// is a header, an index of the parameter keys sorted for binary search and a data block with the keys and
+/// the serialized entries. An entry is only decoded when a Fact asks for it, so a vehicle which only uses part of
+/// the parameters in the xml only pays for those.
+class ParameterMetaDataCache
+{
+public:
+    ParameterMetaDataCache(void);
+    ~ParameterMetaDataCache();
+
+    typedef QPair<QString, QString> StringPair_t;
+
+    /// Meta data for one parameter, as the strings found in the xml
+    class Entry_t
+    {
+    public:
+        Entry_t(void)
+            : rebootRequired(false)
+            , boolean(false)
+        { }
+
+        QString             category;           ///< Vehicle or library section the parameter was found in, may be empty
+        QString             name;
+        QString             type;
+        QString             group;
+        QString             shortDescription;
+        QString             longDescription;
+        QString             defaultValue;
+        QString             min;
+        QString             max;
+        QString             units;
+        QString             decimalPlaces;
+        QString             increment;
+        bool                rebootRequired;
+        bool                boolean;            ///< Enabled/Disabled enum values
+        QList<StringPair_t> values;             ///< Enum values: code, description
+        QList<StringPair_t> bitmask;            ///< Bits: index, description
+    };
+
+    /// Reads the xml file and computes the hash the binary cache for it is keyed by
+    ///     @param[out] xml Contents of the xml file
+    ///     @param[out] hash CRC of the contents
+    /// @return false: unable to read file
+    static bool readSource(const QString& metaDataFile, QByteArray& xml, quint32& hash);
+
+    /// @return Binary cache file name for an xml file with the specified hash, stored next to the cached xml files
+    static QString cacheFileName(quint32 hash);
+
+    /// Maps the binary cache for the specified xml hash
+    /// @return false: no cache for this hash, or cache in an older format or malformed
+    bool open(quint32 hash);
+
+    /// Uses the specified entries without a cache file, the lookups behave the same as for a mapped file
+    void setEntries(const QList<Entry_t>& entries, quint32 hash);
+
+    void close(void);
+
+    /// @return Number of entries
+    int count(void) const { return _count; }
+
+    /// Decodes the entry for the specified parameter
+    ///     @param category Category to look in, empty to look for entries without category
+    /// @return false: parameter not found
+    bool find(const QString& category, const QString& name, Entry_t& entry) const;
+
+    /// Writes the binary cache for an xml file
+    /// @return false: unable to write file
+    static bool save(const QList<Entry_t>& entries, quint32 hash);
+
+private:
+    typedef struct {
+        quint32 magic;
+        quint16 version;
+        quint16 indexSize;
+        quint32 hash;           ///< CRC of the xml file contents
+        quint32 count;
+        quint32 dataSize;
+        quint32 reserved;
+    } Header_t;
+
+    typedef struct {
+        quint32 keyOffset;      ///< Offset into data block
+        quint32 keyLength;
+        quint32 entryOffset;    ///< Offset into data block
+        quint32 entryLength;
+    } Index_t;
+
+    bool _attach(const uchar* data, qint64 size, quint32 hash);
+    static QByteArray _key(const QString& category, const QString& name);
+    static QByteArray _serialize(const QList<Entry_t>& entries, quint32 hash);
+
+    QFile           _file;
+    const uchar*    _map;           ///< Mapped cache file, NULL if not mapped
+    QByteArray      _buffer;        ///< Cache contents when not backed by a file
+    const Index_t*  _index;
+    const char*     _data;
+    int             _count;
+
+    static const quint32 _magic = 0x4d504751;  ///< "QGPM"
+    static const quint16 _version = 1;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterMetaDataCacheTest.h"
+
+#include <QFile>
+
+ParameterMetaDataCacheTest::ParameterMetaDataCacheTest(void)
+{
+
+}
+
+void ParameterMetaDataCacheTest::cleanup(void)
+{
+    QFile::remove(ParameterMetaDataCache::cacheFileName(_hash));
+
+    UnitTest::cleanup();
+}
+
+/// Entries in two categories, with a name which exists in both
+QList<ParameterMetaDataCache::Entry_t> ParameterMetaDataCacheTest::_entries(void)
+{
+    QList<ParameterMetaDataCache::Entry_t> entries;
+    ParameterMetaDataCache::Entry_t entry;
+
+    entry.category =            QStringLiteral("ArduCopter");
+    entry.name =                QStringLiteral("ATC_RAT_RLL_P");
+    entry.group =               QStringLiteral("ATC");
+    entry.shortDescription =    QStringLiteral("Roll axis rate controller P gain");
+    entry.min =                 QStringLiteral("0.08");
+    entry.max =                 QStringLiteral("0.30");
+    entry.increment =           QStringLiteral("0.005");
+    entries.append(entry);
+
+    entry = ParameterMetaDataCache::Entry_t();
+    entry.category =            QStringLiteral("ArduCopter");
+    entry.name =                QStringLiteral("FLTMODE1");
+    entry.group =               QStringLiteral("FLTMODE");
+    entry.rebootRequired =      true;
+    entry.values << ParameterMetaDataCache::StringPair_t(QStringLiteral("0"), QStringLiteral("Stabilize"))
+                 << ParameterMetaDataCache::StringPair_t(QStringLiteral("5"), QStringLiteral("Loiter"));
+    entries.append(entry);
+
+    entry = ParameterMetaDataCache::Entry_t();
+    entry.category =            QStringLiteral("libraries");
+    entry.name =                QStringLiteral("FLTMODE1");
+    entry.group =               QStringLiteral("others");
+    entries.append(entry);
+
+    entry = ParameterMetaDataCache::Entry_t();
+    entry.name =                QStringLiteral("SENS_BOARD_ROT");
+    entry.type =                QStringLiteral("INT32");
+    entry.defaultValue =        QStringLiteral("0");
+    entry.units =               QStringLiteral("deg");
+    entry.decimalPlaces =       QStringLiteral("2");
+    entry.longDescription =     QStringLiteral("Rotation of the board relative to the vehicle body frame, in ") + QChar(0x00b0);
+    entry.boolean =             true;
+    entry.bitmask << ParameterMetaDataCache::StringPair_t(QStringLiteral("0"), QStringLiteral("Bit 0"))
+                  << ParameterMetaDataCache::StringPair_t(QStringLiteral("3"), QStringLiteral("Bit 3"));
+    entries.append(entry);
+
+    return entries;
+}
+
+void ParameterMetaDataCacheTest::_compareEntries(const ParameterMetaDataCache::Entry_t& actual, const ParameterMetaDataCache::Entry_t& expected)
+{
+    QCOMPARE(actual.category,           expected.category);
+    QCOMPARE(actual.name,               expected.name);
+    QCOMPARE(actual.type,               expected.type);
+    QCOMPARE(actual.group,              expected.group);
+    QCOMPARE(actual.shortDescription,   expected.shortDescription);
+    QCOMPARE(actual.longDescription,    expected.longDescription);
+    QCOMPARE(actual.defaultValue,       expected.defaultValue);
+    QCOMPARE(actual.min,                expected.min);
+    QCOMPARE(actual.max,                expected.max);
+    QCOMPARE(actual.units,              expected.units);
+    QCOMPARE(actual.decimalPlaces,      expected.decimalPlaces);
+    QCOMPARE(actual.increment,          expected.increment);
+    QCOMPARE(actual.rebootRequired,     expected.rebootRequired);
+    QCOMPARE(actual.boolean,            expected.boolean);
+    QVERIFY(actual.values == expected.values);
+    QVERIFY(actual.bitmask == expected.bitmask);
+}
+
+void ParameterMetaDataCacheTest::_find_test(void)
+{
+    QList<ParameterMetaDataCache::Entry_t> entries = _entries();
+
+    ParameterMetaDataCache cache;
+    cache.setEntries(entries, _hash);
+    QCOMPARE(cache.count(), entries.count());
+
+    ParameterMetaDataCache::Entry_t entry;
+    foreach (const ParameterMetaDataCache::Entry_t& expected, entries) {
+        QVERIFY(cache.find(expected.category, expected.name, entry));
+        _compareEntries(entry, expected);
+    }
+
+    QVERIFY(!cache.find(QStringLiteral("ArduPlane"), QStringLiteral("FLTMODE1"), entry));
+    QVERIFY(!cache.find(QString(), QStringLiteral("FLTMODE1"), entry));
+    QVERIFY(!cache.find(QString(), QStringLiteral("SENS_BOARD"), entry));
+    QVERIFY(!cache.find(QString(), QStringLiteral("SENS_BOARD_ROT_"), entry));
+}
+
+void ParameterMetaDataCacheTest::_saveOpen_test(void)
+{
+    QList<ParameterMetaDataCache::Entry_t> entries = _entries();
+    QVERIFY(ParameterMetaDataCache::save(entries, _hash));
+
+    ParameterMetaDataCache cache;
+    QVERIFY(cache.open(_hash));
+    QCOMPARE(cache.count(), entries.count());
+
+    ParameterMetaDataCache::Entry_t entry;
+    foreach (const ParameterMetaDataCache::Entry_t& expected, entries) {
+        QVERIFY(cache.find(expected.category, expected.name, entry));
+        _compareEntries(entry, expected);
+    }
+
+    // A changed xml has a different hash and must not pick up this cache
+    QVERIFY(!cache.open(_hash + 1));
+    QCOMPARE(cache.count(), 0);
+}
+
+void ParameterMetaDataCacheTest::_corrupt_test(void)
+{
+    QVERIFY(ParameterMetaDataCache::save(_entries(), _hash));
+
+    // Truncated file
+    QFile file(ParameterMetaDataCache::cacheFileName(_hash));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 3));
+    file.close();
+
+    ParameterMetaDataCache cache;
+    QVERIFY(!cache.open(_hash));
+
+    // Cache file renamed to a different hash
+    QVERIFY(ParameterMetaDataCache::save(_entries(), _hash));
+    QFile::remove(ParameterMetaDataCache::cacheFileName(_hash + 1));
+    QVERIFY(QFile::copy(ParameterMetaDataCache::cacheFileName(_hash), ParameterMetaDataCache::cacheFileName(_hash + 1)));
+    QVERIFY(!cache.open(_hash + 1));
+    QFile::remove(ParameterMetaDataCache::cacheFileName(_hash + 1));
+}
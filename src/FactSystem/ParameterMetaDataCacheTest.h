@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterMetaDataCacheTest_H
+#define ParameterMetaDataCacheTest_H
+
+#include "UnitTest.h"
+#include "ParameterMetaDataCache.h"
+
+/// Unit test for the precompiled parameter meta data cache
+class ParameterMetaDataCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterMetaDataCacheTest(void);
+
+private slots:
+    void cleanup(void);
+
+    void _find_test(void);
+    void _saveOpen_test(void);
+    void _corrupt_test(void);
+
+private:
+    QList<ParameterMetaDataCache::Entry_t> _entries(void);
+    void _compareEntries(const ParameterMetaDataCache::Entry_t& actual, const ParameterMetaDataCache::Entry_t& expected);
+
+    static const quint32 _hash = 0x51ca7e00;
+};
+
+#endif
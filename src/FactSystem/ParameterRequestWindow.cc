@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterRequestWindow.h"
+
+#include <QtMath>
+
+ParameterRequestWindow::ParameterRequestWindow(void)
+{
+    reset();
+}
+
+void ParameterRequestWindow::reset(void)
+{
+    _window =           initialWindow;
+    _threshold =        maxWindow;
+    _growthCount =      0;
+    _inFlight =         0;
+    _srtt =             0;
+    _rttVar =           0;
+    _requestCount =     0;
+    _responseCount =    0;
+    _lossCount =        0;
+}
+
+void ParameterRequestWindow::requestSent(void)
+{
+    _inFlight++;
+    _requestCount++;
+}
+
+void ParameterRequestWindow::responseReceived(qint64 rttMSecs)
+{
+    if (_inFlight > 0) {
+        _inFlight--;
+    }
+    _responseCount++;
+
+    if (rttMSecs >= 0) {
+        if (_srtt == 0) {
+            _srtt = rttMSecs;
+            _rttVar = rttMSecs / 2.0;
+        } else {
+            _rttVar = 0.75 * _rttVar + 0.25 * qAbs(_srtt - rttMSecs);
+            _srtt = 0.875 * _srtt + 0.125 * rttMSecs;
+        }
+    }
+
+    if (_window < _threshold) {
+        _window++;
+    } else if (++_growthCount >= _window) {
+        _growthCount = 0;
+        _window++;
+    }
+    _window = qMin(_window, (int)maxWindow);
+}
+
+void ParameterRequestWindow::requestsLost(void)
+{
+    if (_inFlight == 0) {
+        return;
+    }
+
+    _lossCount++;
+    _inFlight = 0;
+    _growthCount = 0;
+    _threshold = qMax(_window / 2, (int)minWindow);
+    _window = _threshold;
+}
+
+void ParameterRequestWindow::requestsCancelled(int count)
+{
+    _inFlight = qMax(_inFlight - count, 0);
+}
+
+int ParameterRequestWindow::retransmitTimeoutMSecs(void) const
+{
+    if (_srtt == 0) {
+        return maxRetransmitTimeoutMSecs;
+    }
+    return qBound((int)minRetransmitTimeoutMSecs, qCeil(_srtt + 4 * _rttVar), (int)maxRetransmitTimeoutMSecs);
+}
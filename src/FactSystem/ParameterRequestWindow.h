@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterRequestWindow_H
+#define ParameterRequestWindow_H
+
+#include <QtGlobal>
+
+/// Congestion window for the index based parameter re-requests which fill the gaps of the initial
+/// PARAM_REQUEST_LIST stream.
+///
+/// The window opens by one request per response until the threshold set by the last loss, and by one
+/// request per window full of responses above it. A timeout with requests in flight halves it. The round
+/// trip time is smoothed the same way TCP does, the retransmit timeout derived from it decides when the
+/// requests in flight are considered lost.
+class ParameterRequestWindow
+{
+public:
+    ParameterRequestWindow(void);
+
+    /// Restores the initial window and clears statistics
+    void reset(void);
+
+    /// @return Maximum number of requests in flight
+    int window(void) const { return _window; }
+
+    /// @return Number of requests in flight
+    int inFlight(void) const { return _inFlight; }
+
+    /// @return true: Another request can be sent
+    bool isOpen(void) const { return _inFlight < _window; }
+
+    void requestSent(void);
+
+    /// A response to a request in flight arrived
+    ///     @param rttMSecs Round trip time of the request, -1 if ambiguous since the request was sent more than once
+    void responseReceived(qint64 rttMSecs);
+
+    /// No response in time, all requests in flight are lost
+    void requestsLost(void);
+
+    /// Requests in flight which no longer expect a response, without counting as loss
+    void requestsCancelled(int count);
+
+    /// @return Time without response after which the requests in flight are lost
+    int retransmitTimeoutMSecs(void) const;
+
+    // Statistics since reset
+    int requestCount    (void) const { return _requestCount; }
+    int responseCount   (void) const { return _responseCount; }
+    int lossCount       (void) const { return _lossCount; }
+    int smoothedRttMSecs(void) const { return qRound(_srtt); }
+
+    static const int initialWindow =            10;
+    static const int minWindow =                2;
+    static const int maxWindow =                64;
+    static const int minRetransmitTimeoutMSecs = 500;
+    static const int maxRetransmitTimeoutMSecs = 3000;
+
+private:
+    int     _window;
+    int     _threshold;         ///< Window above which it grows linearly
+    int     _growthCount;       ///< Responses since the last linear growth step
+    int     _inFlight;
+    double  _srtt;              ///< Smoothed round trip time, 0 until the first sample
+    double  _rttVar;            ///< Round trip time variation
+
+    int     _requestCount;
+    int     _responseCount;
+    int     _lossCount;
+};
+
+#endif
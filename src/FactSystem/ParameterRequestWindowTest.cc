@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterRequestWindowTest.h"
+#include "ParameterRequestWindow.h"
+
+void ParameterRequestWindowTest::_growth_test(void)
+{
+    ParameterRequestWindow window;
+
+    QCOMPARE(window.window(), (int)ParameterRequestWindow::initialWindow);
+    for (int i = 0; i < ParameterRequestWindow::initialWindow; i++) {
+        QVERIFY(window.isOpen());
+        window.requestSent();
+    }
+    QVERIFY(!window.isOpen());
+    QCOMPARE(window.inFlight(), (int)ParameterRequestWindow::initialWindow);
+
+    // Below the threshold every response opens the window by one
+    window.responseReceived(100);
+    QCOMPARE(window.inFlight(), ParameterRequestWindow::initialWindow - 1);
+    QCOMPARE(window.window(), ParameterRequestWindow::initialWindow + 1);
+
+    // Never grows past the maximum
+    for (int i = 0; i < 1000; i++) {
+        window.requestSent();
+        window.responseReceived(100);
+    }
+    QCOMPARE(window.window(), (int)ParameterRequestWindow::maxWindow);
+    QCOMPARE(window.requestCount(), ParameterRequestWindow::initialWindow + 1000);
+    QCOMPARE(window.responseCount(), 1001);
+}
+
+void ParameterRequestWindowTest::_loss_test(void)
+{
+    ParameterRequestWindow window;
+
+    // Timeout without anything in flight is no loss
+    window.requestsLost();
+    QCOMPARE(window.lossCount(), 0);
+    QCOMPARE(window.window(), (int)ParameterRequestWindow::initialWindow);
+
+    window.requestSent();
+    window.requestsLost();
+    QCOMPARE(window.lossCount(), 1);
+    QCOMPARE(window.inFlight(), 0);
+    QCOMPARE(window.window(), ParameterRequestWindow::initialWindow / 2);
+
+    // Above the threshold the window grows by one per window full of responses
+    int threshold = window.window();
+    for (int i = 0; i < threshold - 1; i++) {
+        window.requestSent();
+        window.responseReceived(-1);
+    }
+    QCOMPARE(window.window(), threshold);
+    window.requestSent();
+    window.responseReceived(-1);
+    QCOMPARE(window.window(), threshold + 1);
+
+    // Repeated losses bottom out at the minimum
+    for (int i = 0; i < 10; i++) {
+        window.requestSent();
+        window.requestsLost();
+    }
+    QCOMPARE(window.window(), (int)ParameterRequestWindow::minWindow);
+
+    window.requestSent();
+    window.requestSent();
+    window.requestsCancelled(5);
+    QCOMPARE(window.inFlight(), 0);
+}
+
+void ParameterRequestWindowTest::_retransmitTimeout_test(void)
+{
+    ParameterRequestWindow window;
+
+    // No samples yet
+    QCOMPARE(window.retransmitTimeoutMSecs(), (int)ParameterRequestWindow::maxRetransmitTimeoutMSecs);
+
+    // Steady round trip time converges on it, bounded by the minimum
+    for (int i = 0; i < 100; i++) {
+        window.requestSent();
+        window.responseReceived(50);
+    }
+    QCOMPARE(window.smoothedRttMSecs(), 50);
+    QCOMPARE(window.retransmitTimeoutMSecs(), (int)ParameterRequestWindow::minRetransmitTimeoutMSecs);
+
+    // Ambiguous samples are ignored
+    window.requestSent();
+    window.responseReceived(-1);
+    QCOMPARE(window.smoothedRttMSecs(), 50);
+
+    // Slow link
+    for (int i = 0; i < 100; i++) {
+        window.requestSent();
+        window.responseReceived(i & 1 ? 400 : 800);
+    }
+    QVERIFY(window.retransmitTimeoutMSecs() > 800);
+    QVERIFY(window.retransmitTimeoutMSecs() <= ParameterRequestWindow::maxRetransmitTimeoutMSecs);
+}
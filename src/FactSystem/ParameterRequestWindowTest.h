@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterRequestWindowTest_H
+#define ParameterRequestWindowTest_H
+
+#include "UnitTest.h"
+
+/// Unit test for the parameter re-request congestion window
+class ParameterRequestWindowTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _growth_test(void);
+    void _loss_test(void);
+    void _retransmitTimeout_test(void);
+};
+
+#endif
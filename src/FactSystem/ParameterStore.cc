@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterStore.h"
+#include "Fact.h"
+
+#include <QHash>
+
+#include <algorithm>
+
+ParameterStore::ParameterStore(void)
+    : _count(0)
+{
+    Slot_t empty = { 0, 0, QString(), NULL };
+    _slots.fill(empty, _initialSlotCount);
+}
+
+bool ParameterStore::insert(Fact* fact)
+{
+    int componentId = fact->componentId();
+    QString name = fact->name();
+    uint hash = _hash(componentId, name);
+
+    int slot = _findSlot(componentId, name, hash);
+    if (_slots[slot].fact) {
+        return false;
+    }
+
+    // Keep the table at most half full so probe sequences stay short
+    if ((_count + 1) * 2 > _slots.count()) {
+        _grow();
+        slot = _findSlot(componentId, name, hash);
+    }
+
+    Slot_t& entry = _slots[slot];
+    entry.hash = hash;
+    entry.componentId = componentId;
+    entry.name = name;
+    entry.fact = fact;
+    _count++;
+
+    QStringList& names = _names[componentId];
+    names.insert(std::lower_bound(names.begin(), names.end(), name) - names.begin(), name);
+
+    return true;
+}
+
+Fact* ParameterStore::find(int componentId, const QString& name) const
+{
+    return _slots[_findSlot(componentId, name, _hash(componentId, name))].fact;
+}
+
+QList<Fact*> ParameterStore::facts(int componentId) const
+{
+    QList<Fact*> facts;
+
+    foreach (const QString& name, _names.value(componentId)) {
+        facts.append(find(componentId, name));
+    }
+
+    return facts;
+}
+
+uint ParameterStore::_hash(int componentId, const QString& name)
+{
+    return qHash(name, (uint)componentId * 0x9E3779B1u);
+}
+
+/// @return Slot holding the parameter, or the empty slot where it would go
+int ParameterStore::_findSlot(int componentId, const QString& name, uint hash) const
+{
+    int mask = _slots.count() - 1;
+    int slot = hash & mask;
+
+    const Slot_t* slots = _slots.constData();
+    while (slots[slot].fact) {
+        const Slot_t& entry = slots[slot];
+        if (entry.hash == hash && entry.componentId == componentId && entry.name == name) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void ParameterStore::_grow(void)
+{
+    QVector<Slot_t> oldSlots = _slots;
+
+    Slot_t empty = { 0, 0, QString(), NULL };
+    _slots.fill(empty, oldSlots.count() * 2);
+
+    int mask = _slots.count() - 1;
+    foreach (const Slot_t& entry, oldSlots) {
+        if (entry.fact) {
+            int slot = entry.hash & mask;
+            while (_slots[slot].fact) {
+                slot = (slot + 1) & mask;
+            }
+            _slots[slot] = entry;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterStore_H
+#define ParameterStore_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class Fact;
+
+/// Parameter Facts of all components of a vehicle, looked up by component id and name.
+///
+/// All Facts live in a single open addressing table with linear probing, so a lookup is one hash of the name
+/// and usually a single probe, instead of two ordered map searches with a string compare per tree level.
+/// Names are stored once in the table and compared by their cached hash first. The store does not own the
+/// Facts and never moves them, Fact pointers handed out stay valid for the lifetime of the owner.
+class ParameterStore
+{
+public:
+    ParameterStore(void);
+
+    /// Adds a Fact under its component id and name. Replaces nothing, returns false if the name is already taken.
+    bool insert(Fact* fact);
+
+    /// @return Fact for the parameter, NULL if it does not exist
+    Fact* find(int componentId, const QString& name) const;
+
+    bool contains(int componentId, const QString& name) const { return find(componentId, name) != NULL; }
+
+    /// @return true: At least one parameter exists for the component
+    bool contains(int componentId) const { return _names.contains(componentId); }
+
+    /// @return Component ids with parameters, in ascending order
+    QList<int> componentIds(void) const { return _names.keys(); }
+
+    /// @return Parameter names of the component, sorted
+    QStringList names(int componentId) const { return _names.value(componentId); }
+
+    /// @return Parameter Facts of the component, sorted by name
+    QList<Fact*> facts(int componentId) const;
+
+    /// @return Number of parameters in all components
+    int count(void) const { return _count; }
+
+private:
+    typedef struct {
+        uint    hash;           ///< Hash of component id and name, valid if fact is set
+        int     componentId;
+        QString name;
+        Fact*   fact;           ///< NULL: empty slot
+    } Slot_t;
+
+    static uint _hash(int componentId, const QString& name);
+    int _findSlot(int componentId, const QString& name, uint hash) const;
+    void _grow(void);
+
+    QVector<Slot_t>             _slots;
+    int                         _count;
+    QMap<int, QStringList>      _names;     ///< Sorted parameter names by component id
+
+    static const int _initialSlotCount = 256;   ///< Must be a power of two
+};
+
+#endif
@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "ParameterStoreTest.h"
+#include "ParameterStore.h"
+#include "Fact.h"
+
+void ParameterStoreTest::init(void)
+{
+    UnitTest::init();
+
+    // Names shaped like real parameter names, sharing prefixes
+    const char* prefixes[] = { "ATC_", "MPC_", "EKF2_", "SENS_", "COM_", "RC" };
+    for (int i = 0; i < _paramCount; i++) {
+        QString name = QString("%1%2_%3").arg(prefixes[i % 6]).arg(i / 6).arg(i % 7 ? "P" : "MAX");
+        _facts.append(new Fact(_componentId, name, FactMetaData::valueTypeFloat));
+    }
+}
+
+void ParameterStoreTest::cleanup(void)
+{
+    qDeleteAll(_facts);
+    _facts.clear();
+
+    UnitTest::cleanup();
+}
+
+void ParameterStoreTest::_insertFind_test(void)
+{
+    ParameterStore store;
+
+    foreach (Fact* fact, _facts) {
+        QVERIFY(store.insert(fact));
+    }
+    QCOMPARE(store.count(), _facts.count());
+
+    // Pointers handed out are the inserted ones, also after the table grew
+    foreach (Fact* fact, _facts) {
+        QCOMPARE(store.find(_componentId, fact->name()), fact);
+    }
+    QVERIFY(!store.find(_componentId, "NOT_A_PARAM"));
+    QVERIFY(!store.find(_gimbalComponentId, _facts[0]->name()));
+
+    // Duplicate names are refused
+    Fact duplicate(_componentId, _facts[0]->name(), FactMetaData::valueTypeFloat);
+    QVERIFY(!store.insert(&duplicate));
+    QCOMPARE(store.find(_componentId, duplicate.name()), _facts[0]);
+    QCOMPARE(store.count(), _facts.count());
+}
+
+void ParameterStoreTest::_components_test(void)
+{
+    ParameterStore store;
+
+    QVERIFY(!store.contains(_componentId));
+
+    Fact gimbalFact(_gimbalComponentId, _facts[0]->name(), FactMetaData::valueTypeFloat);
+    QVERIFY(store.insert(&gimbalFact));
+    for (int i = _facts.count() - 1; i >= 0; i--) {
+        QVERIFY(store.insert(_facts[i]));
+    }
+
+    QVERIFY(store.contains(_componentId));
+    QVERIFY(store.contains(_gimbalComponentId));
+    QCOMPARE(store.componentIds(), QList<int>() << (int)_componentId << (int)_gimbalComponentId);
+
+    // Same name in another component is a different parameter
+    QCOMPARE(store.find(_gimbalComponentId, gimbalFact.name()), &gimbalFact);
+    QCOMPARE(store.find(_componentId, gimbalFact.name()), _facts[0]);
+
+    // Names and facts come back sorted regardless of insert order
+    QStringList sortedNames;
+    foreach (Fact* fact, _facts) {
+        sortedNames.append(fact->name());
+    }
+    sortedNames.sort();
+    QCOMPARE(store.names(_componentId), sortedNames);
+
+    QList<Fact*> facts = store.facts(_componentId);
+    QCOMPARE(facts.count(), sortedNames.count());
+    for (int i = 0; i < facts.count(); i++) {
+        QCOMPARE(facts[i]->name(), sortedNames[i]);
+    }
+    QCOMPARE(store.names(_gimbalComponentId), QStringList() << gimbalFact.name());
+}
+
+void ParameterStoreTest::_lookupBenchmark_test_data(void)
+{
+    QTest::addColumn<bool>("store");
+
+    QTest::newRow("QMap") << false;
+    QTest::newRow("ParameterStore") << true;
+}
+
+/// Looks up every parameter by a separately built name, the way QML bindings ask for them
+void ParameterStoreTest::_lookupBenchmark_test(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(bool, store);
+
+    // The previous nested map layout, for comparison
+    QMap<int, QVariantMap> mapStore;
+    ParameterStore parameterStore;
+    QStringList names;
+    foreach (Fact* fact, _facts) {
+        mapStore[_componentId][fact->name()] = QVariant::fromValue(fact);
+        parameterStore.insert(fact);
+        names.append(QString(fact->name().toLatin1()));
+    }
+
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        foreach (const QString& name, names) {
+            Fact* fact;
+            if (store) {
+                fact = parameterStore.find(_componentId, name);
+            } else {
+                fact = mapStore.contains(_componentId) && mapStore[_componentId].contains(name) ? mapStore[_componentId][name].value<Fact*>() : NULL;
+            }
+            if (fact) {
+                found++;
+            }
+        }
+    }
+
+    QCOMPARE(found, _facts.count());
+}
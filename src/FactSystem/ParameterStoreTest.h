@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef ParameterStoreTest_H
+#define ParameterStoreTest_H
+
+#include "UnitTest.h"
+
+class Fact;
+
+/// Unit test and lookup benchmark for the parameter Fact store
+class ParameterStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _insertFind_test(void);
+    void _components_test(void);
+    void _lookupBenchmark_test(void);
+    void _lookupBenchmark_test_data(void);
+
+private:
+    QList<Fact*>    _facts;
+
+    static const int _componentId =     1;
+    static const int _gimbalComponentId = 154;
+    static const int _paramCount =      1500;   ///< Somewhat more than an ArduPilot vehicle has
+};
+
+#endif
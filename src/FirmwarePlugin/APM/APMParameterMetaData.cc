@@ -133,20 +133,56 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
-    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
-    QString currentCategory;
-
     qCDebug(APMParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
-    QFile xmlFile(metaDataFile);
-    Q_ASSERT(xmlFile.exists());
+    QByteArray  xmlBytes;
+    quint32     hash;
+    if (!ParameterMetaDataCache::readSource(metaDataFile, xmlBytes, hash)) {
+        return;
+    }
+
+    // The same xml was parsed before, use the precompiled version
+    if (_metaDataCache.open(hash)) {
+        return;
+    }
 
-    bool success = xmlFile.open(QIODevice::ReadOnly);
-    Q_UNUSED(success);
-    Q_ASSERT(success);
+    QMap<QString, ParameterNametoFactMetaDataMap> vehicleTypeToParametersMap;
+    _parseParameterFactMetaData(xmlBytes, vehicleTypeToParametersMap);
+
+    QList<ParameterMetaDataCache::Entry_t> entries;
+    foreach (const QString& category, vehicleTypeToParametersMap.keys()) {
+        foreach (APMFactMetaDataRaw* rawMetaData, vehicleTypeToParametersMap[category]) {
+            ParameterMetaDataCache::Entry_t entry;
+            entry.category =            category;
+            entry.name =                rawMetaData->name;
+            entry.group =               rawMetaData->group;
+            entry.shortDescription =    rawMetaData->shortDescription;
+            entry.longDescription =     rawMetaData->longDescription;
+            entry.min =                 rawMetaData->min;
+            entry.max =                 rawMetaData->max;
+            entry.increment =           rawMetaData->incrementSize;
+            entry.units =               rawMetaData->units;
+            entry.rebootRequired =      rawMetaData->rebootRequired;
+            entry.values =              rawMetaData->values;
+            entry.bitmask =             rawMetaData->bitmask;
+            entries.append(entry);
+        }
+        qDeleteAll(vehicleTypeToParametersMap[category]);
+    }
 
-    QXmlStreamReader xml(xmlFile.readAll());
-    xmlFile.close();
+    if (!ParameterMetaDataCache::save(entries, hash) || !_metaDataCache.open(hash)) {
+        // Cache location not writable, keep the parsed entries in memory
+        _metaDataCache.setEntries(entries, hash);
+    }
+}
+
+/// Parses the parameter meta data xml into raw meta data by category
+void APMParameterMetaData::_parseParameterFactMetaData(const QByteArray& xmlBytes, QMap<QString, ParameterNametoFactMetaDataMap>& vehicleTypeToParametersMap)
+{
+    QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
+    QString currentCategory;
+
+    QXmlStreamReader xml(xmlBytes);
     if (xml.hasError()) {
         qCWarning(APMParameterMetaDataLog) << "Badly formed XML, reading failed: " << xml.errorString();
         return;
@@ -244,12 +280,12 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                           << "group: " << group;
 
                 Q_ASSERT(!rawMetaData);
-                if (_vehicleTypeToParametersMap[currentCategory].contains(name)) {
+                if (vehicleTypeToParametersMap[currentCategory].contains(name)) {
                     qCDebug(APMParameterMetaDataLog) << "Duplicate parameter found:" << name;
-                    rawMetaData = _vehicleTypeToParametersMap[currentCategory][name];
+                    rawMetaData = vehicleTypeToParametersMap[currentCategory][name];
                 } else {
                     rawMetaData = new APMFactMetaDataRaw();
-                    _vehicleTypeToParametersMap[currentCategory][name] = rawMetaData;
+                    vehicleTypeToParametersMap[currentCategory][name] = rawMetaData;
                     groupMembers[group] << name;
                 }
                 qCDebug(APMParameterMetaDataVerboseLog) << "inserting metadata for field" << name;
@@ -283,7 +319,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 xmlState.pop();
             } else if (elementName == "parameters") {
                 qCDebug(APMParameterMetaDataVerboseLog) << "end of parameters for category: " << currentCategory;
-                correctGroupMemberships(_vehicleTypeToParametersMap[currentCategory], groupMembers);
+                correctGroupMemberships(vehicleTypeToParametersMap[currentCategory], groupMembers);
                 groupMembers.clear();
                 xmlState.pop();
             } else if (elementName == "vehicles") {
@@ -415,72 +451,69 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
 void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
     const QString mavTypeString = mavTypeToString(vehicleType);
-    APMFactMetaDataRaw* rawMetaData = NULL;
+    ParameterMetaDataCache::Entry_t rawMetaData;
 
     // check if we have metadata for fact, use generic otherwise
-    if (_vehicleTypeToParametersMap[mavTypeString].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap[mavTypeString][fact->name()];
-    } else if (_vehicleTypeToParametersMap["libraries"].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap["libraries"][fact->name()];
-    }
+    bool found = _metaDataCache.find(mavTypeString, fact->name(), rawMetaData) ||
+            _metaDataCache.find(QStringLiteral("libraries"), fact->name(), rawMetaData);
 
     FactMetaData *metaData = new FactMetaData(fact->type(), fact);
 
     // we don't have data for this fact
-    if (!rawMetaData) {
+    if (!found) {
         fact->setMetaData(metaData);
         qCDebug(APMParameterMetaDataLog) << "No metaData for " << fact->name() << "using generic metadata";
         return;
     }
 
-    metaData->setName(rawMetaData->name);
-    metaData->setGroup(rawMetaData->group);
-    metaData->setRebootRequired(rawMetaData->rebootRequired);
+    metaData->setName(rawMetaData.name);
+    metaData->setGroup(rawMetaData.group);
+    metaData->setRebootRequired(rawMetaData.rebootRequired);
 
-    if (!rawMetaData->shortDescription.isEmpty()) {
-        metaData->setShortDescription(rawMetaData->shortDescription);
+    if (!rawMetaData.shortDescription.isEmpty()) {
+        metaData->setShortDescription(rawMetaData.shortDescription);
     }
 
-    if (!rawMetaData->longDescription.isEmpty()) {
-        metaData->setLongDescription(rawMetaData->longDescription);
+    if (!rawMetaData.longDescription.isEmpty()) {
+        metaData->setLongDescription(rawMetaData.longDescription);
     }
 
-    if (!rawMetaData->units.isEmpty()) {
-        metaData->setRawUnits(rawMetaData->units);
+    if (!rawMetaData.units.isEmpty()) {
+        metaData->setRawUnits(rawMetaData.units);
     }
 
-    if (!rawMetaData->min.isEmpty()) {
+    if (!rawMetaData.min.isEmpty()) {
         QVariant varMin;
         QString errorString;
-        if (metaData->convertAndValidateRaw(rawMetaData->min, false /* validate as well */, varMin, errorString)) {
+        if (metaData->convertAndValidateRaw(rawMetaData.min, false /* validate as well */, varMin, errorString)) {
             metaData->setRawMin(varMin);
         } else {
             qCDebug(APMParameterMetaDataLog) << "Invalid min value, name:" << metaData->name()
-                                             << " type:" << metaData->type() << " min:" << rawMetaData->min
+                                             << " type:" << metaData->type() << " min:" << rawMetaData.min
                                              << " error:" << errorString;
         }
     }
 
-    if (!rawMetaData->max.isEmpty()) {
+    if (!rawMetaData.max.isEmpty()) {
         QVariant varMax;
         QString errorString;
-        if (metaData->convertAndValidateRaw(rawMetaData->max, false /* validate as well */, varMax, errorString)) {
+        if (metaData->convertAndValidateRaw(rawMetaData.max, false /* validate as well */, varMax, errorString)) {
             metaData->setRawMax(varMax);
         } else {
             qCDebug(APMParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:"
-                                             << metaData->type() << " max:" << rawMetaData->max
+                                             << metaData->type() << " max:" << rawMetaData.max
                                              << " error:" << errorString;
         }
     }
 
-    if (rawMetaData->values.count() > 0) {
+    if (rawMetaData.values.count() > 0) {
         QStringList     enumStrings;
         QVariantList    enumValues;
 
-        for (int i=0; i<rawMetaData->values.count(); i++) {
+        for (int i=0; i<rawMetaData.values.count(); i++) {
             QVariant    enumValue;
             QString     errorString;
-            QPair<QString, QString> enumPair = rawMetaData->values[i];
+            QPair<QString, QString> enumPair = rawMetaData.values[i];
 
             if (metaData->convertAndValidateRaw(enumPair.first, false /* validate */, enumValue, errorString)) {
                 enumValues << enumValue;
@@ -500,14 +533,14 @@ void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
         }
     }
 
-    if (rawMetaData->bitmask.count() > 0) {
+    if (rawMetaData.bitmask.count() > 0) {
         QStringList     bitmaskStrings;
         QVariantList    bitmaskValues;
 
-        for (int i=0; i<rawMetaData->bitmask.count(); i++) {
+        for (int i=0; i<rawMetaData.bitmask.count(); i++) {
             QVariant    bitmaskValue;
             QString     errorString;
-            QPair<QString, QString> bitmaskPair = rawMetaData->bitmask[i];
+            QPair<QString, QString> bitmaskPair = rawMetaData.bitmask[i];
 
             bool ok = false;
             unsigned int bitSet = bitmaskPair.first.toUInt(&ok);
@@ -569,14 +602,14 @@ void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
         }
     }
 
-    if (!rawMetaData->incrementSize.isEmpty()) {
+    if (!rawMetaData.increment.isEmpty()) {
         double  increment;
         bool    ok;
-        increment = rawMetaData->incrementSize.toDouble(&ok);
+        increment = rawMetaData.increment.toDouble(&ok);
         if (ok) {
             metaData->setIncrement(increment);
         } else {
-            qCDebug(APMParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData->incrementSize;
+            qCDebug(APMParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData.increment;
         }
     }
 
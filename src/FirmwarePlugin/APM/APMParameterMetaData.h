@@ -18,6 +18,7 @@
 #include <QLoggingCategory>
 
 #include "FactSystem.h"
+#include "ParameterMetaDataCache.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
 
@@ -75,13 +76,14 @@ private:
     };    
 
     QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    void _parseParameterFactMetaData(const QByteArray& xmlBytes, QMap<QString, ParameterNametoFactMetaDataMap>& vehicleTypeToParametersMap);
     bool skipXMLBlock(QXmlStreamReader& xml, const QString& blockName);
     bool parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw *rawMetaData);
     void correctGroupMemberships(ParameterNametoFactMetaDataMap& parameterToFactMetaDataMap, QMap<QString,QStringList>& groupMembers);
     QString mavTypeToString(MAV_TYPE vehicleTypeEnum);
 
     bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, ParameterNametoFactMetaDataMap> _vehicleTypeToParametersMap; ///< Maps from a vehicle type to paramametertoFactMeta map>
+    ParameterMetaDataCache _metaDataCache;   ///< Raw meta data by vehicle type or library category
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QHash>
 
 static const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
@@ -89,30 +90,48 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
 
     qCDebug(PX4ParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
-    QFile xmlFile(metaDataFile);
-
-    if (!xmlFile.exists()) {
+    if (!QFile::exists(metaDataFile)) {
         qWarning() << "Internal error: metaDataFile mission" << metaDataFile;
         return;
     }
-    
-    if (!xmlFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Internal error: Unable to open parameter file:" << metaDataFile << xmlFile.errorString();
+
+    QByteArray  xmlBytes;
+    quint32     hash;
+    if (!ParameterMetaDataCache::readSource(metaDataFile, xmlBytes, hash)) {
         return;
     }
-    
-    QXmlStreamReader xml(xmlFile.readAll());
-    xmlFile.close();
+
+    // The same xml was parsed before, use the precompiled version
+    if (_metaDataCache.open(hash)) {
+        return;
+    }
+
+    QList<ParameterMetaDataCache::Entry_t> entries;
+    if (!_parseParameterFactMetaData(metaDataFile, xmlBytes, entries)) {
+        return;
+    }
+
+    if (!ParameterMetaDataCache::save(entries, hash) || !_metaDataCache.open(hash)) {
+        // Cache location not writable, keep the parsed entries in memory
+        _metaDataCache.setEntries(entries, hash);
+    }
+}
+
+/// Parses the parameter meta data xml into raw string entries
+/// @return false: xml is badly formed or in an older format
+bool PX4ParameterMetaData::_parseParameterFactMetaData(const QString& metaDataFile, const QByteArray& xmlBytes, QList<ParameterMetaDataCache::Entry_t>& entries)
+{
+    QXmlStreamReader xml(xmlBytes);
     if (xml.hasError()) {
         qWarning() << "Badly formed XML" << xml.errorString();
-        return;
+        return false;
     }
     
-    QString         factGroup;
-    QString         errorString;
-    FactMetaData*   metaData = NULL;
-    int             xmlState = XmlStateNone;
-    bool            badMetaData = true;
+    QString                         factGroup;
+    ParameterMetaDataCache::Entry_t* entry = NULL;
+    QHash<QString, int>             entryIndices;
+    int                             xmlState = XmlStateNone;
+    bool                            badMetaData = true;
     
     while (!xml.atEnd()) {
         if (xml.isStartElement()) {
@@ -121,14 +140,14 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             if (elementName == "parameters") {
                 if (xmlState != XmlStateNone) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundParameters;
                 
             } else if (elementName == "version") {
                 if (xmlState != XmlStateFoundParameters) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundVersion;
                 
@@ -137,12 +156,12 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 int intVersion = strVersion.toInt(&convertOk);
                 if (!convertOk) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 if (intVersion <= 2) {
                     // We can't read these old files
                     qDebug() << "Parameter version stamp too old, skipping load. Found:" << intVersion << "Want: 3 File:" << metaDataFile;
-                    return;
+                    return false;
                 }
                 
             } else if (elementName == "parameter_version_major") {
@@ -154,13 +173,13 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 if (xmlState != XmlStateFoundVersion) {
                     // We didn't get a version stamp, assume older version we can't read
                     qDebug() << "Parameter version stamp not found, skipping load" << metaDataFile;
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundGroup;
                 
                 if (!xml.attributes().hasAttribute("name")) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 factGroup = xml.attributes().value("name").toString();
                 qCDebug(PX4ParameterMetaDataLog) << "Found group: " << factGroup;
@@ -168,13 +187,13 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             } else if (elementName == "parameter") {
                 if (xmlState != XmlStateFoundGroup) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 xmlState = XmlStateFoundParameter;
                 
                 if (!xml.attributes().hasAttribute("name") || !xml.attributes().hasAttribute("type")) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
                 
                 QString name = xml.attributes().value("name").toString();
@@ -183,37 +202,32 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 
                 qCDebug(PX4ParameterMetaDataLog) << "Found parameter name:" << name << " type:" << type << " default:" << strDefault;
 
-                // Convert type from string to FactMetaData::ValueType_t
+                // Validate the type now, an unknown type makes the whole file unusable
                 bool unknownType;
-                FactMetaData::ValueType_t foundType = FactMetaData::stringToType(type, unknownType);
+                FactMetaData::stringToType(type, unknownType);
                 if (unknownType) {
                     qWarning() << "Parameter meta data with bad type:" << type << " name:" << name;
-                    return;
+                    return false;
                 }
                 
-                // Now that we know type we can create meta data object and add it to the system
-                
-                metaData = new FactMetaData(foundType);
-                Q_CHECK_PTR(metaData);
-                if (_mapParameterName2FactMetaData.contains(name)) {
+                if (entryIndices.contains(name)) {
                     // We can't trust the meta dafa since we have dups
                     qCWarning(PX4ParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     badMetaData = true;
                     // Reset to default meta data
-                    _mapParameterName2FactMetaData[name] = metaData;
+                    entry = &entries[entryIndices[name]];
+                    *entry = ParameterMetaDataCache::Entry_t();
+                    entry->name = name;
+                    entry->type = type;
                 } else {
-                    _mapParameterName2FactMetaData[name] = metaData;
-                    metaData->setName(name);
-                    metaData->setGroup(factGroup);
-                    
-                    if (xml.attributes().hasAttribute("default") && !strDefault.isEmpty()) {
-                        QVariant varDefault;
-                        
-                        if (metaData->convertAndValidateRaw(strDefault, false, varDefault, errorString)) {
-                            metaData->setRawDefaultValue(varDefault);
-                        } else {
-                            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << name << " type:" << type << " default:" << strDefault << " error:" << errorString;
-                        }
+                    entryIndices[name] = entries.count();
+                    entries.append(ParameterMetaDataCache::Entry_t());
+                    entry = &entries.last();
+                    entry->name = name;
+                    entry->type = type;
+                    entry->group = factGroup;
+                    if (xml.attributes().hasAttribute("default")) {
+                        entry->defaultValue = strDefault;
                     }
                 }
                 
@@ -221,67 +235,48 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 // We should be getting meta data now
                 if (xmlState != XmlStateFoundParameter) {
                     qWarning() << "Badly formed XML";
-                    return;
+                    return false;
                 }
 
                 if (!badMetaData) {
-                    if (metaData) {
+                    if (entry) {
                         if (elementName == "short_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Short description:" << text;
-                            metaData->setShortDescription(text);
+                            entry->shortDescription = text;
 
                         } else if (elementName == "long_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Long description:" << text;
-                            metaData->setLongDescription(text);
+                            entry->longDescription = text;
 
                         } else if (elementName == "min") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Min:" << text;
-
-                            QVariant varMin;
-                            if (metaData->convertAndValidateRaw(text, true /* convertOnly */, varMin, errorString)) {
-                                metaData->setRawMin(varMin);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << text << " error:" << errorString;
-                            }
+                            entry->min = text;
 
                         } else if (elementName == "max") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Max:" << text;
-
-                            QVariant varMax;
-                            if (metaData->convertAndValidateRaw(text, true /* convertOnly */, varMax, errorString)) {
-                                metaData->setRawMax(varMax);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << text << " error:" << errorString;
-                            }
+                            entry->max = text;
 
                         } else if (elementName == "unit") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Unit:" << text;
-                            metaData->setRawUnits(text);
+                            entry->units = text;
 
                         } else if (elementName == "decimal") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Decimal:" << text;
-
-                            bool convertOk;
-                            QVariant varDecimals = QVariant(text).toUInt(&convertOk);
-                            if (convertOk) {
-                                metaData->setDecimalPlaces(varDecimals.toInt());
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << text << " error: invalid number";
-                            }
+                            entry->decimalPlaces = text;
 
                         } else if (elementName == "reboot_required") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "RebootRequired:" << text;
                             if (text.compare("true", Qt::CaseInsensitive) == 0) {
-                                metaData->setRebootRequired(true);
+                                entry->rebootRequired = true;
                             }
 
                         } else if (elementName == "values") {
@@ -292,60 +287,24 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QString enumString = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
                                                              << "value desc:" << enumString << "code:" << enumValueStr;
+                            entry->values << ParameterMetaDataCache::StringPair_t(enumValueStr, enumString);
 
-                            QVariant    enumValue;
-                            QString     errorString;
-                            if (metaData->convertAndValidateRaw(enumValueStr, false /* validate */, enumValue, errorString)) {
-                                metaData->addEnumInfo(enumString, enumValue);
-                            } else {
-                                qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
-                                                                 << " type:" << metaData->type() << " value:" << enumValueStr
-                                                                 << " error:" << errorString;
-                            }
                         } else if (elementName == "increment") {
-                            double  increment;
-                            bool    ok;
-                            QString text = xml.readElementText();
-                            increment = text.toDouble(&ok);
-                            if (ok) {
-                                metaData->setIncrement(increment);
-                            } else {
-                                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << text;
-                            }
+                            entry->increment = xml.readElementText();
 
                         } else if (elementName == "boolean") {
-                            QVariant    enumValue;
-                            metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Enabled"), enumValue);
-                            metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Disabled"), enumValue);
+                            entry->boolean = true;
 
                         } else if (elementName == "bitmask") {
                             // doing nothing individual bits will follow anyway. May be used for sanity checking.
 
                         } else if (elementName == "bit") {
-                            bool ok = false;
-                            unsigned char bit = xml.attributes().value("index").toString().toUInt(&ok);
-                            if (ok) {
-                                QString bitDescription = xml.readElementText();
-                                qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
-                                                                 << "index:" << bit << "description:" << bitDescription;
-
-                                if (bit < 31) {
-                                    QVariant bitmaskRawValue = 1 << bit;
-                                    QVariant bitmaskValue;
-                                    QString errorString;
-                                    if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
-                                        metaData->addBitmaskInfo(bitDescription, bitmaskValue);
-                                    } else {
-                                        qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
-                                                                         << " type:" << metaData->type() << " value:" << bitmaskValue
-                                                                         << " error:" << errorString;
-                                    }
-                                } else {
-                                    qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
-                                }
-                            }
+                            QString bitIndex = xml.attributes().value("index").toString();
+                            QString bitDescription = xml.readElementText();
+                            qCDebug(PX4ParameterMetaDataLog) << "parameter value:"
+                                                             << "index:" << bitIndex << "description:" << bitDescription;
+                            entry->bitmask << ParameterMetaDataCache::StringPair_t(bitIndex, bitDescription);
+
                         } else {
                             qCDebug(PX4ParameterMetaDataLog) << "Unknown element in XML: " << elementName;
                         }
@@ -358,17 +317,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
             QString elementName = xml.name().toString();
 
             if (elementName == "parameter") {
-                // Done loading this parameter, validate default value
-                if (metaData->defaultValueAvailable()) {
-                    QVariant var;
-
-                    if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
-                        qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
-                    }
-                }
-
                 // Reset for next parameter
-                metaData = NULL;
+                entry = NULL;
                 badMetaData = false;
                 xmlState = XmlStateFoundGroup;
             } else if (elementName == "group") {
@@ -379,15 +329,150 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         }
         xml.readNext();
     }
+
+    return true;
+}
+
+/// Creates the FactMetaData for a raw entry, with the same conversions and checks as the xml values always had
+FactMetaData* PX4ParameterMetaData::_createMetaData(const ParameterMetaDataCache::Entry_t& entry)
+{
+    QString errorString;
+    bool    unknownType;
+
+    FactMetaData* metaData = new FactMetaData(FactMetaData::stringToType(entry.type, unknownType));
+    metaData->setName(entry.name);
+    metaData->setGroup(entry.group);
+
+    if (!entry.defaultValue.isEmpty()) {
+        QVariant varDefault;
+        
+        if (metaData->convertAndValidateRaw(entry.defaultValue, false, varDefault, errorString)) {
+            metaData->setRawDefaultValue(varDefault);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << entry.name << " type:" << entry.type << " default:" << entry.defaultValue << " error:" << errorString;
+        }
+    }
+
+    if (!entry.shortDescription.isEmpty()) {
+        metaData->setShortDescription(entry.shortDescription);
+    }
+    if (!entry.longDescription.isEmpty()) {
+        metaData->setLongDescription(entry.longDescription);
+    }
+
+    if (!entry.min.isEmpty()) {
+        QVariant varMin;
+        if (metaData->convertAndValidateRaw(entry.min, true /* convertOnly */, varMin, errorString)) {
+            metaData->setRawMin(varMin);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid min value, name:" << metaData->name() << " type:" << metaData->type() << " min:" << entry.min << " error:" << errorString;
+        }
+    }
+
+    if (!entry.max.isEmpty()) {
+        QVariant varMax;
+        if (metaData->convertAndValidateRaw(entry.max, true /* convertOnly */, varMax, errorString)) {
+            metaData->setRawMax(varMax);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid max value, name:" << metaData->name() << " type:" << metaData->type() << " max:" << entry.max << " error:" << errorString;
+        }
+    }
+
+    if (!entry.units.isEmpty()) {
+        metaData->setRawUnits(entry.units);
+    }
+
+    if (!entry.decimalPlaces.isEmpty()) {
+        bool convertOk;
+        QVariant varDecimals = QVariant(entry.decimalPlaces).toUInt(&convertOk);
+        if (convertOk) {
+            metaData->setDecimalPlaces(varDecimals.toInt());
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid decimals value, name:" << metaData->name() << " type:" << metaData->type() << " decimals:" << entry.decimalPlaces << " error: invalid number";
+        }
+    }
+
+    if (entry.rebootRequired) {
+        metaData->setRebootRequired(true);
+    }
+
+    foreach (const ParameterMetaDataCache::StringPair_t& value, entry.values) {
+        QVariant    enumValue;
+        if (metaData->convertAndValidateRaw(value.first, false /* validate */, enumValue, errorString)) {
+            metaData->addEnumInfo(value.second, enumValue);
+        } else {
+            qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
+                                             << " type:" << metaData->type() << " value:" << value.first
+                                             << " error:" << errorString;
+        }
+    }
+
+    if (!entry.increment.isEmpty()) {
+        bool    ok;
+        double  increment = entry.increment.toDouble(&ok);
+        if (ok) {
+            metaData->setIncrement(increment);
+        } else {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << entry.increment;
+        }
+    }
+
+    if (entry.boolean) {
+        QVariant    enumValue;
+        metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Enabled"), enumValue);
+        metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
+        metaData->addEnumInfo(tr("Disabled"), enumValue);
+    }
+
+    foreach (const ParameterMetaDataCache::StringPair_t& bitmask, entry.bitmask) {
+        bool ok = false;
+        unsigned char bit = bitmask.first.toUInt(&ok);
+        if (ok) {
+            if (bit < 31) {
+                QVariant bitmaskRawValue = 1 << bit;
+                QVariant bitmaskValue;
+                if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, errorString)) {
+                    metaData->addBitmaskInfo(bitmask.second, bitmaskValue);
+                } else {
+                    qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
+                                                     << " type:" << metaData->type() << " value:" << bitmaskValue
+                                                     << " error:" << errorString;
+                }
+            } else {
+                qCWarning(PX4ParameterMetaDataLog) << "Invalid value for bitmask, bit:" << bit;
+            }
+        }
+    }
+
+    // Validate default value against the complete meta data
+    if (metaData->defaultValueAvailable()) {
+        QVariant var;
+
+        if (!metaData->convertAndValidateRaw(metaData->rawDefaultValue(), false /* convertOnly */, var, errorString)) {
+            qCWarning(PX4ParameterMetaDataLog) << "Invalid default value, name:" << metaData->name() << " type:" << metaData->type() << " default:" << metaData->rawDefaultValue() << " error:" << errorString;
+        }
+    }
+
+    return metaData;
 }
 
 void PX4ParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
     Q_UNUSED(vehicleType)
 
-    if (_mapParameterName2FactMetaData.contains(fact->name())) {
-        fact->setMetaData(_mapParameterName2FactMetaData[fact->name()]);
+    // Meta data is only created for the parameters the vehicle actually has, and shared by all Facts with the same name
+    FactMetaData* metaData = _mapParameterName2FactMetaData.value(fact->name());
+    if (!metaData) {
+        ParameterMetaDataCache::Entry_t entry;
+        if (!_metaDataCache.find(QString(), fact->name(), entry)) {
+            return;
+        }
+        metaData = _createMetaData(entry);
+        _mapParameterName2FactMetaData[fact->name()] = metaData;
     }
+
+    fact->setMetaData(metaData);
 }
 
 void PX4ParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
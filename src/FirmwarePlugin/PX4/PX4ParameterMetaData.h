@@ -17,6 +17,7 @@
 #include <QLoggingCategory>
 
 #include "FactSystem.h"
+#include "ParameterMetaDataCache.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
 
@@ -49,9 +50,12 @@ private:
     };    
 
     QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
+    bool _parseParameterFactMetaData(const QString& metaDataFile, const QByteArray& xmlBytes, QList<ParameterMetaDataCache::Entry_t>& entries);
+    FactMetaData* _createMetaData(const ParameterMetaDataCache::Entry_t& entry);
 
     bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, FactMetaData*> _mapParameterName2FactMetaData; ///< Maps from a parameter name to FactMetaData
+    ParameterMetaDataCache _metaDataCache;  ///< Raw meta data for all parameters in the xml
+    QMap<QString, FactMetaData*> _mapParameterName2FactMetaData; ///< Maps from a parameter name to FactMetaData, created on first use
 };
 
 #endif
@@ -64,7 +64,16 @@ MissionController::MissionController(PlanMasterController* masterController, QOb
     , _structureScanMissionItemName(tr("Structure Scan"))
     , _appSettings(qgcApp()->toolbox()->settingsManager()->appSettings())
     , _progressPct(0)
+    , _altPercentMinAlt(qQNaN())
+    , _altPercentMaxAlt(qQNaN())
+    , _pendingRecalcs(0)
+    , _pendingFlightStatusIndex(0)
+    , _recalcRequestCount(0)
+    , _recalcRunCount(0)
 {
+    _recalcTimer.setSingleShot(true);
+    connect(&_recalcTimer, &QTimer::timeout, this, &MissionController::_processPendingRecalcs);
+
     _resetMissionFlightStatus();
     managerVehicleChanged(_managerVehicle);
 }
@@ -216,6 +225,7 @@ void MissionController::sendToVehicle(void)
         qCWarning(MissionControllerLog) << "MissionControllerLog::sendToVehicle called while syncInProgress";
     } else {
         qCDebug(MissionControllerLog) << "MissionControllerLog::sendToVehicle";
+        _processPendingRecalcs();
         if (_visualItems->count() == 1) {
             // This prevents us from sending a possibly bogus home position to the vehicle
             QmlObjectListModel emptyModel;
@@ -262,6 +272,8 @@ bool MissionController::_convertToMissionItems(QmlObjectListModel* visualMission
 
 void MissionController::convertToKMLDocument(QDomDocument& document)
 {
+    _processPendingRecalcs();
+
     QJsonObject missionJson;
     QmlObjectListModel* visualItems = new QmlObjectListModel();
     QList<MissionItem*> missionItens;
@@ -315,6 +327,8 @@ void MissionController::sendItemsToVehicle(Vehicle* vehicle, QmlObjectListModel*
 
 int MissionController::_nextSequenceNumber(void)
 {
+    _processPendingRecalcs();
+
     if (_visualItems->count() == 0) {
         qWarning() << "Internal error: Empty visual item list";
         return 0;
@@ -860,6 +874,8 @@ bool MissionController::loadTextFile(QFile& file, QString& errorString)
 
 void MissionController::save(QJsonObject& json)
 {
+    _processPendingRecalcs();
+
     json[JsonHelper::jsonVersionKey] = _missionFileVersion;
 
     // Mission settings
@@ -942,7 +958,7 @@ double MissionController::_calcDistanceToHome(VisualMissionItem* currentItem, Vi
     return distanceOk ? homeCoord.distanceTo(currentCoord) : 0.0;
 }
 
-void MissionController::_addWaypointLineSegment(CoordVectHashTable& prevItemPairHashTable, VisualItemPair& pair)
+CoordinateVector* MissionController::_addWaypointLineSegment(CoordVectHashTable& prevItemPairHashTable, VisualItemPair& pair)
 {
     if (prevItemPairHashTable.contains(pair)) {
         // Pair already exists and connected, just re-use
@@ -956,12 +972,10 @@ void MissionController::_addWaypointLineSegment(CoordVectHashTable& prevItemPair
         // Use signals/slots to update the coordinate endpoints
         connect(pair.first,     originNotifier, linevect, &CoordinateVector::setCoordinate1);
         connect(pair.second,    endNotifier,    linevect, &CoordinateVector::setCoordinate2);
-
-        // FIXME: We should ideally have signals for 2D position change, alt change, and 3D position change
-        // Not optimal, but still pretty fast, do a full update of range/bearing/altitudes
-        connect(pair.second, &VisualMissionItem::coordinateChanged, this, &MissionController::_recalcMissionFlightStatus);
         _linesTable[pair] = linevect;
     }
+
+    return _linesTable[pair];
 }
 
 void MissionController::_recalcWaypointLines(void)
@@ -975,7 +989,9 @@ void MissionController::_recalcWaypointLines(void)
 
     CoordVectHashTable old_table = _linesTable;
     _linesTable.clear();
-    _waypointLines.clear();
+
+    // Lines in mission order
+    QObjectList objs;
 
     bool linkEndToHome;
     SimpleMissionItem* lastItem = _visualItems->value<SimpleMissionItem*>(_visualItems->count() - 1);
@@ -1003,7 +1019,7 @@ void MissionController::_recalcWaypointLines(void)
                 firstCoordinateItem = false;
                 VisualItemPair pair(lastCoordinateItem, item);
                 if (lastCoordinateItem != _settingsItem || (showHomePosition && linkStartToHome)) {
-                    _addWaypointLineSegment(old_table, pair);
+                    objs.append(_addWaypointLineSegment(old_table, pair));
                 }
                 lastCoordinateItem = item;
             }
@@ -1011,17 +1027,15 @@ void MissionController::_recalcWaypointLines(void)
     }
     if (linkEndToHome && lastCoordinateItem != _settingsItem && showHomePosition) {
         VisualItemPair pair(lastCoordinateItem, _settingsItem);
-        _addWaypointLineSegment(old_table, pair);
+        objs.append(_addWaypointLineSegment(old_table, pair));
     }
 
-    {
-        // Create a temporary QObjectList and replace the model data
-        QObjectList objs;
-        objs.reserve(_linesTable.count());
-        foreach(CoordinateVector *vect, _linesTable.values()) {
-            objs.append(vect);
-        }
-
+    // Only replace the model data if the lines changed, which keeps the map from rebuilding all line delegates
+    bool linesChanged = objs.count() != _waypointLines.count();
+    for (int i=0; !linesChanged && i<objs.count(); i++) {
+        linesChanged = objs[i] != _waypointLines.get(i);
+    }
+    if (linesChanged) {
         // We don't delete here because many links may still be valid
         _waypointLines.swapObjectList(objs);
     }
@@ -1030,6 +1044,7 @@ void MissionController::_recalcWaypointLines(void)
     qDeleteAll(old_table);
 
     _recalcMissionFlightStatus();
+    _pendingRecalcs &= ~(RecalcWaypointLines | RecalcFlightStatus | RecalcFlightStatusFrom);
 
     emit waypointLinesChanged();
 }
@@ -1111,37 +1126,161 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
     }
 }
 
-void MissionController::_recalcMissionFlightStatus()
+/// Recalculates the flight status of all items
+void MissionController::_recalcMissionFlightStatus(void)
 {
-    if (!_visualItems->count()) {
+    _waypointSegments.clear();
+    _recalcMissionFlightStatusFrom(0);
+}
+
+/// Called when a value which only affects the flight status from the signalling item on changes
+void MissionController::_itemFlightStatusChanged(void)
+{
+    VisualMissionItem* item = qobject_cast<VisualMissionItem*>(sender());
+    int index = item ? _visualItems->indexOf(item) : -1;
+
+    if (index < 0) {
+        // Item is still being set up, everything is recalculated once it is added to the mission
+        return;
+    }
+    if (_flightStatusCheckpoints.count() != _visualItems->count()) {
+        _scheduleRecalc(RecalcFlightStatus);
         return;
     }
 
-    bool                firstCoordinateItem =   true;
-    VisualMissionItem*  lastCoordinateItem =    qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+    _dirtySegmentItems.insert(item);
+    if (_pendingRecalcs & RecalcFlightStatusFrom) {
+        index = qMin(index, _pendingFlightStatusIndex);
+    }
+    _pendingFlightStatusIndex = index;
+    _scheduleRecalc(RecalcFlightStatusFrom);
+}
+
+void MissionController::_scheduleRecalcSequence(void)
+{
+    _scheduleRecalc(RecalcSequence);
+}
+
+void MissionController::_scheduleRecalcWaypointLines(void)
+{
+    _scheduleRecalc(RecalcWaypointLines);
+}
+
+void MissionController::_scheduleRecalcMissionFlightStatus(void)
+{
+    _scheduleRecalc(RecalcFlightStatus);
+}
+
+/// Queues recalculations requested by an item signal. A single plan edit, loading a survey or dragging an item
+/// signals many changes in a row. They are merged into one pass which runs when control returns to the event
+/// loop, and while changes keep coming at most once per display frame.
+///     @param recalcs Recalc_t flags
+void MissionController::_scheduleRecalc(int recalcs)
+{
+    _recalcRequestCount++;
+    _pendingRecalcs |= recalcs;
+
+    if (!_recalcTimer.isActive()) {
+        qint64 elapsed = _lastRecalcTimer.isValid() ? qMin(_lastRecalcTimer.elapsed(), (qint64)_recalcMinIntervalMSecs) : _recalcMinIntervalMSecs;
+        _recalcTimer.start(_recalcMinIntervalMSecs - (int)elapsed);
+    }
+}
+
+/// Runs the queued recalculations now. Called from the timer, and before anything which needs up to date
+/// sequence numbers or flight status.
+void MissionController::_processPendingRecalcs(void)
+{
+    _recalcTimer.stop();
+    if (!_pendingRecalcs || !_visualItems) {
+        _pendingRecalcs = 0;
+        return;
+    }
+
+    int recalcs = _pendingRecalcs;
+    _recalcRunCount++;
+    _lastRecalcTimer.start();
+
+    qCDebug(MissionControllerLog) << "_processPendingRecalcs" << recalcs << "requests:runs" << _recalcRequestCount << _recalcRunCount;
+
+    if (recalcs & RecalcSequence) {
+        _recalcSequence();
+    }
+    if (recalcs & RecalcWaypointLines) {
+        _recalcWaypointLines();
+    } else if (recalcs & RecalcFlightStatus) {
+        _recalcMissionFlightStatus();
+    } else if (recalcs & RecalcFlightStatusFrom) {
+        _recalcMissionFlightStatusFrom(_pendingFlightStatusIndex);
+    }
+
+    // Changes signalled while the passes ran are already covered by them
+    _pendingRecalcs = 0;
+}
+
+/// Recalculates the flight status starting at the specified item. Items before it are left alone, the calculation
+/// resumes from the state saved before the item by the last pass over it. The segment values between coordinate
+/// items are only recalculated if one of their end items changed.
+///     @param startIndex Index of first changed item, 0 for all items
+void MissionController::_recalcMissionFlightStatusFrom(int startIndex)
+{
+    if (!_visualItems->count()) {
+        return;
+    }
 
     bool showHomePosition = _settingsItem->coordinate().isValid();
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus startIndex" << startIndex;
 
     // If home position is valid we can calculate distances between all waypoints.
     // If home position is not valid we can only calculate distances between waypoints which are
     // both relative altitude.
 
-    // No values for first item
-    lastCoordinateItem->setAltDifference(0.0);
-    lastCoordinateItem->setAzimuth(0.0);
-    lastCoordinateItem->setDistance(0.0);
-
-    double minAltSeen = 0.0;
-    double maxAltSeen = 0.0;
     const double homePositionAltitude = _settingsItem->coordinate().altitude();
-    minAltSeen = maxAltSeen = _settingsItem->coordinate().altitude();
 
-    _resetMissionFlightStatus();
+    if (_flightStatusCheckpoints.count() != _visualItems->count() || startIndex >= _visualItems->count()) {
+        startIndex = 0;
+    }
+    if (_waypointSegments.count() != _visualItems->count()) {
+        WaypointSegment_t emptySegment = { NULL, 0.0, 0.0, 0.0, 0.0 };
+        _waypointSegments.fill(emptySegment, _visualItems->count());
+    }
+
+    bool                firstCoordinateItem;
+    VisualMissionItem*  lastCoordinateItem;
+    bool                vtolInHover;
+    bool                linkStartToHome;
+    double              minAltSeen;
+    double              maxAltSeen;
+
+    if (startIndex == 0) {
+        _flightStatusCheckpoints.resize(_visualItems->count());
+
+        firstCoordinateItem = true;
+        lastCoordinateItem = qobject_cast<VisualMissionItem*>(_visualItems->get(0));
+
+        // No values for first item
+        lastCoordinateItem->setAltDifference(0.0);
+        lastCoordinateItem->setAzimuth(0.0);
+        lastCoordinateItem->setDistance(0.0);
+
+        minAltSeen = maxAltSeen = _settingsItem->coordinate().altitude();
+
+        _resetMissionFlightStatus();
+
+        vtolInHover = true;
+        linkStartToHome = false;
+    } else {
+        const FlightStatusCheckpoint_t& checkpoint = _flightStatusCheckpoints[startIndex];
+
+        _missionFlightStatus =  checkpoint.missionFlightStatus;
+        firstCoordinateItem =   checkpoint.firstCoordinateItem;
+        lastCoordinateItem =    checkpoint.lastCoordinateItem;
+        vtolInHover =           checkpoint.vtolInHover;
+        linkStartToHome =       checkpoint.linkStartToHome;
+        minAltSeen =            checkpoint.minAltSeen;
+        maxAltSeen =            checkpoint.maxAltSeen;
+    }
 
-    bool vtolInHover = true;
-    bool linkStartToHome = false;
     bool linkEndToHome = false;
 
     if (showHomePosition) {
@@ -1153,14 +1292,23 @@ void MissionController::_recalcMissionFlightStatus()
         }
     }
 
-    for (int i=0; i<_visualItems->count(); i++) {
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(item);
 
-        // Assume the worst
-        item->setAzimuth(0.0);
-        item->setDistance(0.0);
+        FlightStatusCheckpoint_t& checkpoint = _flightStatusCheckpoints[i];
+        checkpoint.missionFlightStatus =    _missionFlightStatus;
+        checkpoint.firstCoordinateItem =    firstCoordinateItem;
+        checkpoint.lastCoordinateItem =     lastCoordinateItem;
+        checkpoint.vtolInHover =            vtolInHover;
+        checkpoint.linkStartToHome =        linkStartToHome;
+        checkpoint.minAltSeen =             minAltSeen;
+        checkpoint.maxAltSeen =             maxAltSeen;
+
+        // Assume the worst, set once below so the values only signal a change if they really changed
+        double itemAzimuth = 0.0;
+        double itemDistance = 0.0;
 
         // Look for speed changed
         double newSpeed = item->specifiedFlightSpeed();
@@ -1190,6 +1338,8 @@ void MissionController::_recalcMissionFlightStatus()
 
         if (i == 0) {
             // We only process speed and gimbal from Mission Settings item
+            item->setAzimuth(itemAzimuth);
+            item->setDistance(itemDistance);
             continue;
         }
 
@@ -1260,19 +1410,23 @@ void MissionController::_recalcMissionFlightStatus()
                 firstCoordinateItem = false;
                 if (lastCoordinateItem != _settingsItem || linkStartToHome) {
                     // This is a subsequent waypoint or we are forcing the first waypoint back to home
-                    double azimuth, distance, altDifference;
+                    WaypointSegment_t& segment = _waypointSegments[i];
+                    if (segment.prevItem != lastCoordinateItem || _dirtySegmentItems.contains(item) || _dirtySegmentItems.contains(lastCoordinateItem)) {
+                        segment.prevItem = lastCoordinateItem;
+                        _calcPrevWaypointValues(homePositionAltitude, item, lastCoordinateItem, &segment.azimuth, &segment.distance, &segment.altDifference);
+                        segment.distanceToHome = _calcDistanceToHome(item, _settingsItem);
+                    }
 
-                    _calcPrevWaypointValues(homePositionAltitude, item, lastCoordinateItem, &azimuth, &distance, &altDifference);
-                    item->setAltDifference(altDifference);
-                    item->setAzimuth(azimuth);
-                    item->setDistance(distance);
+                    item->setAltDifference(segment.altDifference);
+                    itemAzimuth = segment.azimuth;
+                    itemDistance = segment.distance;
 
-                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
+                    _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, segment.distanceToHome);
 
                     // Calculate time/distance
-                    double hoverTime = distance / _missionFlightStatus.hoverSpeed;
-                    double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
-                    _addTimeDistance(vtolInHover, hoverTime, cruiseTime, 0, distance, item->sequenceNumber());
+                    double hoverTime = segment.distance / _missionFlightStatus.hoverSpeed;
+                    double cruiseTime = segment.distance / _missionFlightStatus.cruiseSpeed;
+                    _addTimeDistance(vtolInHover, hoverTime, cruiseTime, 0, segment.distance, item->sequenceNumber());
                 }
 
                 if (complexItem) {
@@ -1291,8 +1445,12 @@ void MissionController::_recalcMissionFlightStatus()
 
             lastCoordinateItem = item;
         }
+
+        item->setAzimuth(itemAzimuth);
+        item->setDistance(itemDistance);
     }
     lastCoordinateItem->setMissionVehicleYaw(_missionFlightStatus.vehicleYaw);
+    _dirtySegmentItems.clear();
 
     if (linkEndToHome && lastCoordinateItem != _settingsItem) {
         double azimuth, distance, altDifference;
@@ -1319,9 +1477,14 @@ void MissionController::_recalcMissionFlightStatus()
     emit batteryChangePointChanged(_missionFlightStatus.batteryChangePoint);
     emit batteriesRequiredChanged(_missionFlightStatus.batteriesRequired);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. If the altitude range did not change the
+    // percentages before the first changed item are still valid.
+    int altPercentStartIndex = minAltSeen == _altPercentMinAlt && maxAltSeen == _altPercentMaxAlt ? startIndex : 0;
+    _altPercentMinAlt = minAltSeen;
+    _altPercentMaxAlt = maxAltSeen;
+
     double altRange = maxAltSeen - minAltSeen;
-    for (int i=0; i<_visualItems->count(); i++) {
+    for (int i=altPercentStartIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1401,6 +1564,10 @@ void MissionController::_recalcAll(void)
     _recalcSequence();
     _recalcChildItems();
     _recalcWaypointLines();
+
+    // Everything queued by item signals is covered by the full recalculation
+    _pendingRecalcs = 0;
+    _recalcTimer.stop();
 }
 
 /// Initializes a new set of mission items
@@ -1453,19 +1620,26 @@ void MissionController::_deinitAllVisualItems(void)
 
     disconnect(_visualItems, &QmlObjectListModel::dirtyChanged, this, &MissionController::dirtyChanged);
     disconnect(_visualItems, &QmlObjectListModel::countChanged, this, &MissionController::_updateContainsItems);
+
+    // Queued recalculations refer to the items going away
+    _pendingRecalcs = 0;
+    _recalcTimer.stop();
 }
 
 void MissionController::_initVisualItem(VisualMissionItem* visualItem)
 {
     setDirty(false);
 
-    connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::coordinateHasRelativeAltitudeChanged,       this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::exitCoordinateHasRelativeAltitudeChanged,   this, &MissionController::_recalcWaypointLines);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatus);
-    connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
+    // Recalculations are deferred and merged, see _scheduleRecalc. Only the segments touching a moved item and the totals
+    // after it are recalculated.
+    connect(visualItem, &VisualMissionItem::coordinateChanged,                          this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_scheduleRecalcWaypointLines);
+    connect(visualItem, &VisualMissionItem::coordinateHasRelativeAltitudeChanged,       this, &MissionController::_scheduleRecalcWaypointLines);
+    connect(visualItem, &VisualMissionItem::exitCoordinateHasRelativeAltitudeChanged,   this, &MissionController::_scheduleRecalcWaypointLines);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_scheduleRecalcSequence);
 
     if (visualItem->isSimpleItem()) {
         // We need to track commandChanged on simple item since recalc has special handling for takeoff command
@@ -1478,9 +1652,10 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatus);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatus);
-            connect(complexItem, &ComplexMissionItem::additionalTimeDelayChanged,   this, &MissionController::_recalcMissionFlightStatus);
+            connect(complexItem, &ComplexMissionItem::exitCoordinateChanged,        this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::additionalTimeDelayChanged,   this, &MissionController::_itemFlightStatusChanged);
         } else {
             qWarning() << "ComplexMissionItem not found";
         }
@@ -1525,8 +1700,8 @@ void MissionController::managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_missionManager, &MissionManager::resumeMissionUploadFail,  this, &MissionController::resumeMissionUploadFail);
     connect(_managerVehicle, &Vehicle::homePositionChanged,             this, &MissionController::_managerVehicleHomePositionChanged);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatus);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatus);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_scheduleRecalcMissionFlightStatus);
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_scheduleRecalcMissionFlightStatus);
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     if (!_masterController->offline()) {
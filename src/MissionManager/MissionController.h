@@ -18,6 +18,10 @@
 #include "MavlinkQmlSingleton.h"
 
 #include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
 
 class CoordinateVector;
 class VisualMissionItem;
@@ -37,6 +41,8 @@ class MissionController : public PlanElementController
 {
     Q_OBJECT
 
+    friend class MissionControllerTest; ///< This allows our unit test to compare incremental and full recalculation
+
 public:
     MissionController(PlanMasterController* masterController, QObject* parent = NULL);
     ~MissionController();
@@ -151,6 +157,9 @@ public:
     int  batteryChangePoint         (void) const { return _missionFlightStatus.batteryChangePoint; }    ///< -1 for not supported, 0 for not needed
     int  batteriesRequired          (void) const { return _missionFlightStatus.batteriesRequired; }     ///< -1 for not supported
 
+    int  recalcRequestCount         (void) const { return _recalcRequestCount; }    ///< Item signals which requested a deferred recalculation
+    int  recalcRunCount             (void) const { return _recalcRunCount; }        ///< Deferred recalculation passes run for those requests
+
 signals:
     void visualItemsChanged(void);
     void waypointLinesChanged(void);
@@ -180,6 +189,11 @@ private slots:
     void _currentMissionIndexChanged(int sequenceNumber);
     void _recalcWaypointLines(void);
     void _recalcMissionFlightStatus(void);
+    void _itemFlightStatusChanged(void);
+    void _scheduleRecalcSequence(void);
+    void _scheduleRecalcWaypointLines(void);
+    void _scheduleRecalcMissionFlightStatus(void);
+    void _processPendingRecalcs(void);
     void _updateContainsItems(void);
     void _progressPctChanged(double progressPct);
     void _visualItemsDirtyChanged(bool dirty);
@@ -216,11 +230,41 @@ private:
     void _updateBatteryInfo(int waypointIndex);
     bool _loadItemsFromJson(const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     void _initLoadedVisualItems(QmlObjectListModel* loadedVisualItems);
-    void _addWaypointLineSegment(CoordVectHashTable& prevItemPairHashTable, VisualItemPair& pair);
+    CoordinateVector* _addWaypointLineSegment(CoordVectHashTable& prevItemPairHashTable, VisualItemPair& pair);
+    void _recalcMissionFlightStatusFrom(int startIndex);
+    void _scheduleRecalc(int recalcs);
     void _addCommandTimeDelay(SimpleMissionItem* simpleItem, bool vtolInHover);
     void _addTimeDistance(bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum);
 
 private:
+    /// State of the flight status calculation before an item, so a recalculation can resume at the first changed item
+    typedef struct {
+        MissionFlightStatus_t   missionFlightStatus;
+        VisualMissionItem*      lastCoordinateItem;
+        bool                    firstCoordinateItem;
+        bool                    linkStartToHome;
+        bool                    vtolInHover;
+        double                  minAltSeen;
+        double                  maxAltSeen;
+    } FlightStatusCheckpoint_t;
+
+    /// Recalculations requested by item signals, run together by _processPendingRecalcs
+    typedef enum {
+        RecalcSequence =            1 << 0,
+        RecalcWaypointLines =       1 << 1,     ///< Also recalculates the full flight status
+        RecalcFlightStatus =        1 << 2,
+        RecalcFlightStatusFrom =    1 << 3,     ///< Flight status from _pendingFlightStatusIndex on
+    } Recalc_t;
+
+    /// Values of the segment from the previous coordinate item to an item
+    typedef struct {
+        VisualMissionItem*  prevItem;           ///< NULL: not calculated yet
+        double              azimuth;
+        double              distance;
+        double              altDifference;
+        double              distanceToHome;
+    } WaypointSegment_t;
+
     MissionManager*         _missionManager;
     QmlObjectListModel*     _visualItems;
     MissionSettingsItem*    _settingsItem;
@@ -235,6 +279,21 @@ private:
     AppSettings*            _appSettings;
     double                  _progressPct;
 
+    QVector<FlightStatusCheckpoint_t>   _flightStatusCheckpoints;   ///< Indexed by visual item index
+    QVector<WaypointSegment_t>          _waypointSegments;          ///< Indexed by visual item index
+    QSet<VisualMissionItem*>            _dirtySegmentItems;         ///< Items whose segments must be recalculated
+    double                              _altPercentMinAlt;          ///< Altitude range of the last altitude percent update
+    double                              _altPercentMaxAlt;
+
+    QTimer                              _recalcTimer;
+    QElapsedTimer                       _lastRecalcTimer;           ///< Time since the last deferred recalculation pass
+    int                                 _pendingRecalcs;            ///< Recalc_t flags
+    int                                 _pendingFlightStatusIndex;
+    int                                 _recalcRequestCount;
+    int                                 _recalcRunCount;
+
+    static const int    _recalcMinIntervalMSecs = 16;   ///< One display frame at 60Hz
+
     static const char*  _settingsGroup;
 
     // Json file keys for persistence
@@ -248,3 +248,101 @@ void MissionControllerTest::_testLoadJsonSectionAvailable(void)
 
     }
 }
+
+void MissionControllerTest::_load800Waypoints(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    _masterController->loadFromFile(":/unittest/800Waypoints.mission");
+    QVERIFY(_missionController->visualItems()->count() > 800);
+}
+
+/// Moving a waypoint only recalculates from that waypoint on, the result must match a full recalculation
+void MissionControllerTest::_testIncrementalRecalc(void)
+{
+    _load800Waypoints();
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    int movedIndex = visualItems->count() / 2;
+    VisualMissionItem* movedItem = visualItems->value<VisualMissionItem*>(movedIndex);
+    QGeoCoordinate coordinate = movedItem->coordinate().atDistanceAndAzimuth(250, 45);
+    coordinate.setAltitude(coordinate.altitude() + 500);
+    movedItem->setCoordinate(coordinate);
+    _missionController->_processPendingRecalcs();
+
+    QList<double> incremental;
+    for (int i=0; i<visualItems->count(); i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        incremental << item->distance() << item->azimuth() << item->altDifference() << item->altPercent() << item->missionVehicleYaw();
+    }
+    double incrementalDistance = _missionController->missionDistance();
+    double incrementalTime = _missionController->missionTime();
+    double incrementalMaxTelemetry = _missionController->missionMaxTelemetry();
+
+    _missionController->_recalcMissionFlightStatus();
+
+    QList<double> full;
+    for (int i=0; i<visualItems->count(); i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        full << item->distance() << item->azimuth() << item->altDifference() << item->altPercent() << item->missionVehicleYaw();
+    }
+    QCOMPARE(incremental, full);
+    QCOMPARE(incrementalDistance, _missionController->missionDistance());
+    QCOMPARE(incrementalTime, _missionController->missionTime());
+    QCOMPARE(incrementalMaxTelemetry, _missionController->missionMaxTelemetry());
+}
+
+void MissionControllerTest::_recalcBenchmark_test_data(void)
+{
+    QTest::addColumn<int>("movedItem");
+
+    QTest::newRow("fullRecalc") << -1;
+    QTest::newRow("dragFirstWaypoint") << 1;
+    QTest::newRow("dragMiddleWaypoint") << 400;
+    QTest::newRow("dragLastWaypoint") << 800;
+}
+
+/// Cost of the recalculation for a single waypoint drag step in a large mission, compared to a full recalculation
+void MissionControllerTest::_recalcBenchmark_test(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, movedItem);
+
+    _load800Waypoints();
+
+    VisualMissionItem* item = movedItem == -1 ? NULL : _missionController->visualItems()->value<VisualMissionItem*>(movedItem);
+    QGeoCoordinate coordinate = item ? item->coordinate() : QGeoCoordinate();
+    int step = 0;
+
+    QBENCHMARK {
+        if (item) {
+            item->setCoordinate(coordinate.atDistanceAndAzimuth(++step % 2 ? 10 : 0, 90));
+            _missionController->_processPendingRecalcs();
+        } else {
+            _missionController->_recalcMissionFlightStatus();
+        }
+    }
+}
+
+/// A burst of item changes must be merged into a single deferred recalculation
+void MissionControllerTest::_testRecalcCoalescing(void)
+{
+    _load800Waypoints();
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    int requestCount = _missionController->recalcRequestCount();
+    int runCount = _missionController->recalcRunCount();
+
+    for (int i=1; i<=100; i++) {
+        VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+        item->setCoordinate(item->coordinate().atDistanceAndAzimuth(20, 180));
+    }
+    QVERIFY(_missionController->recalcRequestCount() >= requestCount + 100);
+    QCOMPARE(_missionController->recalcRunCount(), runCount);
+
+    QTRY_COMPARE(_missionController->recalcRunCount(), runCount + 1);
+
+    double distance = _missionController->missionDistance();
+    _missionController->_recalcMissionFlightStatus();
+    QCOMPARE(_missionController->missionDistance(), distance);
+}
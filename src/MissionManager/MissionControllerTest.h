@@ -38,6 +38,10 @@ private slots:
     void _testEmptyVehiclePX4(void);
     void _testAddWayppointAPM(void);
     void _testAddWayppointPX4(void);
+    void _testIncrementalRecalc(void);
+    void _testRecalcCoalescing(void);
+    void _recalcBenchmark_test_data(void);
+    void _recalcBenchmark_test(void);
 
 private:
 #if 0
@@ -53,6 +57,7 @@ private:
     void _testOfflineToOnlineWorker(MAV_AUTOPILOT firmwareType);
 #endif
     void _setupVisualItemSignals(VisualMissionItem* visualItem);
+    void _load800Waypoints(void);
 
     // MissiomItems signals
 
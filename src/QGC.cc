@@ -10,7 +10,21 @@
 
 #include "QGC.h"
 #include <qmath.h>
+#include <QtEndian>
 #include <float.h>
+#include <string.h>
+
+// Carry-less multiply CRC32 on x86, compiled for the instruction set at function level and used when the CPU has it
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define QGC_CRC32_CLMUL
+#define QGC_CRC32_CLMUL_TARGET __attribute__((target("sse2,pclmul")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define QGC_CRC32_CLMUL
+#define QGC_CRC32_CLMUL_TARGET
+#include <intrin.h>
+#endif
 
 namespace QGC
 {
@@ -117,12 +131,228 @@ static const quint32 crctab[] =
     0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
-quint32 crc32(const quint8 *src, unsigned len, unsigned state)
+// Slice-by-8: crcSlice[k][i] is the CRC of byte i followed by k zero bytes, so eight bytes are folded
+// into the state with eight independent table lookups per iteration instead of a dependent chain.
+struct Crc32SliceTables
+{
+    Crc32SliceTables()
+    {
+        for (int i = 0; i < 256; i++) {
+            table[0][i] = crctab[i];
+        }
+        for (int k = 1; k < 8; k++) {
+            for (int i = 0; i < 256; i++) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ crctab[table[k - 1][i] & 0xff];
+            }
+        }
+    }
+
+    quint32 table[8][256];
+};
+
+static quint32 crc32SliceBy8(const quint8 *src, unsigned len, quint32 state)
 {
-    for (unsigned i = 0; i < len; i++) {
-        state = crctab[(state ^ src[i]) & 0xff] ^ (state >> 8);
+    static const Crc32SliceTables tables;
+    const quint32 (*t)[256] = tables.table;
+
+    while (len >= 8) {
+        quint32 one = qFromLittleEndian<quint32>(src) ^ state;
+        quint32 two = qFromLittleEndian<quint32>(src + 4);
+        state = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+                t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^ t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+        src += 8;
+        len -= 8;
+    }
+    while (len--) {
+        state = crctab[(state ^ *src++) & 0xff] ^ (state >> 8);
     }
     return state;
 }
 
+#ifdef QGC_CRC32_CLMUL
+
+static bool crc32CpuHasClmul()
+{
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = info[2];
+    edx = info[3];
+#else
+    unsigned int eax, ebx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+#endif
+    // PCLMULQDQ and SSE2
+    return (ecx & (1 << 1)) && (edx & (1 << 26));
+}
+
+// Folds 64 bytes per iteration with carry-less multiplies, then reduces to 32 bits with a Barrett reduction.
+// See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", Intel 2009. The constants are
+// for the bit reflected 0xEDB88320 polynomial. The state goes in and comes out as is, like the table loop.
+// Requires len >= 64 and a multiple of 16.
+QGC_CRC32_CLMUL_TARGET
+static quint32 crc32Clmul(const quint8 *src, unsigned len, quint32 state)
+{
+    const __m128i k1k2 = _mm_set_epi64x(Q_INT64_C(0x01c6e41596), Q_INT64_C(0x0154442bd4));
+    const __m128i k3k4 = _mm_set_epi64x(Q_INT64_C(0x00ccaa009e), Q_INT64_C(0x01751997d0));
+    const __m128i k5k0 = _mm_set_epi64x(Q_INT64_C(0x0000000000), Q_INT64_C(0x0163cd6124));
+    const __m128i poly = _mm_set_epi64x(Q_INT64_C(0x01f7011641), Q_INT64_C(0x01db710641));
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(state)));
+    src += 64;
+    len -= 64;
+
+    // Four lanes of 16 bytes in parallel
+    x0 = k1k2;
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 0x30)));
+        src += 64;
+        len -= 64;
+    }
+
+    // Fold the lanes into one
+    x0 = k3k4;
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Remaining 16 byte blocks
+    while (len >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+        src += 16;
+        len -= 16;
+    }
+
+    // 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = k5k0;
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = poly;
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<quint32>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+
+#endif
+
+quint32 crc32(const quint8 *src, unsigned len, unsigned state)
+{
+#ifdef QGC_CRC32_CLMUL
+    static const bool hasClmul = crc32CpuHasClmul();
+    if (hasClmul && len >= 64) {
+        unsigned clmulLen = len & ~15u;
+        state = crc32Clmul(src, clmulLen, state);
+        src += clmulLen;
+        len -= clmulLen;
+    }
+#endif
+    return crc32SliceBy8(src, len, state);
+}
+
+// The CRC update is affine over GF(2): appending a byte maps the state s to A*s ^ b. A is a 32x32 bit matrix
+// stored as its columns, mat[i] being the image of bit i.
+struct Crc32Affine
+{
+    quint32 mat[32];
+    quint32 add;
+};
+
+static quint32 crc32MatrixTimes(const quint32 *mat, quint32 vec)
+{
+    quint32 sum = 0;
+    for (int i = 0; vec; i++, vec >>= 1) {
+        if (vec & 1) {
+            sum ^= mat[i];
+        }
+    }
+    return sum;
+}
+
+/// @return first applied after second
+static Crc32Affine crc32Compose(const Crc32Affine& first, const Crc32Affine& second)
+{
+    Crc32Affine result;
+    for (int i = 0; i < 32; i++) {
+        result.mat[i] = crc32MatrixTimes(first.mat, second.mat[i]);
+    }
+    result.add = crc32MatrixTimes(first.mat, second.add) ^ first.add;
+    return result;
+}
+
+quint32 crc32Fill(quint8 fill, unsigned len, unsigned state)
+{
+    // Short runs are cheaper to just feed through
+    if (len < 256) {
+        quint8 buffer[256];
+        memset(buffer, fill, len);
+        return crc32(buffer, len, state);
+    }
+
+    // Map for one fill byte, then raise it to the len'th power by squaring
+    Crc32Affine byte;
+    for (int i = 0; i < 32; i++) {
+        quint32 bit = 1u << i;
+        byte.mat[i] = crctab[bit & 0xff] ^ (bit >> 8);
+    }
+    byte.add = crctab[fill];
+
+    Crc32Affine result;
+    for (int i = 0; i < 32; i++) {
+        result.mat[i] = 1u << i;
+    }
+    result.add = 0;
+
+    while (len) {
+        if (len & 1) {
+            result = crc32Compose(byte, result);
+        }
+        len >>= 1;
+        if (len) {
+            byte = crc32Compose(byte, byte);
+        }
+    }
+
+    return crc32MatrixTimes(result.mat, state) ^ result.add;
+}
+
 }
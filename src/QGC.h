@@ -48,7 +48,16 @@ public:
     using QThread::usleep;
 };
 
+/**
+ * @brief Updates a CRC32 (polynomial 0xEDB88320, no inversion of the state) with the specified bytes
+ * @note Uses carry-less multiplication where the CPU supports it, slice-by-8 tables otherwise. Both give the
+ *       same result as a byte at a time table loop.
+ */
 quint32 crc32(const quint8 *src, unsigned len, unsigned state);
+/**
+ * @brief Updates a CRC32 as crc32() would for len bytes all set to fill, in O(log len)
+ */
+quint32 crc32Fill(quint8 fill, unsigned len, unsigned state);
 
 }
 
@@ -216,6 +216,7 @@ QGCMapEngine::init()
     } else {
         qCritical() << "Could not find suitable map cache directory.";
     }
+    _memCache.setMaxBytes(_memCacheBytes());
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
 }
@@ -246,6 +247,22 @@ QGCMapEngine::_wipeDirectory(const QString& dirPath)
 void
 QGCMapEngine::addTask(QGCMapTask* task)
 {
+    if(task->type() == QGCMapTask::taskFetchTile) {
+        QGCFetchTileTask* fetchTask = static_cast<QGCFetchTileTask*>(task);
+        QGCCacheTile* tile = _memCache.find(fetchTask->hash());
+        if(tile) {
+            //-- Memory hit. The requester is already connected so we can answer right away.
+            fetchTask->setTileFetched(tile);
+            fetchTask->deleteLater();
+            return;
+        }
+        //-- Keep whatever the database returns. This runs in the worker thread.
+        connect(fetchTask, &QGCFetchTileTask::tileFetched, this, [this](QGCCacheTile* fetched) {
+            _memCache.insert(fetched->hash(), fetched->img(), fetched->format(), fetched->type());
+        }, Qt::DirectConnection);
+    } else if(task->type() == QGCMapTask::taskReset || task->type() == QGCMapTask::taskImport) {
+        _memCache.clear();
+    }
     _worker.enqueueTask(task);
 }
 
@@ -261,6 +278,10 @@ QGCMapEngine::cacheTile(UrlFactory::MapType type, int x, int y, int z, const QBy
 void
 QGCMapEngine::cacheTile(UrlFactory::MapType type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set)
 {
+    //-- Only tiles being viewed go in the memory cache. Tile set downloads would just flush it.
+    if(set == UINT64_MAX) {
+        _memCache.insert(hash, image, format, type);
+    }
     QGCSaveTileTask* task = new QGCSaveTileTask(new QGCCacheTile(hash, image, format, type, set));
     _worker.enqueueTask(task);
 }
@@ -398,6 +419,14 @@ QGCMapEngine::getMaxMemCache()
     return _maxMemCache;
 }
 
+//-----------------------------------------------------------------------------
+int
+QGCMapEngine::_memCacheBytes()
+{
+    //-- Setting is in MB, clamped to 1024 before converting so the byte count fits an int
+    return (int)((qint64)getMaxMemCache() * 1024 * 1024);
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMapEngine::setMaxMemCache(quint32 size)
@@ -408,6 +437,7 @@ QGCMapEngine::setMaxMemCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxMemCacheKey, size);
     _maxMemCache = size;
+    _memCache.setMaxBytes(_memCacheBytes());
 }
 
 //-----------------------------------------------------------------------------
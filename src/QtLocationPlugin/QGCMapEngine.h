@@ -24,6 +24,7 @@
 #include "QGCMapUrlEngine.h"
 #include "QGCMapEngineData.h"
 #include "QGCTileCacheWorker.h"
+#include "QGCTileMemCache.h"
 
 //-----------------------------------------------------------------------------
 class QGCTileSet
@@ -87,6 +88,8 @@ public:
     void                        testInternet        ();
     bool                        wasCacheReset       () { return _cacheWasReset; }
     bool                        isInternetActive    () { return _isInternetActive; }
+    QGCTileMemCache::Stats_t    memCacheStats       () { return _memCache.stats(); }
+    QGCCacheWorker::Stats_t     cacheWorkerStats    () { return _worker.stats(); }
 
     UrlFactory*                 urlFactory          () { return _urlFactory; }
 
@@ -113,9 +116,11 @@ private:
     void _wipeOldCaches         ();
     void _checkWipeDirectory    (const QString& dirPath);
     bool _wipeDirectory         (const QString& dirPath);
+    int  _memCacheBytes         ();
 
 private:
     QGCCacheWorker          _worker;
+    QGCTileMemCache         _memCache;
     QString                 _cachePath;
     QString                 _cacheFile;
     UrlFactory*             _urlFactory;
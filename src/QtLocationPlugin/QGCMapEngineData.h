@@ -23,6 +23,7 @@
 #include <QString>
 #include <QHash>
 #include <QDateTime>
+#include <QElapsedTimer>
 
 #include "QGCMapUrlEngine.h"
 
@@ -138,11 +139,16 @@ public:
         emit error(_type, errorString);
     }
 
+    //-- Time the task spent in the cache worker, from being queued until now
+    void                setQueued       () { _queued.start(); }
+    qint64              queuedMSecs     () const { return _queued.isValid() ? _queued.elapsed() : 0; }
+
 signals:
     void error          (QGCMapTask::TaskType type, QString errorString);
 
 private:
-    TaskType    _type;
+    TaskType        _type;
+    QElapsedTimer   _queued;
 };
 
 //-----------------------------------------------------------------------------
@@ -415,6 +421,11 @@ public:
         emit actionProgress(percentage);
     }
 
+    void setThroughput(double tilesPerSecond)
+    {
+        emit actionThroughput(tilesPerSecond);
+    }
+
 private:
     QVector<QGCCachedTileSet*>  _sets;
     QString                     _path;
@@ -422,6 +433,7 @@ private:
 signals:
     void actionCompleted        ();
     void actionProgress         (int percentage);
+    void actionThroughput       (double tilesPerSecond);
 
 };
 
@@ -453,6 +465,11 @@ public:
         emit actionProgress(percentage);
     }
 
+    void setThroughput(double tilesPerSecond)
+    {
+        emit actionThroughput(tilesPerSecond);
+    }
+
 private:
     QString                     _path;
     bool                        _replace;
@@ -460,6 +477,7 @@ private:
 signals:
     void actionCompleted        ();
     void actionProgress         (int percentage);
+    void actionThroughput       (double tilesPerSecond);
 
 };
 
@@ -19,6 +19,7 @@
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
 #include "QGCMapEngineManager.h"
+#include "QGCTileDownloader.h"
 
 #include <QSettings>
 #include <math.h>
@@ -27,6 +28,13 @@ QGC_LOGGING_CATEGORY(QGCCachedTileSetLog, "QGCCachedTileSetLog")
 
 #define TILE_BATCH_SIZE      256
 
+//-- Requests kept in flight for each concurrent download the map provider allows
+#define PIPELINE_DEPTH       4
+
+//-- Downloaded tiles are written to the cache in batches of this many, or after WRITE_FLUSH_MS
+#define WRITE_BATCH_SIZE     64
+#define WRITE_FLUSH_MS       500
+
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::QGCCachedTileSet(const QString& name)
     : _name(name)
@@ -47,22 +55,22 @@ QGCCachedTileSet::QGCCachedTileSet(const QString& name)
     , _downloading(false)
     , _id(0)
     , _type(UrlFactory::Invalid)
-    , _networkManager(NULL)
     , _errorCount(0)
+    , _downloader(NULL)
     , _noMoreTiles(false)
     , _batchRequested(false)
     , _manager(NULL)
     , _selected(false)
 {
-
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(WRITE_FLUSH_MS);
+    connect(&_flushTimer, &QTimer::timeout, this, &QGCCachedTileSet::_flushDownloadedTiles);
 }
 
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::~QGCCachedTileSet()
 {
-    if(_networkManager) {
-        delete _networkManager;
-    }
+    _flushDownloadedTiles();
 }
 
 //-----------------------------------------------------------------------------
@@ -72,6 +80,13 @@ QGCCachedTileSet::errorCountStr()
     return QGCMapEngine::numberToString(_errorCount);
 }
 
+//-----------------------------------------------------------------------------
+double
+QGCCachedTileSet::downloadRate()
+{
+    return _downloader ? _downloader->tilesPerSecond() : 0.0;
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCCachedTileSet::totalTileCountStr()
@@ -168,6 +183,11 @@ QGCCachedTileSet::cancelDownloadTask()
         _downloading = false;
         emit downloadingChanged();
     }
+    //-- Tiles not downloaded yet stay in the download list and are picked up again on resume
+    if(_downloader) {
+        _downloader->cancel();
+    }
+    _flushDownloadedTiles();
 }
 
 //-----------------------------------------------------------------------------
@@ -175,33 +195,44 @@ void
 QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
 {
     _batchRequested = false;
+    //-- Cancelled while the list was being fetched
+    if(!_downloading) {
+        qDeleteAll(tiles);
+        return;
+    }
     //-- Done?
     if(tiles.size() < TILE_BATCH_SIZE) {
         _noMoreTiles = true;
     }
-    if(!tiles.size()) {
-        _doneWithDownload();
-        return;
-    }
-    //-- If this is the first time, create Network Manager
-    if (!_networkManager) {
-        _networkManager = new QNetworkAccessManager(this);
+    if(tiles.size()) {
+        //-- If this is the first time, create the downloader
+        if(!_downloader) {
+            _downloader = new QGCTileDownloader(this);
+            _downloader->setMaxInFlight(QGCMapEngine::concurrentDownloads(_type) * PIPELINE_DEPTH);
+            connect(_downloader, &QGCTileDownloader::tileDownloaded,         this, &QGCCachedTileSet::_tileDownloaded);
+            connect(_downloader, &QGCTileDownloader::tileFailed,             this, &QGCCachedTileSet::_tileFailed);
+            connect(_downloader, &QGCTileDownloader::tilesPerSecondChanged,  this, &QGCCachedTileSet::downloadRateChanged);
+        }
+        //-- Kick downloads
+        _downloader->enqueue(tiles);
     }
-    //-- Add tiles to the list
-    _tilesToDownload += tiles;
-    //-- Kick downloads
     _prepareDownload();
 }
 
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_doneWithDownload()
 {
+    //-- Only queues the last writes. Done does not wait for them: a batch the cache fails to commit leaves its
+    //   tiles in the download list, where resuming the download picks them up again.
+    _flushDownloadedTiles();
     if(!_errorCount) {
         _totalTileCount = _savedTileCount;
         _totalTileSize  = _savedTileSize;
         //-- Too expensive to compute the real size now. Estimate it for the time being.
-        quint32 avg = _savedTileSize / _savedTileCount;
-        _uniqueTileSize = _uniqueTileCount * avg;
+        if(_savedTileCount) {
+            quint32 avg = _savedTileSize / _savedTileCount;
+            _uniqueTileSize = _uniqueTileCount * avg;
+        }
     }
     emit totalTileCountChanged();
     emit totalTilesSizeChanged();
@@ -216,7 +247,7 @@ void QGCCachedTileSet::_doneWithDownload()
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_prepareDownload()
 {
-    if(!_tilesToDownload.count()) {
+    if(!_downloader || _downloader->idle()) {
         //-- Are we done?
         if(_noMoreTiles) {
             _doneWithDownload();
@@ -226,122 +257,72 @@ void QGCCachedTileSet::_prepareDownload()
         }
         return;
     }
-    //-- Prepare queue (QNetworkAccessManager has a limit for concurrent downloads)
-    for(int i = _replies.count(); i < QGCMapEngine::concurrentDownloads(_type); i++) {
-        if(_tilesToDownload.count()) {
-            QGCTile* tile = _tilesToDownload.first();
-            _tilesToDownload.removeFirst();
-            QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
-            request.setAttribute(QNetworkRequest::User, tile->hash());
-#if !defined(__mobile__)
-            QNetworkProxy proxy = _networkManager->proxy();
-            QNetworkProxy tProxy;
-            tProxy.setType(QNetworkProxy::DefaultProxy);
-            _networkManager->setProxy(tProxy);
-#endif
-            QNetworkReply* reply = _networkManager->get(request);
-            reply->setParent(0);
-            connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
-            connect(reply, static_cast<void (QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error), this, &QGCCachedTileSet::_networkReplyError);
-            _replies.insert(tile->hash(), reply);
-#if !defined(__mobile__)
-            _networkManager->setProxy(proxy);
-#endif
-            delete tile;
-            //-- Refill queue if running low
-            if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (QGCMapEngine::concurrentDownloads(_type) * 10)) {
-                //-- Request new batch of tiles
-                createDownloadTask();
-            }
-        }
+    //-- Refill queue if running low, so the pipeline never drains while the next batch is read
+    if(!_batchRequested && !_noMoreTiles && _downloader->queuedCount() < (QGCMapEngine::concurrentDownloads(_type) * 10)) {
+        //-- Request new batch of tiles
+        createDownloadTask();
     }
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCachedTileSet::_networkReplyFinished()
+QGCCachedTileSet::_tileDownloaded(QString hash, QByteArray image)
 {
-    //-- Figure out which reply this is
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    if(!reply) {
-        qWarning() << "QGCMapEngineManager::networkReplyFinished() NULL Reply";
-        return;
-    }
-    //-- Get tile hash
-    const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    if(!hash.isEmpty()) {
-        if(_replies.contains(hash)) {
-            _replies.remove(hash);
-        } else {
-            qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << hash;
+    UrlFactory::MapType type = getQGCMapEngine()->hashToType(hash);
+    QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
+    if(!format.isEmpty()) {
+        //-- Cache tile
+        _downloadedTiles.append(new QGCCacheTile(hash, image, format, type, _id));
+        if(_downloadedTiles.count() >= WRITE_BATCH_SIZE) {
+            _flushDownloadedTiles();
+        } else if(!_flushTimer.isActive()) {
+            _flushTimer.start();
         }
-        if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "QGCMapEngineManager::networkReplyFinished() Error:" << reply->errorString();
-            return;
+        //-- Updated cached (downloaded) data
+        _savedTileSize += image.size();
+        _savedTileCount++;
+        emit savedTileSizeChanged();
+        emit savedTileCountChanged();
+        //-- Update estimate
+        if(_savedTileCount % 10 == 0) {
+            quint32 avg = _savedTileSize / _savedTileCount;
+            _totalTileSize  = avg * _totalTileCount;
+            _uniqueTileSize = avg * _uniqueTileCount;
+            emit totalTilesSizeChanged();
+            emit uniqueTileSizeChanged();
         }
-        qCDebug(QGCCachedTileSetLog) << "Tile fetched" << hash;
-        QByteArray image = reply->readAll();
-        UrlFactory::MapType type = getQGCMapEngine()->hashToType(hash);
-        QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
-        if(!format.isEmpty()) {
-            //-- Cache tile
-            getQGCMapEngine()->cacheTile(type, hash, image, format, _id);
-            QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
-            getQGCMapEngine()->addTask(task);
-            //-- Updated cached (downloaded) data
-            _savedTileSize += image.size();
-            _savedTileCount++;
-            emit savedTileSizeChanged();
-            emit savedTileCountChanged();
-            //-- Update estimate
-            if(_savedTileCount % 10 == 0) {
-                quint32 avg = _savedTileSize / _savedTileCount;
-                _totalTileSize  = avg * _totalTileCount;
-                _uniqueTileSize = avg * _uniqueTileCount;
-                emit totalTilesSizeChanged();
-                emit uniqueTileSizeChanged();
-            }
-        }
-        //-- Setup a new download
-        _prepareDownload();
-    } else {
-        qWarning() << "QGCMapEngineManager::networkReplyFinished() Empty Hash";
     }
-    reply->deleteLater();
+    //-- Setup a new download
+    _prepareDownload();
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
+QGCCachedTileSet::_tileFailed(QString hash, QString errorString)
 {
-    //-- Figure out which reply this is
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    if (!reply) {
-        return;
-    }
     //-- Update error count
     _errorCount++;
     emit errorCountChanged();
-    //-- Get tile hash
-    QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    qCDebug(QGCCachedTileSetLog) << "Error fetching tile" << reply->errorString();
-    if(!hash.isEmpty()) {
-        if(_replies.contains(hash)) {
-            _replies.remove(hash);
-        } else {
-            qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << hash;
-        }
-        if (error != QNetworkReply::OperationCanceledError) {
-            qWarning() << "QGCMapEngineManager::networkReplyError() Error:" << reply->errorString();
-        }
-        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
-        getQGCMapEngine()->addTask(task);
-    } else {
-        qWarning() << "QGCMapEngineManager::networkReplyError() Empty Hash";
-    }
+    qWarning() << "QGCCachedTileSet::_tileFailed() Error:" << errorString;
+    QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
+    getQGCMapEngine()->addTask(task);
     //-- Setup a new download
     _prepareDownload();
-    reply->deleteLater();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCachedTileSet::_flushDownloadedTiles()
+{
+    _flushTimer.stop();
+    //-- Queued back to back, the cache worker writes the tiles and their download state in one transaction
+    foreach(QGCCacheTile* tile, _downloadedTiles) {
+        getQGCMapEngine()->cacheTile(tile->type(), tile->hash(), tile->img(), tile->format(), _id);
+        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, tile->hash());
+        getQGCMapEngine()->addTask(task);
+        delete tile;
+    }
+    _downloadedTiles.clear();
 }
 
 //-----------------------------------------------------------------------------
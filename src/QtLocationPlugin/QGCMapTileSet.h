@@ -24,6 +24,7 @@
 #include <QHash>
 #include <QDateTime>
 #include <QImage>
+#include <QTimer>
 
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngineData.h"
@@ -33,6 +34,7 @@ Q_DECLARE_LOGGING_CATEGORY(QGCCachedTileSetLog)
 
 class QGCTile;
 class QGCMapEngineManager;
+class QGCTileDownloader;
 
 //-----------------------------------------------------------------------------
 class QGCCachedTileSet : public QObject
@@ -71,6 +73,7 @@ public:
     Q_PROPERTY(bool         downloading         READ    downloading         NOTIFY downloadingChanged)
     Q_PROPERTY(quint32      errorCount          READ    errorCount          NOTIFY errorCountChanged)
     Q_PROPERTY(QString      errorCountStr       READ    errorCountStr       NOTIFY errorCountChanged)
+    Q_PROPERTY(double       downloadRate        READ    downloadRate        NOTIFY downloadRateChanged)     ///< Tiles per second
 
     Q_PROPERTY(bool         selected            READ    selected            WRITE  setSelected  NOTIFY selectedChanged)
 
@@ -111,6 +114,7 @@ public:
     bool        downloading             () { return _downloading; }
     quint32     errorCount              () { return _errorCount; }
     QString     errorCountStr           ();
+    double      downloadRate            ();
     bool        selected                () { return _selected; }
 
     void        setSelected             (bool sel);
@@ -146,13 +150,15 @@ signals:
     void        savedTileSizeChanged    ();
     void        completeChanged         ();
     void        errorCountChanged       ();
+    void        downloadRateChanged     ();
     void        selectedChanged         ();
     void        nameChanged             ();
 
 private slots:
     void _tileListFetched               (QList<QGCTile*> tiles);
-    void _networkReplyFinished          ();
-    void _networkReplyError             (QNetworkReply::NetworkError error);
+    void _tileDownloaded                (QString hash, QByteArray image);
+    void _tileFailed                    (QString hash, QString errorString);
+    void _flushDownloadedTiles          ();
 
 private:
     void        _prepareDownload        ();
@@ -179,11 +185,11 @@ private:
     QDateTime   _creationDate;
     quint64     _id;
     UrlFactory::MapType _type;
-    QNetworkAccessManager*  _networkManager;
-    QHash<QString, QNetworkReply*> _replies;
     quint32     _errorCount;
     //-- Tile download
-    QList<QGCTile *> _tilesToDownload;
+    QGCTileDownloader*      _downloader;
+    QList<QGCCacheTile*>    _downloadedTiles;   ///< Waiting to be written to the cache as one batch
+    QTimer                  _flushTimer;
     bool        _noMoreTiles;
     bool        _batchRequested;
     QGCMapEngineManager* _manager;
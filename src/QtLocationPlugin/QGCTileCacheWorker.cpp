@@ -26,12 +26,18 @@
 #include <QDateTime>
 #include <QApplication>
 #include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
 
 #include "time.h"
 
 const char* kDefaultSet = "Default Tile Set";
 const QString kSession          = QLatin1String("QGeoTileWorkerSession");
 const QString kExportSession    = QLatin1String("QGeoTileExportSession");
+//-- Schema names of databases attached to the cache connection for bulk copies
+const QString kExportSchema     = QLatin1String("ExportDB");
+const QString kImportSchema     = QLatin1String("ImportDB");
+const QString kPartialSuffix    = QLatin1String(".partial");
 
 QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 
@@ -40,9 +46,30 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-- Maximum number of queued tile writes run in a single transaction
+#define MAX_WRITE_BATCH     256
+
+//-- Number of reader threads serving tile fetches
+#define READER_COUNT        2
+
+//-- Number of tiles copied per transaction by export and import
+#define BULK_CHUNK_SIZE     4096
+
+//-- TileTotals row holding the totals for the whole Tiles table (set IDs start at 1)
+static const quint64 kAllTilesSetID = 0;
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
-    : _db(NULL)
+    : _readersStarted(false)
+    , _readersStop(false)
+    , _quitting(false)
+    , _reads(0)
+    , _writes(0)
+    , _readLatencyTotal(0)
+    , _readLatencyMax(0)
+    , _writeLatencyTotal(0)
+    , _writeLatencyMax(0)
+    , _db(NULL)
     , _valid(false)
     , _failed(false)
     , _defaultSet(UINT64_MAX)
@@ -54,13 +81,72 @@ QGCCacheWorker::QGCCacheWorker()
     , _updateTimeout(SHORT_TIMEOUT)
     , _hostLookupID(0)
 {
-
+    for(int i = 0; i < READER_COUNT; i++) {
+        _readers.append(new QGCCacheReader(this, i));
+    }
 }
 
 //-----------------------------------------------------------------------------
 QGCCacheWorker::~QGCCacheWorker()
 {
+    _stopReaders();
+    qDeleteAll(_readers);
+}
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_connectDB()
+{
+    _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+    _db->setDatabaseName(_databasePath);
+    _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+    if(!_db->open()) {
+        return false;
+    }
+    //-- Write ahead logging turns each commit into a sequential append and lets reads proceed during writes.
+    //   Syncing only at checkpoints is safe with WAL. At worst the last few cached tiles are lost on power loss.
+    QSqlQuery query(*_db);
+    if(!query.exec("PRAGMA journal_mode=WAL")) {
+        qWarning() << "Map Cache SQL error (enable WAL):" << query.lastError().text();
+    }
+    query.exec("PRAGMA synchronous=NORMAL");
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_clearPrepared()
+{
+    qDeleteAll(_queryCache);
+    _queryCache.clear();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_disconnectDB()
+{
+    //-- Prepared statements hold on to the connection
+    _clearPrepared();
+    if(_db) {
+        delete _db;
+        _db = NULL;
+        QSqlDatabase::removeDatabase(kSession);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QSqlQuery*
+QGCCacheWorker::_prepared(const QString& sql)
+{
+    QSqlQuery* query = _queryCache.value(sql);
+    if(!query) {
+        query = new QSqlQuery(*_db);
+        if(!query->prepare(sql)) {
+            qWarning() << "Map Cache SQL error (prepare):" << sql << query->lastError().text();
+        }
+        _queryCache[sql] = query;
+    }
+    return query;
 }
 
 //-----------------------------------------------------------------------------
@@ -78,11 +164,18 @@ QGCCacheWorker::quit()
         QHostInfo::abortHostLookup(_hostLookupID);
     }
     _mutex.lock();
+    _quitting = true;
     while(_taskQueue.count()) {
         QGCMapTask* task = _taskQueue.dequeue();
         delete task;
     }
+    while(_readQueue.count()) {
+        QGCMapTask* task = _readQueue.dequeue();
+        delete task;
+    }
+    _pendingSaves.clear();
     _mutex.unlock();
+    _stopReaders();
     if(this->isRunning()) {
         _waitc.wakeAll();
     }
@@ -98,7 +191,19 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
         task->deleteLater();
         return false;
     }
+    task->setQueued();
     _mutex.lock();
+    //-- Tile fetches don't wait behind writes, unless the tile is one of the writes
+    if(task->type() == QGCMapTask::taskFetchTile && !_pendingSaves.contains(static_cast<QGCFetchTileTask*>(task)->hash())) {
+        _readQueue.enqueue(task);
+        _startReaders();
+        _readWaitc.wakeOne();
+        _mutex.unlock();
+        return true;
+    }
+    if(task->type() == QGCMapTask::taskCacheTile) {
+        _pendingSaves[static_cast<QGCSaveTileTask*>(task)->tile()->hash()]++;
+    }
     _taskQueue.enqueue(task);
     _mutex.unlock();
     if(this->isRunning()) {
@@ -117,10 +222,7 @@ QGCCacheWorker::run()
         _init();
     }
     if(_valid) {
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-        _db->setDatabaseName(_databasePath);
-        _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        _valid = _db->open();
+        _valid = _connectDB();
     }
     while(true) {
         QGCMapTask* task;
@@ -132,7 +234,7 @@ QGCCacheWorker::run()
                 case QGCMapTask::taskInit:
                     break;
                 case QGCMapTask::taskCacheTile:
-                    _saveTile(task);
+                    _writeBatch(task);
                     break;
                 case QGCMapTask::taskFetchTile:
                     _getTile(task);
@@ -147,7 +249,7 @@ QGCCacheWorker::run()
                     _getTileDownloadList(task);
                     break;
                 case QGCMapTask::taskUpdateTileDownloadState:
-                    _updateTileDownloadState(task);
+                    _writeBatch(task);
                     break;
                 case QGCMapTask::taskDeleteTileSet:
                     _deleteTileSet(task);
@@ -171,6 +273,7 @@ QGCCacheWorker::run()
                     _testInternet();
                     break;
             }
+            _taskDone(task);
             task->deleteLater();
             //-- Check for update timeout
             size_t count = _taskQueue.count();
@@ -202,25 +305,203 @@ QGCCacheWorker::run()
             _waitmutex.unlock();
         }
     }
+    _disconnectDB();
+}
+//-----------------------------------------------------------------------------
+QGCCacheWorker::Stats_t
+QGCCacheWorker::stats()
+{
+    QMutexLocker lock(&_mutex);
+    Stats_t stats;
+    stats.readQueueDepth        = _readQueue.count();
+    stats.writeQueueDepth       = _taskQueue.count();
+    stats.reads                 = _reads;
+    stats.writes                = _writes;
+    stats.readLatencyAvgMSecs   = _reads  ? _readLatencyTotal  / (qint64)_reads  : 0;
+    stats.readLatencyMaxMSecs   = _readLatencyMax;
+    stats.writeLatencyAvgMSecs  = _writes ? _writeLatencyTotal / (qint64)_writes : 0;
+    stats.writeLatencyMaxMSecs  = _writeLatencyMax;
+    return stats;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_taskDone(QGCMapTask* task)
+{
+    qint64 latency = task->queuedMSecs();
+    QMutexLocker lock(&_mutex);
+    if(task->type() == QGCMapTask::taskFetchTile) {
+        _reads++;
+        _readLatencyTotal += latency;
+        _readLatencyMax = qMax(_readLatencyMax, latency);
+    } else {
+        _writes++;
+        _writeLatencyTotal += latency;
+        _writeLatencyMax = qMax(_writeLatencyMax, latency);
+    }
+    if(task->type() == QGCMapTask::taskCacheTile) {
+        QHash<QString, int>::iterator it = _pendingSaves.find(static_cast<QGCSaveTileTask*>(task)->tile()->hash());
+        if(it != _pendingSaves.end() && --it.value() <= 0) {
+            _pendingSaves.erase(it);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-- Called with _mutex locked
+void
+QGCCacheWorker::_startReaders()
+{
+    if(_readersStarted || _readersStop || _quitting || _readQueue.isEmpty()) {
+        return;
+    }
+    _readersStarted = true;
+    foreach(QGCCacheReader* reader, _readers) {
+        reader->start(QThread::HighPriority);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-- Waits for the readers to close their connections. Reads stay queued until
+//   _readersStop is cleared and _startReaders is called again.
+void
+QGCCacheWorker::_stopReaders()
+{
+    _mutex.lock();
+    _readersStop = true;
+    _readWaitc.wakeAll();
+    _mutex.unlock();
+    foreach(QGCCacheReader* reader, _readers) {
+        reader->wait();
+    }
+    _mutex.lock();
+    _readersStarted = false;
+    _mutex.unlock();
+}
+
+//-----------------------------------------------------------------------------
+//-- Blocks the calling reader until a fetch is queued. Returns NULL when the readers must stop.
+QGCMapTask*
+QGCCacheWorker::_nextRead()
+{
+    QMutexLocker lock(&_mutex);
+    while(!_readersStop && _readQueue.isEmpty()) {
+        _readWaitc.wait(&_mutex);
+    }
+    if(_readersStop) {
+        return NULL;
+    }
+    return _readQueue.dequeue();
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheReader::QGCCacheReader(QGCCacheWorker* worker, int index)
+    : _worker(worker)
+    , _session(QString("%1Reader%2").arg(kSession).arg(index))
+    , _db(NULL)
+    , _query(NULL)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheReader::_connectDB()
+{
+    _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
+    _db->setDatabaseName(_worker->_databasePath);
+    //-- Not in the shared cache with the writer, shared cache connections lock whole tables.
+    //   With WAL a separate connection reads the last commit while the writer appends.
+    if(!_db->open()) {
+        qWarning() << "Map Cache SQL error (open reader db):" << _db->lastError();
+        _disconnectDB();
+        return false;
+    }
+    QSqlQuery query(*_db);
+    query.exec("PRAGMA query_only=1");
+    _query = new QSqlQuery(*_db);
+    if(!_query->prepare("SELECT tile, format, type FROM Tiles WHERE hash = ?")) {
+        qWarning() << "Map Cache SQL error (prepare reader):" << _query->lastError().text();
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheReader::_disconnectDB()
+{
+    delete _query;
+    _query = NULL;
     if(_db) {
         delete _db;
         _db = NULL;
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     }
 }
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheReader::run()
+{
+    while(true) {
+        QGCMapTask* task = _worker->_nextRead();
+        if(!task) {
+            break;
+        }
+        if(!_db && _worker->_valid) {
+            _connectDB();
+        }
+        _getTile(task);
+        _worker->_taskDone(task);
+        task->deleteLater();
+    }
+    _disconnectDB();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheReader::_getTile(QGCMapTask* mtask)
+{
+    if(!_db || !_worker->_valid) {
+        mtask->setError("No Cache Database");
+        return;
+    }
+    bool found = false;
+    QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
+    _query->bindValue(0, task->hash());
+    if(_query->exec()) {
+        if(_query->next()) {
+            QByteArray ar   = _query->value(0).toByteArray();
+            QString format  = _query->value(1).toString();
+            UrlFactory::MapType type = (UrlFactory::MapType)_query->value(2).toInt();
+            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
+            QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
+            task->setTileFetched(tile);
+            found = true;
+        }
+    }
+    _query->finish();
+    if(!found) {
+        qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
+        task->setError("Tile not in cache database");
+    }
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::_findTileSetID(const QString name, quint64& setID)
 {
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT setID FROM TileSets WHERE name = \"%1\"").arg(name);
-    if(query.exec(s)) {
-        if(query.next()) {
-            setID = query.value(0).toULongLong();
-            return true;
+    bool found = false;
+    QSqlQuery* query = _prepared("SELECT setID FROM TileSets WHERE name = ?");
+    query->bindValue(0, name);
+    if(query->exec()) {
+        if(query->next()) {
+            setID = query->value(0).toULongLong();
+            found = true;
         }
     }
-    return false;
+    query->finish();
+    return found;
 }
 
 //-----------------------------------------------------------------------------
@@ -240,28 +521,134 @@ QGCCacheWorker::_getDefaultTileSet()
     return 1L;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_writeBatch(QGCMapTask* mtask)
+{
+    //-- Run this tile write along with any other tile writes queued right behind it in a single transaction
+    QList<QGCMapTask*> batch;
+    bool transaction = _valid && _db->transaction();
+    QGCMapTask* task = mtask;
+    while(task) {
+        if(task->type() == QGCMapTask::taskCacheTile) {
+            _saveTile(task);
+        } else {
+            _updateTileDownloadState(task);
+        }
+        task = NULL;
+        if(batch.count() + 1 < MAX_WRITE_BATCH) {
+            _mutex.lock();
+            if(_taskQueue.count() && (_taskQueue.head()->type() == QGCMapTask::taskCacheTile || _taskQueue.head()->type() == QGCMapTask::taskUpdateTileDownloadState)) {
+                task = _taskQueue.dequeue();
+                batch.append(task);
+            }
+            _mutex.unlock();
+        }
+    }
+    //-- A batch that fails to commit is dropped as a whole. Its tiles keep their download state, so a resumed
+    //   tile set download fetches them again.
+    if(transaction && !_db->commit()) {
+        qWarning() << "Map Cache SQL error (commit tile writes):" << _db->lastError().text();
+        _db->rollback();
+    }
+    //-- Only done once committed, so a fetch for one of these tiles can be served by a reader
+    foreach(QGCMapTask* done, batch) {
+        _taskDone(done);
+        done->deleteLater();
+    }
+    qCDebug(QGCTileCacheLog) << "_writeBatch() Tasks:" << batch.count() + 1;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_addTileToSet(quint64 tileID, quint64 setID, quint64 size)
+{
+    //-- Find which sets already hold this tile so the unique tile totals can be kept up to date
+    QList<quint64> sets;
+    QSqlQuery* query = _prepared("SELECT setID FROM SetTiles WHERE tileID = ?");
+    query->bindValue(0, tileID);
+    if(query->exec()) {
+        while(query->next()) {
+            sets << query->value(0).toULongLong();
+        }
+    }
+    query->finish();
+    if(sets.contains(setID)) {
+        return true;
+    }
+    query = _prepared("INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)");
+    query->bindValue(0, tileID);
+    query->bindValue(1, setID);
+    if(!query->exec()) {
+        qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query->lastError().text();
+        return false;
+    }
+    if(sets.isEmpty()) {
+        _addToTotals(setID, 1, size, 1, size);
+    } else {
+        _addToTotals(setID, 1, size, 0, 0);
+        //-- The tile is no longer unique to the one set that had it
+        if(sets.count() == 1) {
+            _addToTotals(sets[0], 0, 0, -1, -(qint64)size);
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_addToTotals(quint64 setID, qint64 count, qint64 size, qint64 uniqueCount, qint64 uniqueSize)
+{
+    QSqlQuery* query = _prepared("UPDATE TileTotals SET tileCount = tileCount + ?, tileSize = tileSize + ?, uniqueCount = uniqueCount + ?, uniqueSize = uniqueSize + ? WHERE setID = ?");
+    query->bindValue(0, count);
+    query->bindValue(1, size);
+    query->bindValue(2, uniqueCount);
+    query->bindValue(3, uniqueSize);
+    query->bindValue(4, setID);
+    if(!query->exec()) {
+        qWarning() << "Map Cache SQL error (update TileTotals):" << query->lastError().text();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_getTotals(quint64 setID, quint64& count, quint64& size, quint64& uniqueCount, quint64& uniqueSize)
+{
+    bool found = false;
+    QSqlQuery* query = _prepared("SELECT tileCount, tileSize, uniqueCount, uniqueSize FROM TileTotals WHERE setID = ?");
+    query->bindValue(0, setID);
+    if(query->exec()) {
+        if(query->next()) {
+            count       = query->value(0).toULongLong();
+            size        = query->value(1).toULongLong();
+            uniqueCount = query->value(2).toULongLong();
+            uniqueSize  = query->value(3).toULongLong();
+            found = true;
+        }
+    }
+    query->finish();
+    return found;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
-        query.addBindValue(task->tile()->format());
-        query.addBindValue(task->tile()->img());
-        query.addBindValue(task->tile()->img().size());
-        query.addBindValue(task->tile()->type());
-        query.addBindValue(QDateTime::currentDateTime().toTime_t());
-        if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
+        QSqlQuery* query = _prepared("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+        query->bindValue(0, task->tile()->hash());
+        query->bindValue(1, task->tile()->format());
+        query->bindValue(2, task->tile()->img());
+        query->bindValue(3, task->tile()->img().size());
+        query->bindValue(4, task->tile()->type());
+        query->bindValue(5, QDateTime::currentDateTime().toTime_t());
+        if(query->exec()) {
+            quint64 tileID = query->lastInsertId().toULongLong();
             quint64 setID = task->tile()->set() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->set();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-            }
+            quint64 size = task->tile()->img().size();
+            _addToTotals(kAllTilesSetID, 1, size, 0, 0);
+            _addTileToSet(tileID, setID, size);
             qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
         } else {
             //-- Tile was already there.
@@ -281,19 +668,20 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     }
     bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
-    if(query.exec(s)) {
-        if(query.next()) {
-            QByteArray ar   = query.value(0).toByteArray();
-            QString format  = query.value(1).toString();
-            UrlFactory::MapType type = (UrlFactory::MapType)query.value(2).toInt();
+    QSqlQuery* query = _prepared("SELECT tile, format, type FROM Tiles WHERE hash = ?");
+    query->bindValue(0, task->hash());
+    if(query->exec()) {
+        if(query->next()) {
+            QByteArray ar   = query->value(0).toByteArray();
+            QString format  = query->value(1).toString();
+            UrlFactory::MapType type = (UrlFactory::MapType)query->value(2).toInt();
             qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
             QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
             task->setTileFetched(tile);
             found = true;
         }
     }
+    query->finish();
     if(!found) {
         qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
         task->setError("Tile not in cache database");
@@ -349,87 +737,74 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
         set->setTotalTileSize(_defaultSize);
         return;
     }
-    QSqlQuery subquery(*_db);
-    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
-    qCDebug(QGCTileCacheLog) << "_updateSetTotals(): " << sq;
-    if(subquery.exec(sq)) {
-        if(subquery.next()) {
-            set->setSavedTileCount(subquery.value(0).toUInt());
-            set->setSavedTileSize(subquery.value(1).toULongLong());
-            qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
-            //-- Update (estimated) size
-            quint64 avg = UrlFactory::averageSizeForType(set->type());
-            if(set->totalTileCount() <= set->savedTileCount()) {
-                //-- We're done so the saved size is the total size
-                set->setTotalTileSize(set->savedTileSize());
-            } else {
-                //-- Otherwise we need to estimate it.
-                if(set->savedTileCount() > 10 && set->savedTileSize()) {
-                    avg = set->savedTileSize() / set->savedTileCount();
-                }
-                set->setTotalTileSize(avg * set->totalTileCount());
-            }
-            //-- Now figure out the count for tiles unique to this set
-            quint32 ucount = 0;
-            quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
-            if(subquery.exec(sq)) {
-                if(subquery.next()) {
-                    //-- This is only accurate when all tiles are downloaded
-                    ucount = subquery.value(0).toUInt();
-                    usize  = subquery.value(1).toULongLong();
-                }
-            }
-            //-- If we haven't downloaded it all, estimate size of unique tiles
-            quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
-            if(!ucount) {
-                usize = expectedUcount * avg;
-            } else {
-                expectedUcount = ucount;
-            }
-            set->setUniqueTileCount(expectedUcount);
-            set->setUniqueTileSize(usize);
+    quint64 count   = 0;
+    quint64 size    = 0;
+    quint64 ucount  = 0;
+    quint64 usize   = 0;
+    if(!_getTotals(set->id(), count, size, ucount, usize)) {
+        return;
+    }
+    set->setSavedTileCount((quint32)count);
+    set->setSavedTileSize(size);
+    qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
+    //-- Update (estimated) size
+    quint64 avg = UrlFactory::averageSizeForType(set->type());
+    if(set->totalTileCount() <= set->savedTileCount()) {
+        //-- We're done so the saved size is the total size
+        set->setTotalTileSize(set->savedTileSize());
+    } else {
+        //-- Otherwise we need to estimate it.
+        if(set->savedTileCount() > 10 && set->savedTileSize()) {
+            avg = set->savedTileSize() / set->savedTileCount();
         }
+        set->setTotalTileSize(avg * set->totalTileCount());
+    }
+    //-- If we haven't downloaded it all, estimate size of unique tiles
+    quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
+    if(!ucount) {
+        usize = expectedUcount * avg;
+    } else {
+        expectedUcount = (quint32)ucount;
     }
+    set->setUniqueTileCount(expectedUcount);
+    set->setUniqueTileSize(usize);
 }
 
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_updateTotals()
 {
-    QSqlQuery query(*_db);
-    QString s;
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _totalCount = query.value(0).toUInt();
-            _totalSize  = query.value(1).toULongLong();
-        }
+    quint64 count   = 0;
+    quint64 size    = 0;
+    quint64 ucount  = 0;
+    quint64 usize   = 0;
+    if(_getTotals(kAllTilesSetID, count, size, ucount, usize)) {
+        _totalCount = (quint32)count;
+        _totalSize  = size;
     }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _defaultCount = query.value(0).toUInt();
-            _defaultSize  = query.value(1).toULongLong();
-        }
+    if(_getTotals(_getDefaultTileSet(), count, size, ucount, usize)) {
+        _defaultCount = (quint32)ucount;
+        _defaultSize  = usize;
     }
     emit updateTotals(_totalCount, _totalSize, _defaultCount, _defaultSize);
     _lastUpdate = time(0);
 }
 
 //-----------------------------------------------------------------------------
-quint64 QGCCacheWorker::_findTile(const QString hash)
+quint64 QGCCacheWorker::_findTile(const QString hash, quint64* size)
 {
     quint64 tileID = 0;
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
-    if(query.exec(s)) {
-        if(query.next()) {
-            tileID = query.value(0).toULongLong();
+    QSqlQuery* query = _prepared("SELECT tileID, size FROM Tiles WHERE hash = ?");
+    query->bindValue(0, hash);
+    if(query->exec()) {
+        if(query->next()) {
+            tileID = query->value(0).toULongLong();
+            if(size) {
+                *size = query->value(1).toULongLong();
+            }
         }
     }
+    query->finish();
     return tileID;
 }
 
@@ -462,8 +837,14 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
             //-- Get just created (auto-incremented) setID
             quint64 setID = query.lastInsertId().toULongLong();
             task->tileSet()->setId(setID);
+            QSqlQuery* totalsQuery = _prepared("INSERT OR IGNORE INTO TileTotals(setID) VALUES(?)");
+            totalsQuery->bindValue(0, setID);
+            if(!totalsQuery->exec()) {
+                qWarning() << "Map Cache SQL error (add tileSet into TileTotals):" << totalsQuery->lastError().text();
+            }
             //-- Prepare Download List
             quint64 tileCount = 0;
+            QSqlQuery* downloadQuery = _prepared("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ?, ?, ?)");
             _db->transaction();
             for(int z = task->tileSet()->minZoom(); z <= task->tileSet()->maxZoom(); z++) {
                 QGCTileSet set = QGCMapEngine::getTileCount(z,
@@ -475,36 +856,34 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                     for(int y = set.tileY0; y <= set.tileY1; y++) {
                         //-- See if tile is already downloaded
                         QString hash = QGCMapEngine::getTileHash(type, x, y, z);
-                        quint64 tileID = _findTile(hash);
+                        quint64 tileSize = 0;
+                        quint64 tileID = _findTile(hash, &tileSize);
                         if(!tileID) {
                             //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
-                            query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(type);
-                            query.addBindValue(x);
-                            query.addBindValue(y);
-                            query.addBindValue(z);
-                            query.addBindValue(0);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
+                            downloadQuery->bindValue(0, setID);
+                            downloadQuery->bindValue(1, hash);
+                            downloadQuery->bindValue(2, type);
+                            downloadQuery->bindValue(3, x);
+                            downloadQuery->bindValue(4, y);
+                            downloadQuery->bindValue(5, z);
+                            downloadQuery->bindValue(6, 0);
+                            if(!downloadQuery->exec()) {
+                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << downloadQuery->lastError().text();
+                                _db->rollback();
                                 mtask->setError("Error creating tile set download list");
                                 return;
                             } else
                                 actual_count++;
                         } else {
                             //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-                            query.prepare(s);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-                            }
+                            _addTileToSet(tileID, setID, tileSize);
                             qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached HASH:" << hash;
                         }
                     }
                 }
             }
             _db->commit();
+            qCDebug(QGCTileCacheLog) << "_createTileSet() Tiles:" << tileCount << "To download:" << actual_count;
             //-- Done
             _updateSetTotals(task->tileSet());
             task->setTileSetSaved();
@@ -535,12 +914,17 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
             tile->setZ(query.value("z").toInt());
             tiles.append(tile);
         }
+        QSqlQuery* stateQuery = _prepared("UPDATE TilesDownload SET state = ? WHERE setID = ? AND hash = ?");
+        _db->transaction();
         for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg((int)QGCTile::StateDownloading).arg(task->setID()).arg(tiles[i]->hash());
-            if(!query.exec(s)) {
-                qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
+            stateQuery->bindValue(0, (int)QGCTile::StateDownloading);
+            stateQuery->bindValue(1, task->setID());
+            stateQuery->bindValue(2, tiles[i]->hash());
+            if(!stateQuery->exec()) {
+                qWarning() << "Map Cache SQL error (set TilesDownload state):" << stateQuery->lastError().text();
             }
         }
+        _db->commit();
     }
     task->setTileListFetched(tiles);
 }
@@ -553,19 +937,25 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
         return;
     }
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
+    QSqlQuery* query;
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
+        query = _prepared("DELETE FROM TilesDownload WHERE setID = ? AND hash = ?");
+        query->bindValue(0, task->setID());
+        query->bindValue(1, task->hash());
     } else {
         if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg((int)task->state()).arg(task->setID());
+            query = _prepared("UPDATE TilesDownload SET state = ? WHERE setID = ?");
+            query->bindValue(0, (int)task->state());
+            query->bindValue(1, task->setID());
         } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg((int)task->state()).arg(task->setID()).arg(task->hash());
+            query = _prepared("UPDATE TilesDownload SET state = ? WHERE setID = ? AND hash = ?");
+            query->bindValue(0, (int)task->state());
+            query->bindValue(1, task->setID());
+            query->bindValue(2, task->hash());
         }
     }
-    if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+    if(!query->exec()) {
+        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query->lastError().text();
     }
 }
 
@@ -577,24 +967,40 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
         return;
     }
     QGCPruneCacheTask* task = static_cast<QGCPruneCacheTask*>(mtask);
+    quint64 defaultSet = _getDefaultTileSet();
     QSqlQuery query(*_db);
-    QString s;
     //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
+    query.prepare("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = ? GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128");
+    query.addBindValue(defaultSet);
     qint64 amount = (qint64)task->amount();
     QList<quint64> tlist;
-    if(query.exec(s)) {
+    QList<quint64> slist;
+    if(query.exec()) {
         while(query.next() && amount >= 0) {
             tlist << query.value(0).toULongLong();
+            slist << query.value(1).toULongLong();
             amount -= query.value(1).toULongLong();
             qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << query.value(2).toString();
         }
-        while(tlist.count()) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
-            tlist.removeFirst();
-            if(!query.exec(s))
+        query.finish();
+        qint64 prunedCount = 0;
+        qint64 prunedSize  = 0;
+        QSqlQuery* deleteTile = _prepared("DELETE FROM Tiles WHERE tileID = ?");
+        QSqlQuery* deleteSetTile = _prepared("DELETE FROM SetTiles WHERE tileID = ?");
+        _db->transaction();
+        for(int i = 0; i < tlist.count(); i++) {
+            deleteTile->bindValue(0, tlist[i]);
+            if(!deleteTile->exec())
                 break;
+            deleteSetTile->bindValue(0, tlist[i]);
+            deleteSetTile->exec();
+            prunedCount++;
+            prunedSize += slist[i];
         }
+        //-- Pruned tiles were only in the default set
+        _addToTotals(defaultSet, -prunedCount, -prunedSize, -prunedCount, -prunedSize);
+        _addToTotals(kAllTilesSetID, -prunedCount, -prunedSize, 0, 0);
+        _db->commit();
         task->setPruned();
     }
 }
@@ -607,17 +1013,53 @@ QGCCacheWorker::_deleteTileSet(QGCMapTask* mtask)
         return;
     }
     QGCDeleteTileSetTask* task = static_cast<QGCDeleteTileSetTask*>(mtask);
+    quint64 setID = task->setID();
+    _db->transaction();
+    //-- Tiles shared with exactly one other set become unique to that set
     QSqlQuery query(*_db);
-    QString s;
-    //-- Only delete tiles unique to this set
-    s = QString("DELETE FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(task->setID());
-    query.exec(s);
-    s = QString("DELETE FROM TilesDownload WHERE setID = %1").arg(task->setID());
-    query.exec(s);
-    s = QString("DELETE FROM TileSets WHERE setID = %1").arg(task->setID());
-    query.exec(s);
-    s = QString("DELETE FROM SetTiles WHERE setID = %1").arg(task->setID());
-    query.exec(s);
+    query.prepare("SELECT B.setID, COUNT(T.size), SUM(T.size) FROM SetTiles A "
+        "JOIN SetTiles B ON B.tileID = A.tileID AND B.setID != A.setID "
+        "JOIN Tiles T ON T.tileID = A.tileID "
+        "WHERE A.setID = ? AND (SELECT COUNT(C.setID) FROM SetTiles C WHERE C.tileID = A.tileID) = 2 "
+        "GROUP BY B.setID");
+    query.addBindValue(setID);
+    if(query.exec()) {
+        QList<quint64>  sets;
+        QList<qint64>   counts;
+        QList<qint64>   sizes;
+        while(query.next()) {
+            sets   << query.value(0).toULongLong();
+            counts << query.value(1).toLongLong();
+            sizes  << query.value(2).toLongLong();
+        }
+        for(int i = 0; i < sets.count(); i++) {
+            _addToTotals(sets[i], 0, 0, counts[i], sizes[i]);
+        }
+    }
+    //-- Only tiles unique to this set are deleted
+    quint64 count   = 0;
+    quint64 size    = 0;
+    quint64 ucount  = 0;
+    quint64 usize   = 0;
+    if(_getTotals(setID, count, size, ucount, usize)) {
+        _addToTotals(kAllTilesSetID, -(qint64)ucount, -(qint64)usize, 0, 0);
+    }
+    query.prepare("DELETE FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = ? GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)");
+    query.addBindValue(setID);
+    query.exec();
+    query.prepare("DELETE FROM TilesDownload WHERE setID = ?");
+    query.addBindValue(setID);
+    query.exec();
+    query.prepare("DELETE FROM TileSets WHERE setID = ?");
+    query.addBindValue(setID);
+    query.exec();
+    query.prepare("DELETE FROM SetTiles WHERE setID = ?");
+    query.addBindValue(setID);
+    query.exec();
+    query.prepare("DELETE FROM TileTotals WHERE setID = ?");
+    query.addBindValue(setID);
+    query.exec();
+    _db->commit();
     _updateTotals();
     task->setTileSetDeleted();
 }
@@ -630,10 +1072,10 @@ QGCCacheWorker::_renameTileSet(QGCMapTask* mtask)
         return;
     }
     QGCRenameTileSetTask* task = static_cast<QGCRenameTileSetTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s;
-    s = QString("UPDATE TileSets SET name = \"%1\" WHERE setID = %2").arg(task->newName()).arg(task->setID());
-    if(!query.exec(s)) {
+    QSqlQuery* query = _prepared("UPDATE TileSets SET name = ? WHERE setID = ?");
+    query->bindValue(0, task->newName());
+    query->bindValue(1, task->setID());
+    if(!query->exec()) {
         task->setError("Error renaming tile set");
     }
 }
@@ -646,6 +1088,10 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    //-- Readers can't keep using the tables while they are dropped
+    _stopReaders();
+    //-- Statements prepared against the old tables can't be kept around while they are dropped
+    _clearPrepared();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -656,7 +1102,15 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     query.exec(s);
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
+    s = QString("DROP TABLE TileTotals");
+    query.exec(s);
+    s = QString("DROP TABLE IF EXISTS ImportProgress");
+    query.exec(s);
     _valid = _createDB(_db);
+    _mutex.lock();
+    _readersStop = false;
+    _startReaders();
+    _mutex.unlock();
     task->setResetCompleted();
 }
 
@@ -670,12 +1124,9 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
     QGCImportTileTask* task = static_cast<QGCImportTileTask*>(mtask);
     //-- If replacing, simply copy over it
     if(task->replace()) {
-        //-- Close and delete old database
-        if(_db) {
-            delete _db;
-            _db = NULL;
-            QSqlDatabase::removeDatabase(kSession);
-        }
+        //-- Close and delete old database. The readers must let go of it as well.
+        _stopReaders();
+        _disconnectDB();
         QFile file(_databasePath);
         file.remove();
         //-- Copy given database
@@ -684,24 +1135,37 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         _init();
         if(_valid) {
             task->setProgress(50);
-            _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-            _db->setDatabaseName(_databasePath);
-            _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            _valid = _db->open();
+            _valid = _connectDB();
         }
+        _mutex.lock();
+        _readersStop = false;
+        _startReaders();
+        _mutex.unlock();
         task->setProgress(100);
     } else {
-        //-- Open imported set
-        QSqlDatabase* dbImport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-        dbImport->setDatabaseName(task->path());
-        dbImport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (dbImport->open()) {
-            QSqlQuery query(*dbImport);
+        //-- The imported database is attached to the cache so tiles are copied with set based statements, one chunk
+        //   of tiles per transaction. How far each set got is kept in the cache, importing the same file again after
+        //   an interruption continues where it stopped instead of adding its sets a second time.
+        QString source = QFileInfo(task->path()).canonicalFilePath();
+        if(source.isEmpty() || !_attachDB(source, kImportSchema)) {
+            task->setError("Error opening import database");
+        } else {
+            QSqlQuery query(*_db);
+            if(!query.exec("CREATE TABLE IF NOT EXISTS ImportProgress ("
+                "source TEXT NOT NULL, "
+                "name TEXT NOT NULL, "
+                "setID INTEGER, "
+                "lastTileID INTEGER DEFAULT 0, "
+                "PRIMARY KEY(source, name))"))
+            {
+                qWarning() << "Map Cache SQL error (create ImportProgress db):" << query.lastError().text();
+            }
             //-- Prepare progress report
             quint64 tileCount = 0;
             quint64 currentCount = 0;
-            QString s;
-            s = QString("SELECT COUNT(tileID) FROM Tiles");
+            quint64 copiedCount = 0;
+            bool ok = true;
+            QString s = QString("SELECT COUNT(tileID) FROM %1.SetTiles").arg(kImportSchema);
             if(query.exec(s)) {
                 if(query.next()) {
                     tileCount  = query.value(0).toULongLong();
@@ -711,109 +1175,158 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                 qWarning() << "No tiles found in imported database";
                 tileCount = 1; //-- Let it run through
             }
+            QElapsedTimer elapsed;
+            elapsed.start();
             //-- Iterate Tile Sets
-            s = QString("SELECT * FROM TileSets ORDER BY defaultSet DESC, name ASC");
-            if(query.exec(s)) {
-                while(query.next()) {
-                    QString name            = query.value("name").toString();
-                    quint64 setID           = query.value("setID").toULongLong();
-                    QString mapType         = query.value("typeStr").toString();
-                    double  topleftLat      = query.value("topleftLat").toDouble();
-                    double  topleftLon      = query.value("topleftLon").toDouble();
-                    double  bottomRightLat  = query.value("bottomRightLat").toDouble();
-                    double  bottomRightLon  = query.value("bottomRightLon").toDouble();
-                    int     minZoom         = query.value("minZoom").toInt();
-                    int     maxZoom         = query.value("maxZoom").toInt();
-                    int     type            = query.value("type").toInt();
-                    quint32 numTiles        = query.value("numTiles").toUInt();
-                    int     defaultSet      = query.value("defaultSet").toInt();
-                    quint64 insertSetID     = _getDefaultTileSet();
-                    //-- If not default set, create new one
-                    if(!defaultSet) {
-                        //-- Check if we have this tile set already
-                        int testCount = 0;
-                        while (true) {
-                            QString testName;
-                            testName.sprintf("%s %03d", name.toLatin1().data(), ++testCount);
-                            if(!_findTileSetID(testName, insertSetID) || testCount > 99) {
-                                if(testCount > 1) {
-                                    name = testName;
+            QSqlQuery setQuery(*_db);
+            s = QString("SELECT * FROM %1.TileSets ORDER BY defaultSet DESC, name ASC").arg(kImportSchema);
+            if(setQuery.exec(s)) {
+                while(ok && setQuery.next()) {
+                    QString importName      = setQuery.value("name").toString();
+                    QString name            = importName;
+                    quint64 setID           = setQuery.value("setID").toULongLong();
+                    QString mapType         = setQuery.value("typeStr").toString();
+                    double  topleftLat      = setQuery.value("topleftLat").toDouble();
+                    double  topleftLon      = setQuery.value("topleftLon").toDouble();
+                    double  bottomRightLat  = setQuery.value("bottomRightLat").toDouble();
+                    double  bottomRightLon  = setQuery.value("bottomRightLon").toDouble();
+                    int     minZoom         = setQuery.value("minZoom").toInt();
+                    int     maxZoom         = setQuery.value("maxZoom").toInt();
+                    int     type            = setQuery.value("type").toInt();
+                    quint32 numTiles        = setQuery.value("numTiles").toUInt();
+                    int     defaultSet      = setQuery.value("defaultSet").toInt();
+                    quint64 insertSetID     = 0;
+                    quint64 lastTileID      = 0;
+                    //-- A set started by an interrupted import continues after the last tile it copied
+                    query.prepare("SELECT setID, lastTileID FROM ImportProgress WHERE source = ? AND name = ?");
+                    query.addBindValue(source);
+                    query.addBindValue(importName);
+                    if(query.exec() && query.next()) {
+                        insertSetID = query.value(0).toULongLong();
+                        lastTileID  = query.value(1).toULongLong();
+                        query.prepare(QString("SELECT COUNT(tileID) FROM %1.SetTiles WHERE setID = ? AND tileID <= ?").arg(kImportSchema));
+                        query.addBindValue(setID);
+                        query.addBindValue(lastTileID);
+                        if(query.exec() && query.next()) {
+                            currentCount += query.value(0).toULongLong();
+                        }
+                        qCDebug(QGCTileCacheLog) << "Resuming import of" << importName << "after tile" << lastTileID;
+                    } else {
+                        _db->transaction();
+                        insertSetID = _getDefaultTileSet();
+                        //-- If not default set, create new one
+                        if(!defaultSet) {
+                            //-- Check if we have this tile set already
+                            int testCount = 0;
+                            while (true) {
+                                QString testName;
+                                testName.sprintf("%s %03d", name.toLatin1().data(), ++testCount);
+                                if(!_findTileSetID(testName, insertSetID) || testCount > 99) {
+                                    if(testCount > 1) {
+                                        name = testName;
+                                    }
+                                    break;
                                 }
-                                break;
                             }
+                            //-- Create new set
+                            query.prepare("INSERT INTO TileSets("
+                                "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+                                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+                            query.addBindValue(name);
+                            query.addBindValue(mapType);
+                            query.addBindValue(topleftLat);
+                            query.addBindValue(topleftLon);
+                            query.addBindValue(bottomRightLat);
+                            query.addBindValue(bottomRightLon);
+                            query.addBindValue(minZoom);
+                            query.addBindValue(maxZoom);
+                            query.addBindValue(type);
+                            query.addBindValue(numTiles);
+                            query.addBindValue(defaultSet);
+                            query.addBindValue(QDateTime::currentDateTime().toTime_t());
+                            if(!query.exec()) {
+                                ok = false;
+                            } else {
+                                //-- Get just created (auto-incremented) setID
+                                insertSetID = query.lastInsertId().toULongLong();
+                                query.prepare("INSERT OR IGNORE INTO TileTotals(setID) VALUES(?)");
+                                query.addBindValue(insertSetID);
+                                ok = query.exec();
+                            }
+                        }
+                        if(ok) {
+                            query.prepare("INSERT INTO ImportProgress(source, name, setID, lastTileID) VALUES(?, ?, ?, 0)");
+                            query.addBindValue(source);
+                            query.addBindValue(importName);
+                            query.addBindValue(insertSetID);
+                            ok = query.exec();
                         }
-                        //-- Create new set
-                        QSqlQuery cQuery(*_db);
-                        cQuery.prepare("INSERT INTO TileSets("
-                            "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                            ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                        cQuery.addBindValue(name);
-                        cQuery.addBindValue(mapType);
-                        cQuery.addBindValue(topleftLat);
-                        cQuery.addBindValue(topleftLon);
-                        cQuery.addBindValue(bottomRightLat);
-                        cQuery.addBindValue(bottomRightLon);
-                        cQuery.addBindValue(minZoom);
-                        cQuery.addBindValue(maxZoom);
-                        cQuery.addBindValue(type);
-                        cQuery.addBindValue(numTiles);
-                        cQuery.addBindValue(defaultSet);
-                        cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                        if(!cQuery.exec()) {
+                        if(!ok) {
+                            qWarning() << "Map Cache SQL error (import tile set):" << query.lastError().text();
+                            _db->rollback();
                             task->setError("Error adding imported tile set to database");
                             break;
-                        } else {
-                            //-- Get just created (auto-incremented) setID
-                            insertSetID = cQuery.lastInsertId().toULongLong();
                         }
+                        _db->commit();
                     }
-                    //-- Find set tiles
-                    QSqlQuery cQuery(*_db);
-                    QSqlQuery subQuery(*dbImport);
-                    QString sb = QString("SELECT * FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
-                    if(subQuery.exec(sb)) {
+                    //-- Copy set tiles
+                    while(true) {
+                        quint64 chunkEnd = lastTileID;
                         _db->transaction();
-                        while(subQuery.next()) {
-                            QString hash    = subQuery.value("hash").toString();
-                            QString format  = subQuery.value("format").toString();
-                            QByteArray img  = subQuery.value("tile").toByteArray();
-                            int type        = subQuery.value("type").toInt();
-                            //-- Save tile
-                            cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                            cQuery.addBindValue(hash);
-                            cQuery.addBindValue(format);
-                            cQuery.addBindValue(img);
-                            cQuery.addBindValue(img.size());
-                            cQuery.addBindValue(type);
-                            cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                            if(cQuery.exec()) {
-                                quint64 importTileID = cQuery.lastInsertId().toULongLong();
-                                QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(importTileID).arg(insertSetID);
-                                cQuery.prepare(s);
-                                cQuery.exec();
-                                currentCount++;
-                                task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
+                        quint64 lastCacheTileID = 0;
+                        if(query.exec("SELECT IFNULL(MAX(tileID), 0) FROM Tiles") && query.next()) {
+                            lastCacheTileID = query.value(0).toULongLong();
+                        }
+                        qint64 count = _copyTileChunk(kImportSchema, "main", setID, insertSetID, lastTileID, chunkEnd);
+                        if(count > 0 && !_addChunkToTotals(insertSetID, lastCacheTileID)) {
+                            count = -1;
+                        }
+                        if(count > 0) {
+                            query.prepare("UPDATE ImportProgress SET lastTileID = ? WHERE source = ? AND name = ?");
+                            query.addBindValue(chunkEnd);
+                            query.addBindValue(source);
+                            query.addBindValue(importName);
+                            if(!query.exec()) {
+                                qWarning() << "Map Cache SQL error (update import progress):" << query.lastError().text();
+                                count = -1;
                             }
                         }
+                        if(count < 0) {
+                            _db->rollback();
+                            task->setError("Error importing tiles");
+                            ok = false;
+                            break;
+                        }
                         _db->commit();
-                        //-- Update tile count
-                        s = QString("SELECT COUNT(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(insertSetID);
-                        if(cQuery.exec(s)) {
-                            if(cQuery.next()) {
-                                quint64 count  = cQuery.value(0).toULongLong();
-                                s = QString("UPDATE TileSets SET numTiles = %1 WHERE setID = %2").arg(count).arg(insertSetID);
-                                cQuery.exec(s);
-                            }
+                        if(!count) {
+                            break;
                         }
+                        lastTileID = chunkEnd;
+                        currentCount += count;
+                        copiedCount  += count;
+                        task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
+                        task->setThroughput(elapsed.elapsed() ? (double)copiedCount * 1000.0 / (double)elapsed.elapsed() : 0.0);
+                    }
+                    //-- Update tile count
+                    query.prepare("UPDATE TileSets SET numTiles = (SELECT COUNT(tileID) FROM SetTiles WHERE setID = ?) WHERE setID = ?");
+                    query.addBindValue(insertSetID);
+                    query.addBindValue(insertSetID);
+                    if(!query.exec()) {
+                        qWarning() << "Map Cache SQL error (update imported tile count):" << query.lastError().text();
                     }
                 }
             } else {
                 task->setError("No tile set in database");
             }
-            delete dbImport;
-            QSqlDatabase::removeDatabase(kExportSession);
-        } else {
-            task->setError("Error opening import database");
+            setQuery.finish();
+            if(ok) {
+                query.prepare("DELETE FROM ImportProgress WHERE source = ?");
+                query.addBindValue(source);
+                query.exec();
+            }
+            query.finish();
+            _detachDB(kImportSchema);
+            qCDebug(QGCTileCacheLog) << "Imported" << copiedCount << "tiles in" << elapsed.elapsed() << "msecs";
         }
     }
     task->setImportCompleted();
@@ -827,105 +1340,334 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
         return;
     }
     QGCExportTileTask* task = static_cast<QGCExportTileTask*>(mtask);
-    //-- Delete target if it exists
-    QFile file(task->path());
-    file.remove();
-    //-- Create exported database
-    QSqlDatabase *dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-    dbExport->setDatabaseName(task->path());
-    dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-    if (dbExport->open()) {
-        if(_createDB(dbExport, false)) {
-            //-- Prepare progress report
-            quint64 tileCount = 0;
-            quint64 currentCount = 0;
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Default set has no unique tiles
-                if(set->defaultSet()) {
-                    tileCount += set->totalTileCount();
-                } else {
-                    tileCount += set->uniqueTileCount();
+    //-- Tiles go to a partial file which is only renamed to the target once complete. A partial file left behind
+    //   by an interrupted export of the same sets to the same path is picked up where it stopped. Set IDs are
+    //   reused once a set is deleted, the creation date tells a new set from the old one.
+    QString partialPath = task->path() + kPartialSuffix;
+    QStringList selection;
+    for(int i = 0; i < task->sets().count(); i++) {
+        selection << QString("%1:%2").arg(task->sets()[i]->id()).arg(task->sets()[i]->creationDate().toTime_t());
+    }
+    if(!_createExportDB(partialPath, selection.join(",")) || !_attachDB(partialPath, kExportSchema)) {
+        task->setError("Error creating export database");
+        task->setExportCompleted();
+        return;
+    }
+    //-- Prepare progress report
+    quint64 tileCount = 0;
+    quint64 currentCount = 0;
+    quint64 copiedCount = 0;
+    bool ok = true;
+    QSqlQuery query(*_db);
+    for(int i = 0; i < task->sets().count(); i++) {
+        query.prepare("SELECT COUNT(tileID) FROM SetTiles WHERE setID = ?");
+        query.addBindValue(task->sets()[i]->id());
+        if(query.exec() && query.next()) {
+            tileCount += query.value(0).toULongLong();
+        }
+    }
+    if(!tileCount) {
+        tileCount = 1;
+    }
+    QElapsedTimer elapsed;
+    elapsed.start();
+    //-- Iterate sets to save
+    for(int i = 0; ok && i < task->sets().count(); i++) {
+        QGCCachedTileSet* set = task->sets()[i];
+        quint64 exportSetID = 0;
+        quint64 lastTileID  = 0;
+        //-- A set started by an interrupted export continues after the last tile it copied
+        query.prepare(QString("SELECT setID, lastTileID FROM %1.ExportProgress WHERE sourceID = ?").arg(kExportSchema));
+        query.addBindValue(set->id());
+        if(query.exec() && query.next()) {
+            exportSetID = query.value(0).toULongLong();
+            lastTileID  = query.value(1).toULongLong();
+            query.prepare("SELECT COUNT(tileID) FROM SetTiles WHERE setID = ? AND tileID <= ?");
+            query.addBindValue(set->id());
+            query.addBindValue(lastTileID);
+            if(query.exec() && query.next()) {
+                currentCount += query.value(0).toULongLong();
+            }
+            qCDebug(QGCTileCacheLog) << "Resuming export of" << set->name() << "after tile" << lastTileID;
+        } else {
+            //-- Create Tile Exported Set
+            _db->transaction();
+            query.prepare(QString("INSERT INTO %1.TileSets("
+                "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(kExportSchema));
+            query.addBindValue(set->name());
+            query.addBindValue(set->mapTypeStr());
+            query.addBindValue(set->topleftLat());
+            query.addBindValue(set->topleftLon());
+            query.addBindValue(set->bottomRightLat());
+            query.addBindValue(set->bottomRightLon());
+            query.addBindValue(set->minZoom());
+            query.addBindValue(set->maxZoom());
+            query.addBindValue(set->type());
+            query.addBindValue(set->totalTileCount());
+            query.addBindValue(set->defaultSet());
+            query.addBindValue(QDateTime::currentDateTime().toTime_t());
+            ok = query.exec();
+            if(ok) {
+                //-- Get just created (auto-incremented) setID
+                exportSetID = query.lastInsertId().toULongLong();
+                query.prepare(QString("INSERT INTO %1.ExportProgress(sourceID, setID, lastTileID) VALUES(?, ?, 0)").arg(kExportSchema));
+                query.addBindValue(set->id());
+                query.addBindValue(exportSetID);
+                ok = query.exec();
+            }
+            if(!ok) {
+                qWarning() << "Map Cache SQL error (export tile set):" << query.lastError().text();
+                _db->rollback();
+                task->setError("Error adding tile set to exported database");
+                break;
+            }
+            _db->commit();
+        }
+        //-- Copy set tiles
+        while(true) {
+            quint64 chunkEnd = lastTileID;
+            _db->transaction();
+            qint64 count = _copyTileChunk("main", kExportSchema, set->id(), exportSetID, lastTileID, chunkEnd);
+            if(count > 0) {
+                query.prepare(QString("UPDATE %1.ExportProgress SET lastTileID = ? WHERE sourceID = ?").arg(kExportSchema));
+                query.addBindValue(chunkEnd);
+                query.addBindValue(set->id());
+                if(!query.exec()) {
+                    qWarning() << "Map Cache SQL error (update export progress):" << query.lastError().text();
+                    count = -1;
                 }
             }
-            if(!tileCount) {
-                tileCount = 1;
+            if(count < 0) {
+                _db->rollback();
+                task->setError("Error exporting tiles");
+                ok = false;
+                break;
             }
-            //-- Iterate sets to save
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Create Tile Exported Set
-                QSqlQuery exportQuery(*dbExport);
-                exportQuery.prepare("INSERT INTO TileSets("
-                    "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                    ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                exportQuery.addBindValue(set->name());
-                exportQuery.addBindValue(set->mapTypeStr());
-                exportQuery.addBindValue(set->topleftLat());
-                exportQuery.addBindValue(set->topleftLon());
-                exportQuery.addBindValue(set->bottomRightLat());
-                exportQuery.addBindValue(set->bottomRightLon());
-                exportQuery.addBindValue(set->minZoom());
-                exportQuery.addBindValue(set->maxZoom());
-                exportQuery.addBindValue(set->type());
-                exportQuery.addBindValue(set->totalTileCount());
-                exportQuery.addBindValue(set->defaultSet());
-                exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                if(!exportQuery.exec()) {
-                    task->setError("Error adding tile set to exported database");
-                    break;
-                } else {
-                    //-- Get just created (auto-incremented) setID
-                    quint64 exportSetID = exportQuery.lastInsertId().toULongLong();
-                    //-- Find set tiles
-                    QString s = QString("SELECT * FROM SetTiles WHERE setID = %1").arg(set->id());
-                    QSqlQuery query(*_db);
-                    if(query.exec(s)) {
-                        dbExport->transaction();
-                        while(query.next()) {
-                            quint64 tileID = query.value("tileID").toULongLong();
-                            //-- Get tile
-                            QString s = QString("SELECT * FROM Tiles WHERE tileID = \"%1\"").arg(tileID);
-                            QSqlQuery subQuery(*_db);
-                            if(subQuery.exec(s)) {
-                                if(subQuery.next()) {
-                                    QString hash    = subQuery.value("hash").toString();
-                                    QString format  = subQuery.value("format").toString();
-                                    QByteArray img  = subQuery.value("tile").toByteArray();
-                                    int type        = subQuery.value("type").toInt();
-                                    //-- Save tile
-                                    exportQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                    exportQuery.addBindValue(hash);
-                                    exportQuery.addBindValue(format);
-                                    exportQuery.addBindValue(img);
-                                    exportQuery.addBindValue(img.size());
-                                    exportQuery.addBindValue(type);
-                                    exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                    if(exportQuery.exec()) {
-                                        quint64 exportTileID = exportQuery.lastInsertId().toULongLong();
-                                        QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(exportTileID).arg(exportSetID);
-                                        exportQuery.prepare(s);
-                                        exportQuery.exec();
-                                        currentCount++;
-                                        task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    dbExport->commit();
+            _db->commit();
+            if(!count) {
+                break;
+            }
+            lastTileID = chunkEnd;
+            currentCount += count;
+            copiedCount  += count;
+            task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
+            task->setThroughput(elapsed.elapsed() ? (double)copiedCount * 1000.0 / (double)elapsed.elapsed() : 0.0);
+        }
+    }
+    if(ok) {
+        //-- Totals are rebuilt by whoever uses the file as their cache. The progress tables go with the partial file.
+        if(!query.exec(QString("DELETE FROM %1.TileTotals").arg(kExportSchema)) ||
+                !query.exec(QString("DROP TABLE %1.ExportProgress").arg(kExportSchema)) ||
+                !query.exec(QString("DROP TABLE %1.ExportSelection").arg(kExportSchema))) {
+            qWarning() << "Map Cache SQL error (finish export):" << query.lastError().text();
+        }
+    }
+    query.finish();
+    _detachDB(kExportSchema);
+    if(ok) {
+        QFile::remove(task->path());
+        if(!QFile::rename(partialPath, task->path())) {
+            task->setError("Error writing exported database");
+        }
+    }
+    qCDebug(QGCTileCacheLog) << "Exported" << copiedCount << "tiles in" << elapsed.elapsed() << "msecs";
+    task->setExportCompleted();
+}
+
+//-----------------------------------------------------------------------------
+//-- Creates the schema of an export file, or checks that an existing one is a partial export of the same selection
+//   which can be resumed
+bool
+QGCCacheWorker::_createExportDB(const QString& path, const QString& selection)
+{
+    bool res = false;
+    QSqlDatabase* dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
+    dbExport->setDatabaseName(path);
+    bool opened = dbExport->open();
+    if(opened && !dbExport->tables().isEmpty()) {
+        bool resume = false;
+        {
+            QSqlQuery query(*dbExport);
+            if(dbExport->tables().contains("ExportProgress") && query.exec("SELECT selection FROM ExportSelection") && query.next()) {
+                resume = query.value(0).toString() == selection;
+            }
+        }
+        if(!resume) {
+            //-- Not something we can continue, start over
+            qCDebug(QGCTileCacheLog) << "Discarding partial export" << path;
+            dbExport->close();
+            QFile::remove(path);
+            opened = dbExport->open();
+        }
+    }
+    if(opened) {
+        if(_createDB(dbExport, false)) {
+            QSqlQuery query(*dbExport);
+            if(!query.exec(
+                "CREATE TABLE IF NOT EXISTS ExportProgress ("
+                "sourceID INTEGER PRIMARY KEY NOT NULL, "
+                "setID INTEGER, "
+                "lastTileID INTEGER DEFAULT 0)"))
+            {
+                qWarning() << "Map Cache SQL error (create ExportProgress db):" << query.lastError().text();
+            } else if(!query.exec("CREATE TABLE IF NOT EXISTS ExportSelection (selection TEXT NOT NULL)")) {
+                qWarning() << "Map Cache SQL error (create ExportSelection db):" << query.lastError().text();
+            } else if(query.exec("SELECT selection FROM ExportSelection") && query.next()) {
+                res = true;
+            } else {
+                query.prepare("INSERT INTO ExportSelection(selection) VALUES(?)");
+                query.addBindValue(selection);
+                res = query.exec();
+                if(!res) {
+                    qWarning() << "Map Cache SQL error (create ExportSelection db):" << query.lastError().text();
                 }
             }
-        } else {
-            task->setError("Error creating export database");
+        }
+        dbExport->close();
+        if(!res) {
+            QFile::remove(path);
         }
     } else {
         qCritical() << "Map Cache SQL error (create export database):" << dbExport->lastError();
-        task->setError("Error opening export database");
     }
     delete dbExport;
     QSqlDatabase::removeDatabase(kExportSession);
-    task->setExportCompleted();
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_attachDB(const QString& path, const QString& schema)
+{
+    QSqlQuery query(*_db);
+    query.prepare(QString("ATTACH DATABASE ? AS %1").arg(schema));
+    query.addBindValue(path);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (attach database):" << path << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_detachDB(const QString& schema)
+{
+    QSqlQuery query(*_db);
+    if(!query.exec(QString("DETACH DATABASE %1").arg(schema))) {
+        qWarning() << "Map Cache SQL error (detach database):" << query.lastError().text();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-- Copies the next chunk of a set's tiles, in tile ID order, between two databases attached to the cache connection.
+//   Tiles the target already has (same hash) are shared rather than copied again. Returns the number of tiles in the
+//   chunk (0 once the set is done) or -1 on error. The caller owns the transaction.
+qint64
+QGCCacheWorker::_copyTileChunk(const QString& from, const QString& to, quint64 fromSetID, quint64 toSetID, quint64 lastTileID, quint64& chunkEnd)
+{
+    QSqlQuery query(*_db);
+    query.prepare(QString("SELECT MAX(tileID), COUNT(tileID) FROM (SELECT tileID FROM %1.SetTiles WHERE setID = ? AND tileID > ? ORDER BY tileID LIMIT ?)").arg(from));
+    query.addBindValue(fromSetID);
+    query.addBindValue(lastTileID);
+    query.addBindValue(BULK_CHUNK_SIZE);
+    if(!query.exec() || !query.next()) {
+        qWarning() << "Map Cache SQL error (bulk copy chunk):" << query.lastError().text();
+        return -1;
+    }
+    qint64 count = query.value(1).toLongLong();
+    if(!count) {
+        return 0;
+    }
+    chunkEnd = query.value(0).toULongLong();
+    query.finish();
+    query.prepare(QString(
+        "INSERT OR IGNORE INTO %2.Tiles(hash, format, tile, size, type, date) "
+        "SELECT T.hash, T.format, T.tile, T.size, T.type, ? FROM %1.SetTiles S JOIN %1.Tiles T ON T.tileID = S.tileID "
+        "WHERE S.setID = ? AND S.tileID > ? AND S.tileID <= ?").arg(from, to));
+    query.addBindValue(QDateTime::currentDateTime().toTime_t());
+    query.addBindValue(fromSetID);
+    query.addBindValue(lastTileID);
+    query.addBindValue(chunkEnd);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (bulk copy tiles):" << query.lastError().text();
+        return -1;
+    }
+    //-- The target tiles newly added to the set are kept in ChunkTiles until the next chunk, for the running totals
+    if(!query.exec("CREATE TEMP TABLE IF NOT EXISTS ChunkTiles (tileID INTEGER PRIMARY KEY NOT NULL, size INTEGER)") ||
+            !query.exec("DELETE FROM temp.ChunkTiles")) {
+        qWarning() << "Map Cache SQL error (bulk copy chunk tiles):" << query.lastError().text();
+        return -1;
+    }
+    query.prepare(QString(
+        "INSERT OR IGNORE INTO temp.ChunkTiles(tileID, size) "
+        "SELECT D.tileID, D.size FROM %1.SetTiles S JOIN %1.Tiles T ON T.tileID = S.tileID JOIN %2.Tiles D ON D.hash = T.hash "
+        "WHERE S.setID = ? AND S.tileID > ? AND S.tileID <= ? "
+        "AND NOT EXISTS (SELECT 1 FROM %2.SetTiles X WHERE X.setID = ? AND X.tileID = D.tileID)").arg(from, to));
+    query.addBindValue(fromSetID);
+    query.addBindValue(lastTileID);
+    query.addBindValue(chunkEnd);
+    query.addBindValue(toSetID);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (bulk copy chunk tiles):" << query.lastError().text();
+        return -1;
+    }
+    query.prepare(QString("INSERT INTO %1.SetTiles(tileID, setID) SELECT tileID, ? FROM temp.ChunkTiles").arg(to));
+    query.addBindValue(toSetID);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (bulk copy set tiles):" << query.lastError().text();
+        return -1;
+    }
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//-- Adds a chunk copied into the cache by _copyTileChunk to the running totals. Tiles with an ID above lastTileID are
+//   new to the cache. A tile which now belongs to the set and one other set is no longer unique to that other set.
+bool
+QGCCacheWorker::_addChunkToTotals(quint64 setID, quint64 lastTileID)
+{
+    QSqlQuery query(*_db);
+    query.prepare(
+        "UPDATE TileTotals SET "
+        "tileCount = tileCount + (SELECT COUNT(size) FROM Tiles WHERE tileID > ?), "
+        "tileSize = tileSize + (SELECT IFNULL(SUM(size), 0) FROM Tiles WHERE tileID > ?) "
+        "WHERE setID = ?");
+    query.addBindValue(lastTileID);
+    query.addBindValue(lastTileID);
+    query.addBindValue(kAllTilesSetID);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (add chunk to all tile totals):" << query.lastError().text();
+        return false;
+    }
+    query.prepare(
+        "UPDATE TileTotals SET "
+        "uniqueCount = uniqueCount - (SELECT COUNT(C.size) FROM temp.ChunkTiles C JOIN SetTiles X ON X.tileID = C.tileID "
+            "WHERE X.setID = TileTotals.setID AND (SELECT COUNT(Y.setID) FROM SetTiles Y WHERE Y.tileID = C.tileID) = 2), "
+        "uniqueSize = uniqueSize - (SELECT IFNULL(SUM(C.size), 0) FROM temp.ChunkTiles C JOIN SetTiles X ON X.tileID = C.tileID "
+            "WHERE X.setID = TileTotals.setID AND (SELECT COUNT(Y.setID) FROM SetTiles Y WHERE Y.tileID = C.tileID) = 2) "
+        "WHERE setID IN (SELECT X.setID FROM temp.ChunkTiles C JOIN SetTiles X ON X.tileID = C.tileID WHERE X.setID != ?)");
+    query.addBindValue(setID);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (add chunk to shared tile totals):" << query.lastError().text();
+        return false;
+    }
+    query.prepare(
+        "UPDATE TileTotals SET "
+        "tileCount = tileCount + (SELECT COUNT(size) FROM temp.ChunkTiles), "
+        "tileSize = tileSize + (SELECT IFNULL(SUM(size), 0) FROM temp.ChunkTiles), "
+        "uniqueCount = uniqueCount + (SELECT COUNT(C.size) FROM temp.ChunkTiles C "
+            "WHERE (SELECT COUNT(Y.setID) FROM SetTiles Y WHERE Y.tileID = C.tileID) = 1), "
+        "uniqueSize = uniqueSize + (SELECT IFNULL(SUM(C.size), 0) FROM temp.ChunkTiles C "
+            "WHERE (SELECT COUNT(Y.setID) FROM SetTiles Y WHERE Y.tileID = C.tileID) = 1) "
+        "WHERE setID = ?");
+    query.addBindValue(setID);
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (add chunk to set totals):" << query.lastError().text();
+        return false;
+    }
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -946,21 +1688,23 @@ QGCCacheWorker::_init()
     if(!_databasePath.isEmpty()) {
         qCDebug(QGCTileCacheLog) << "Mapping cache directory:" << _databasePath;
         //-- Initialize Database
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-        _db->setDatabaseName(_databasePath);
-        _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (_db->open()) {
+        bool unusable = false;
+        if (_connectDB()) {
             _valid = _createDB(_db);
             if(!_valid) {
                 _failed = true;
+                unusable = true;
             }
         } else {
             qCritical() << "Map Cache SQL error (init() open db):" << _db->lastError();
             _failed = true;
         }
-        delete _db;
-        _db = NULL;
-        QSqlDatabase::removeDatabase(kSession);
+        _disconnectDB();
+        //-- A cache whose schema can't be created is dropped so the next start begins with a new one
+        if(unusable) {
+            QFile file(_databasePath);
+            file.remove();
+        }
     } else {
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
@@ -1023,17 +1767,35 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
                     "state INTEGER DEFAULT 0)"))
                 {
                     qWarning() << "Map Cache SQL error (create TilesDownload db):" << query.lastError().text();
+                } else if(!query.exec(
+                    "CREATE TABLE IF NOT EXISTS TileTotals ("
+                    "setID INTEGER PRIMARY KEY NOT NULL, "
+                    "tileCount INTEGER DEFAULT 0, "
+                    "tileSize INTEGER DEFAULT 0, "
+                    "uniqueCount INTEGER DEFAULT 0, "
+                    "uniqueSize INTEGER DEFAULT 0)"))
+                {
+                    qWarning() << "Map Cache SQL error (create TileTotals db):" << query.lastError().text();
                 } else {
-                    //-- Database it ready for use
-                    res = true;
+                    //-- Tiles.hash and TilesDownload.hash are indexed through their UNIQUE constraint. Set membership
+                    //   is looked up both by set and by tile. These are created on every start so older databases get them too.
+                    if(!query.exec("CREATE INDEX IF NOT EXISTS SetTilesSetIndex ON SetTiles(setID, tileID)") ||
+                            !query.exec("CREATE INDEX IF NOT EXISTS SetTilesTileIndex ON SetTiles(tileID)") ||
+                            !query.exec("CREATE INDEX IF NOT EXISTS TilesDownloadSetIndex ON TilesDownload(setID, state)")) {
+                        qWarning() << "Map Cache SQL error (create indexes):" << query.lastError().text();
+                    } else {
+                        //-- Database it ready for use
+                        res = true;
+                    }
                 }
             }
         }
     }
     //-- Create default tile set
     if(res && createDefault) {
-        QString s = QString("SELECT name FROM TileSets WHERE name = \"%1\"").arg(kDefaultSet);
-        if(query.exec(s)) {
+        query.prepare("SELECT name FROM TileSets WHERE name = ?");
+        query.addBindValue(kDefaultSet);
+        if(query.exec()) {
             if(!query.next()) {
                 query.prepare("INSERT INTO TileSets(name, defaultSet, date) VALUES(?, ?, ?)");
                 query.addBindValue(kDefaultSet);
@@ -1048,9 +1810,59 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
             qWarning() << "Map Cache SQL error (Looking for default tile set):" << db->lastError();
         }
     }
-    if(!res) {
-        QFile file(_databasePath);
-        file.remove();
+    //-- Not fatal, the totals are still missing on the next start and rebuilt then
+    if(res && !_checkTotals(db)) {
+        qWarning() << "Map Cache: tile totals could not be rebuilt, they are retried on the next start";
+    }
+    return res;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_checkTotals(QSqlDatabase* db)
+{
+    //-- Totals are missing for databases created before they were kept and for sets added through an import
+    bool missing = true;
+    QSqlQuery query(*db);
+    if(query.exec("SELECT setID FROM TileTotals WHERE setID = 0") && query.next()) {
+        missing = false;
+    }
+    if(!missing && query.exec("SELECT COUNT(S.setID) FROM TileSets S LEFT JOIN TileTotals T ON T.setID = S.setID WHERE T.setID IS NULL") && query.next()) {
+        missing = query.value(0).toInt() > 0;
+    }
+    if(missing) {
+        return _rebuildTotals(db);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_rebuildTotals(QSqlDatabase* db)
+{
+    //-- Full scan of the cache. Only used when the running totals can't be trusted.
+    qCDebug(QGCTileCacheLog) << "_rebuildTotals()";
+    QSqlQuery query(*db);
+    db->transaction();
+    bool res =
+        //-- Pruning used to leave set references to deleted tiles behind
+        query.exec("DELETE FROM SetTiles WHERE tileID NOT IN (SELECT tileID FROM Tiles)") &&
+        query.exec("DELETE FROM TileTotals") &&
+        query.exec("INSERT INTO TileTotals(setID, tileCount, tileSize) SELECT 0, COUNT(size), IFNULL(SUM(size), 0) FROM Tiles") &&
+        query.exec("INSERT INTO TileTotals(setID, tileCount, tileSize) "
+            "SELECT S.setID, COUNT(T.size), IFNULL(SUM(T.size), 0) FROM TileSets S "
+            "LEFT JOIN SetTiles B ON B.setID = S.setID LEFT JOIN Tiles T ON T.tileID = B.tileID GROUP BY S.setID") &&
+        query.exec("UPDATE TileTotals SET "
+            "uniqueCount = (SELECT COUNT(T.size) FROM SetTiles B JOIN Tiles T ON T.tileID = B.tileID "
+                "WHERE B.setID = TileTotals.setID AND (SELECT COUNT(C.setID) FROM SetTiles C WHERE C.tileID = B.tileID) = 1), "
+            "uniqueSize = (SELECT IFNULL(SUM(T.size), 0) FROM SetTiles B JOIN Tiles T ON T.tileID = B.tileID "
+                "WHERE B.setID = TileTotals.setID AND (SELECT COUNT(C.setID) FROM SetTiles C WHERE C.tileID = B.tileID) = 1) "
+            "WHERE setID != 0");
+    if(res) {
+        db->commit();
+    } else {
+        qWarning() << "Map Cache SQL error (rebuild TileTotals):" << query.lastError().text();
+        db->rollback();
     }
     return res;
 }
@@ -25,8 +25,12 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <QMutexLocker>
+#include <QList>
 #include <QtSql/QSqlDatabase>
 #include <QHostInfo>
+#include <QHash>
+
+class QSqlQuery;
 
 #include "QGCLoggingCategory.h"
 
@@ -34,8 +38,35 @@ Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheLog)
 
 class QGCMapTask;
 class QGCCachedTileSet;
+class QGCCacheWorker;
 
 //-----------------------------------------------------------------------------
+//-- Serves tile fetches through its own read-only database connection. This keeps
+//   the tiles shown on the map from waiting behind tile set downloads being written
+//   by the worker thread.
+class QGCCacheReader : public QThread
+{
+public:
+    QGCCacheReader  (QGCCacheWorker* worker, int index);
+
+protected:
+    void    run             ();
+
+private:
+    bool    _connectDB      ();
+    void    _disconnectDB   ();
+    void    _getTile        (QGCMapTask* mtask);
+
+    QGCCacheWorker*         _worker;
+    QString                 _session;
+    QSqlDatabase*           _db;
+    QSqlQuery*              _query;
+};
+
+//-----------------------------------------------------------------------------
+//-- Tile fetches go to a read queue served by a small pool of QGCCacheReader threads.
+//   Everything else goes to the write queue, run in order on this thread with the only
+//   writing connection. Consecutive tile writes are batched into one transaction.
 class QGCCacheWorker : public QThread
 {
     Q_OBJECT
@@ -43,9 +74,21 @@ public:
     QGCCacheWorker  ();
     ~QGCCacheWorker ();
 
+    struct Stats_t {
+        int     readQueueDepth;
+        int     writeQueueDepth;
+        quint64 reads;                  ///< Tile fetches completed
+        quint64 writes;                 ///< All other tasks completed
+        qint64  readLatencyAvgMSecs;    ///< Queued to completed
+        qint64  readLatencyMaxMSecs;
+        qint64  writeLatencyAvgMSecs;
+        qint64  writeLatencyMaxMSecs;
+    };
+
     void    quit            ();
     bool    enqueueTask     (QGCMapTask* task);
     void    setDatabaseFile (const QString& path);
+    Stats_t stats           ();
 
 protected:
     void    run             ();
@@ -55,6 +98,7 @@ private slots:
 
 private:
     void        _saveTile               (QGCMapTask* mtask);
+    void        _writeBatch             (QGCMapTask* mtask);
     void        _getTile                (QGCMapTask* mtask);
     void        _getTileSets            (QGCMapTask* mtask);
     void        _createTileSet          (QGCMapTask* mtask);
@@ -69,25 +113,59 @@ private:
     bool        _testTask               (QGCMapTask* mtask);
     void        _testInternet           ();
 
-    quint64     _findTile               (const QString hash);
+    quint64     _findTile               (const QString hash, quint64* size = NULL);
+    bool        _addTileToSet           (quint64 tileID, quint64 setID, quint64 size);
+    void        _addToTotals            (quint64 setID, qint64 count, qint64 size, qint64 uniqueCount, qint64 uniqueSize);
+    bool        _getTotals              (quint64 setID, quint64& count, quint64& size, quint64& uniqueCount, quint64& uniqueSize);
+    bool        _checkTotals            (QSqlDatabase* db);
+    bool        _rebuildTotals          (QSqlDatabase* db);
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
     bool        _init                   ();
+    bool        _connectDB              ();
+    void        _disconnectDB           ();
+    QSqlQuery*  _prepared               (const QString& sql);
+    void        _clearPrepared          ();
     bool        _createDB               (QSqlDatabase *db, bool createDefault = true);
+    bool        _createExportDB         (const QString& path, const QString& selection);
+    bool        _attachDB               (const QString& path, const QString& schema);
+    void        _detachDB               (const QString& schema);
+    qint64      _copyTileChunk          (const QString& from, const QString& to, quint64 fromSetID, quint64 toSetID, quint64 lastTileID, quint64& chunkEnd);
+    bool        _addChunkToTotals       (quint64 setID, quint64 lastTileID);
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
+    QGCMapTask* _nextRead               ();
+    void        _taskDone               (QGCMapTask* task);
+    void        _startReaders           ();
+    void        _stopReaders            ();
+
+    friend class QGCCacheReader;
 
 signals:
     void        updateTotals            (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void        internetStatus          (bool active);
 
 private:
-    QQueue<QGCMapTask*>     _taskQueue;
+    QQueue<QGCMapTask*>     _taskQueue;     ///< Write queue
+    QQueue<QGCMapTask*>     _readQueue;
+    QWaitCondition          _readWaitc;
+    QList<QGCCacheReader*>  _readers;
+    bool                    _readersStarted;
+    bool                    _readersStop;
+    bool                    _quitting;
+    QHash<QString, int>     _pendingSaves;  ///< Hashes of queued tile writes, fetches for them stay in order behind the write
+    quint64                 _reads;
+    quint64                 _writes;
+    qint64                  _readLatencyTotal;
+    qint64                  _readLatencyMax;
+    qint64                  _writeLatencyTotal;
+    qint64                  _writeLatencyMax;
     QMutex                  _mutex;
     QMutex                  _waitmutex;
     QWaitCondition          _waitc;
     QString                 _databasePath;
     QSqlDatabase*           _db;
+    QHash<QString, QSqlQuery*> _queryCache;   ///< Prepared statements for _db, keyed by SQL
     bool                    _valid;
     bool                    _failed;
     quint64                 _defaultSet;
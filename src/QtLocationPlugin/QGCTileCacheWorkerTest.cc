@@ -0,0 +1,443 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCMapEngine.h"
+#include "QGCMapTileSet.h"
+#include "QGCTileMemCache.h"
+
+#include <QAtomicInt>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+
+/// Stops the worker thread before deleting the worker
+struct WorkerDeleter
+{
+    static inline void cleanup(QGCCacheWorker* worker)
+    {
+        if (worker) {
+            worker->quit();
+            worker->wait();
+            delete worker;
+        }
+    }
+};
+
+QGCTileCacheWorkerTest::QGCTileCacheWorkerTest(void)
+    : _tempDir(NULL)
+    , _worker(NULL)
+    , _fetchedCount(0)
+{
+
+}
+
+void QGCTileCacheWorkerTest::initTestCase(void)
+{
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+
+    _worker = new QGCCacheWorker;
+    _startWorker(_worker, _tempDir->path() + QStringLiteral("/qgcTileCacheTest.db"));
+}
+
+/// Starts the worker on the specified database and waits for it to be ready
+void QGCTileCacheWorkerTest::_startWorker(QGCCacheWorker* worker, const QString& databaseFile)
+{
+    worker->setDatabaseFile(databaseFile);
+    QVERIFY(worker->enqueueTask(new QGCMapTask(QGCMapTask::taskInit)));
+
+    // Other tasks are rejected until init has completed. Once a tile set fetch comes back the database is ready.
+    QScopedPointer<QSignalSpy> spy;
+    bool enqueued = false;
+    for (int i=0; i<100 && !enqueued; i++) {
+        QGCFetchTileSetTask* task = new QGCFetchTileSetTask;
+        spy.reset(new QSignalSpy(task, &QGCFetchTileSetTask::tileSetFetched));
+        enqueued = worker->enqueueTask(task);
+        if (!enqueued) {
+            QTest::qWait(100);
+        }
+    }
+    QVERIFY(enqueued);
+    QVERIFY(spy->count() || spy->wait(10000));
+    foreach (const QList<QVariant>& args, *spy) {
+        delete args[0].value<QGCCachedTileSet*>();
+    }
+}
+
+/// Fetches the tile sets of the worker, default set first then by name. Caller owns the sets.
+void QGCTileCacheWorkerTest::_fetchTileSets(QGCCacheWorker* worker, int expectedCount, QList<QGCCachedTileSet*>& sets)
+{
+    QGCFetchTileSetTask* task = new QGCFetchTileSetTask;
+    QSignalSpy spy(task, &QGCFetchTileSetTask::tileSetFetched);
+    QVERIFY(worker->enqueueTask(task));
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), expectedCount, 60000);
+    foreach (const QList<QVariant>& args, spy) {
+        sets.append(args[0].value<QGCCachedTileSet*>());
+    }
+}
+
+void QGCTileCacheWorkerTest::cleanupTestCase(void)
+{
+    _worker->quit();
+    _worker->wait();
+    delete _worker;
+    _worker = NULL;
+    delete _tempDir;
+    _tempDir = NULL;
+}
+
+QString QGCTileCacheWorkerTest::_tileHash(int index)
+{
+    return QGCMapEngine::getTileHash(UrlFactory::GoogleSatellite, index % 1000, index / 1000, 20);
+}
+
+void QGCTileCacheWorkerTest::_tileFetched(QGCCacheTile* tile)
+{
+    _fetchedCount++;
+    delete tile;
+}
+
+/// Fetches the first count tiles and waits for all of them to come back
+void QGCTileCacheWorkerTest::_fetchTiles(int count)
+{
+    _fetchedCount = 0;
+    for (int i=0; i<count; i++) {
+        QGCFetchTileTask* task = new QGCFetchTileTask(_tileHash(i));
+        connect(task, &QGCFetchTileTask::tileFetched, this, &QGCTileCacheWorkerTest::_tileFetched);
+        QVERIFY(_worker->enqueueTask(task));
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(_fetchedCount, count, 60000);
+}
+
+void QGCTileCacheWorkerTest::_report(const char* what, int tileCount, qint64 msecs)
+{
+    qDebug() << what << tileCount << "tiles in" << msecs << "msecs," << (msecs ? (tileCount * 1000) / msecs : tileCount * 1000) << "tiles/sec";
+}
+
+void QGCTileCacheWorkerTest::_insert_test(void)
+{
+    // Typical satellite tile size
+    QByteArray img(15 * 1024, 'x');
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i=0; i<_tileCount; i++) {
+        QGCCacheTile* tile = new QGCCacheTile(_tileHash(i), img, QStringLiteral("jpg"), UrlFactory::GoogleSatellite);
+        QVERIFY(_worker->enqueueTask(new QGCSaveTileTask(tile)));
+    }
+
+    // Writes are processed in order and a fetch of a tile still queued for writing waits for it,
+    // so once the last tile can be fetched all of them are saved
+    _fetchedCount = 0;
+    QGCFetchTileTask* task = new QGCFetchTileTask(_tileHash(_tileCount - 1));
+    connect(task, &QGCFetchTileTask::tileFetched, this, &QGCTileCacheWorkerTest::_tileFetched);
+    QVERIFY(_worker->enqueueTask(task));
+    QTRY_COMPARE_WITH_TIMEOUT(_fetchedCount, 1, 60000);
+
+    _report("Insert:", _tileCount, timer.elapsed());
+}
+
+void QGCTileCacheWorkerTest::_cacheHit_test(void)
+{
+    QElapsedTimer timer;
+    timer.start();
+    _fetchTiles(_tileCount);
+    _report("Cache hit:", _tileCount, timer.elapsed());
+}
+
+void QGCTileCacheWorkerTest::_totals_test(void)
+{
+    // Tile set totals come from the running totals, not from scanning the tile tables
+    QElapsedTimer timer;
+    timer.start();
+    QGCFetchTileSetTask* task = new QGCFetchTileSetTask;
+    QSignalSpy spy(task, &QGCFetchTileSetTask::tileSetFetched);
+    QVERIFY(_worker->enqueueTask(task));
+    QVERIFY(spy.wait(10000));
+    qDebug() << "Tile set totals in" << timer.elapsed() << "msecs";
+
+    QGCCachedTileSet* set = spy[0][0].value<QGCCachedTileSet*>();
+    QVERIFY(set->defaultSet());
+    QCOMPARE(set->savedTileCount(), (quint32)_tileCount);
+    QCOMPARE(set->savedTileSize(), (quint64)_tileCount * 15 * 1024);
+    QCOMPARE(set->totalTileCount(), (quint32)_tileCount);
+    foreach (const QList<QVariant>& args, spy) {
+        delete args[0].value<QGCCachedTileSet*>();
+    }
+}
+
+void QGCTileCacheWorkerTest::_createTileSet_test(void)
+{
+    // A few hundred tiles at zoom 17 by default, about 100k when benchmarking
+    bool benchmark = UnitTest::benchmarksEnabled();
+    QGCCachedTileSet* set = new QGCCachedTileSet(QStringLiteral("Create Set"));
+    set->setMapTypeStr(QStringLiteral("Google Satellite"));
+    set->setType(UrlFactory::GoogleSatellite);
+    set->setTopleftLat(47.5);
+    set->setTopleftLon(8.0);
+    set->setBottomRightLat(benchmark ? 46.91 : 47.465);
+    set->setBottomRightLon(benchmark ? 8.865 : 8.05);
+    set->setMinZoom(17);
+    set->setMaxZoom(17);
+    QGCTileSet tileCount = QGCMapEngine::getTileCount(17, set->topleftLon(), set->topleftLat(), set->bottomRightLon(), set->bottomRightLat(), set->type());
+    set->setTotalTileCount(tileCount.tileCount);
+
+    QElapsedTimer timer;
+    timer.start();
+    QGCCreateTileSetTask* task = new QGCCreateTileSetTask(set);
+    QSignalSpy spy(task, &QGCCreateTileSetTask::tileSetSaved);
+    QVERIFY(_worker->enqueueTask(task));
+    QVERIFY(spy.wait(benchmark ? 300000 : 30000));
+    qint64 elapsed = timer.elapsed();
+
+    // Every tile in the region should be queued for download. The list is counted on the
+    // worker thread, QList<QGCTile*> is not a metatype this test can queue.
+    QAtomicInt listed(-1);
+    QGCGetTileDownloadListTask* listTask = new QGCGetTileDownloadListTask(set->setID(), (int)tileCount.tileCount + 1);
+    connect(listTask, &QGCGetTileDownloadListTask::tileListFetched, [&listed](QList<QGCTile*> tiles) {
+        listed.store(tiles.count());
+        qDeleteAll(tiles);
+    });
+    QVERIFY(_worker->enqueueTask(listTask));
+    QTRY_VERIFY_WITH_TIMEOUT(listed.load() != -1, 30000);
+    QCOMPARE((quint64)listed.load(), tileCount.tileCount);
+
+    if (benchmark) {
+        _report("Create tile set:", (int)tileCount.tileCount, elapsed);
+    }
+    delete set;
+}
+
+void QGCTileCacheWorkerTest::_memCache_test(void)
+{
+    const int tileBytes = 15 * 1024;
+    QByteArray img(tileBytes, 'x');
+    QGCTileMemCache cache(tileBytes * 3);
+
+    QVERIFY(cache.find(_tileHash(0)) == NULL);
+    for (int i=0; i<3; i++) {
+        cache.insert(_tileHash(i), img, QStringLiteral("jpg"), UrlFactory::GoogleSatellite);
+    }
+
+    // Touch tile 0 so tile 1 is the least recently used when tile 3 goes in
+    QScopedPointer<QGCCacheTile> tile(cache.find(_tileHash(0)));
+    QVERIFY(tile);
+    QCOMPARE(tile->hash(), _tileHash(0));
+    QCOMPARE(tile->img(), img);
+    QCOMPARE(tile->format(), QStringLiteral("jpg"));
+    QCOMPARE(tile->type(), UrlFactory::GoogleSatellite);
+
+    cache.insert(_tileHash(3), img, QStringLiteral("jpg"), UrlFactory::GoogleSatellite);
+    tile.reset(cache.find(_tileHash(1)));
+    QVERIFY(!tile);
+    tile.reset(cache.find(_tileHash(0)));
+    QVERIFY(tile);
+
+    // Re-inserting an existing tile is not an eviction
+    cache.insert(_tileHash(3), img, QStringLiteral("jpg"), UrlFactory::GoogleSatellite);
+
+    QGCTileMemCache::Stats_t stats = cache.stats();
+    QCOMPARE(stats.hits,        (quint64)2);
+    QCOMPARE(stats.misses,      (quint64)2);
+    QCOMPARE(stats.evictions,   (quint64)1);
+    QCOMPARE(stats.tileCount,   3);
+    QCOMPARE(stats.bytes,       tileBytes * 3);
+
+    // Shrinking the budget evicts, a zero budget disables the cache
+    cache.setMaxBytes(tileBytes);
+    QCOMPARE(cache.stats().tileCount, 1);
+    QCOMPARE(cache.stats().evictions, (quint64)3);
+    cache.setMaxBytes(0);
+    cache.insert(_tileHash(4), img, QStringLiteral("jpg"), UrlFactory::GoogleSatellite);
+    QCOMPARE(cache.stats().tileCount, 0);
+}
+
+void QGCTileCacheWorkerTest::_readPriority_test(void)
+{
+    QByteArray img(15 * 1024, 'x');
+    QGCCacheWorker::Stats_t before = _worker->stats();
+
+    // A fetch of a saved tile must not wait behind a large batch of writes
+    for (int i=_tileCount; i<_tileCount * 2; i++) {
+        QGCCacheTile* tile = new QGCCacheTile(_tileHash(i), img, QStringLiteral("jpg"), UrlFactory::GoogleSatellite);
+        QVERIFY(_worker->enqueueTask(new QGCSaveTileTask(tile)));
+    }
+    QElapsedTimer timer;
+    timer.start();
+    _fetchedCount = 0;
+    QGCFetchTileTask* task = new QGCFetchTileTask(_tileHash(0));
+    connect(task, &QGCFetchTileTask::tileFetched, this, &QGCTileCacheWorkerTest::_tileFetched);
+    QVERIFY(_worker->enqueueTask(task));
+    QTRY_COMPARE_WITH_TIMEOUT(_fetchedCount, 1, 60000);
+    qDebug() << "Fetch behind" << _tileCount << "queued writes in" << timer.elapsed() << "msecs, writes still queued:" << _worker->stats().writeQueueDepth;
+
+    // A fetch of a tile still queued for writing is answered once it is written
+    _fetchedCount = 0;
+    task = new QGCFetchTileTask(_tileHash(_tileCount * 2 - 1));
+    connect(task, &QGCFetchTileTask::tileFetched, this, &QGCTileCacheWorkerTest::_tileFetched);
+    QVERIFY(_worker->enqueueTask(task));
+    QTRY_COMPARE_WITH_TIMEOUT(_fetchedCount, 1, 60000);
+    _report("Insert with concurrent reads:", _tileCount, timer.elapsed());
+
+    // A task is counted once the worker is done with it, which can be after its result was handled here
+    QTRY_COMPARE(_worker->stats().reads, before.reads + 2);
+    QTRY_COMPARE(_worker->stats().writes, before.writes + _tileCount);
+    QTRY_COMPARE(_worker->stats().readQueueDepth, 0);
+    QTRY_COMPARE(_worker->stats().writeQueueDepth, 0);
+    QGCCacheWorker::Stats_t stats = _worker->stats();
+    qDebug() << "Read latency avg/max" << stats.readLatencyAvgMSecs << stats.readLatencyMaxMSecs << "msecs,"
+             << "write latency avg/max" << stats.writeLatencyAvgMSecs << stats.writeLatencyMaxMSecs << "msecs";
+}
+
+void QGCTileCacheWorkerTest::_bulkExportImport_test(void)
+{
+    // Synthetic cache with one tile set of small tiles. It is filled through SQL directly, going through the
+    // worker would make building it the slowest part of the test. A few export chunks by default, a large
+    // cache when benchmarking.
+    const bool benchmark = UnitTest::benchmarksEnabled();
+    const int bulkTileCount = benchmark ? (int)_bulkBenchmarkTileCount : (int)_bulkTileCount;
+    const int bulkTimeout = benchmark ? 600000 : 60000;
+    const QString syntheticFile = _tempDir->path() + QStringLiteral("/qgcTileCacheSynthetic.db");
+    const QString exportFile = _tempDir->path() + QStringLiteral("/qgcTileCacheExport.qgctiledb");
+    const QString importFile = _tempDir->path() + QStringLiteral("/qgcTileCacheImport.db");
+
+    // The worker creates the schema
+    QScopedPointer<QGCCacheWorker, WorkerDeleter> worker(new QGCCacheWorker);
+    _startWorker(worker.data(), syntheticFile);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    worker.reset();
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", QStringLiteral("SyntheticTileCache"));
+        db.setDatabaseName(syntheticFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(db.transaction());
+        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) "
+                      "WITH RECURSIVE N(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM N WHERE i < ?) "
+                      "SELECT printf('synthetic%08d', i), 'jpg', randomblob(256), 256, ?, 0 FROM N");
+        query.addBindValue(bulkTileCount);
+        query.addBindValue((int)UrlFactory::GoogleSatellite);
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        query.prepare("INSERT INTO TileSets(name, typeStr, minZoom, maxZoom, type, numTiles, defaultSet, date) VALUES(?, ?, 3, 17, ?, ?, 0, 0)");
+        query.addBindValue(QStringLiteral("Synthetic Set"));
+        query.addBindValue(QStringLiteral("Google Satellite"));
+        query.addBindValue((int)UrlFactory::GoogleSatellite);
+        query.addBindValue(bulkTileCount);
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        QVariant setID = query.lastInsertId();
+        query.prepare("INSERT INTO SetTiles(tileID, setID) SELECT tileID, ? FROM Tiles");
+        query.addBindValue(setID);
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        // Rebuilt when the worker opens the cache again
+        QVERIFY(query.exec("DELETE FROM TileTotals"));
+        QVERIFY(db.commit());
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("SyntheticTileCache"));
+
+    worker.reset(new QGCCacheWorker);
+    _startWorker(worker.data(), syntheticFile);
+    QList<QGCCachedTileSet*> sets;
+    _fetchTileSets(worker.data(), 2, sets);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QCOMPARE(sets[1]->name(), QStringLiteral("Synthetic Set"));
+    QCOMPARE(sets[1]->savedTileCount(), (quint32)bulkTileCount);
+
+    QElapsedTimer timer;
+    timer.start();
+    QGCExportTileTask* exportTask = new QGCExportTileTask(QVector<QGCCachedTileSet*>() << sets[1], exportFile);
+    QSignalSpy exportSpy(exportTask, &QGCExportTileTask::actionCompleted);
+    QSignalSpy exportRateSpy(exportTask, &QGCExportTileTask::actionThroughput);
+    QSignalSpy exportErrorSpy(exportTask, &QGCMapTask::error);
+    QVERIFY(worker->enqueueTask(exportTask));
+    QVERIFY(exportSpy.wait(bulkTimeout));
+    if (benchmark) {
+        _report("Bulk export:", bulkTileCount, timer.elapsed());
+    }
+    QCOMPARE(exportErrorSpy.count(), 0);
+    QVERIFY(exportRateSpy.count() > 0);
+    QVERIFY(QFile::exists(exportFile));
+    QVERIFY(!QFile::exists(exportFile + QStringLiteral(".partial")));
+    qDeleteAll(sets);
+    sets.clear();
+
+    worker.reset(new QGCCacheWorker);
+    _startWorker(worker.data(), importFile);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    timer.start();
+    QGCImportTileTask* importTask = new QGCImportTileTask(exportFile, false);
+    QSignalSpy importSpy(importTask, &QGCImportTileTask::actionCompleted);
+    QSignalSpy importErrorSpy(importTask, &QGCMapTask::error);
+    QVERIFY(worker->enqueueTask(importTask));
+    QVERIFY(importSpy.wait(bulkTimeout));
+    if (benchmark) {
+        _report("Bulk import:", bulkTileCount, timer.elapsed());
+    }
+    QCOMPARE(importErrorSpy.count(), 0);
+
+    _fetchTileSets(worker.data(), 2, sets);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QCOMPARE(sets[1]->name(), QStringLiteral("Synthetic Set"));
+    QCOMPARE(sets[1]->savedTileCount(), (quint32)bulkTileCount);
+    QCOMPARE(sets[1]->savedTileSize(), (quint64)bulkTileCount * 256);
+    // Imported tiles are added to the running totals, no tile is shared with the default set
+    QCOMPARE(sets[1]->uniqueTileCount(), (quint32)bulkTileCount);
+    QCOMPARE(sets[1]->uniqueTileSize(), (quint64)bulkTileCount * 256);
+    quint64 importedSetID = sets[1]->id();
+    qDeleteAll(sets);
+    sets.clear();
+
+    // Import interrupted half way: importing the file again continues into the same set instead of adding a new one
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", QStringLiteral("InterruptedImport"));
+        db.setDatabaseName(importFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO ImportProgress(source, name, setID, lastTileID) VALUES(?, ?, ?, ?)");
+        query.addBindValue(QFileInfo(exportFile).canonicalFilePath());
+        query.addBindValue(QStringLiteral("Synthetic Set"));
+        query.addBindValue(importedSetID);
+        query.addBindValue(bulkTileCount / 2);
+        QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("InterruptedImport"));
+
+    timer.start();
+    importTask = new QGCImportTileTask(exportFile, false);
+    QSignalSpy resumeSpy(importTask, &QGCImportTileTask::actionCompleted);
+    QVERIFY(worker->enqueueTask(importTask));
+    QVERIFY(resumeSpy.wait(bulkTimeout));
+    if (benchmark) {
+        _report("Bulk import resumed half way:", bulkTileCount / 2, timer.elapsed());
+    }
+
+    _fetchTileSets(worker.data(), 2, sets);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QCOMPARE(sets[1]->name(), QStringLiteral("Synthetic Set"));
+    QCOMPARE(sets[1]->savedTileCount(), (quint32)bulkTileCount);
+    QCOMPARE(sets[1]->uniqueTileCount(), (quint32)bulkTileCount);
+    qDeleteAll(sets);
+}
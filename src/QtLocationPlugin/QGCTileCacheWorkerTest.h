@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+class QGCCacheWorker;
+class QGCCacheTile;
+class QGCCachedTileSet;
+
+/// Throughput tests for the tile cache database. Results are reported as tiles/sec.
+class QGCTileCacheWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTileCacheWorkerTest(void);
+
+private slots:
+    void initTestCase(void);
+    void cleanupTestCase(void);
+
+    void _insert_test(void);
+    void _cacheHit_test(void);
+    void _totals_test(void);
+    void _createTileSet_test(void);
+    void _memCache_test(void);
+    void _readPriority_test(void);
+    void _bulkExportImport_test(void);
+
+    void _tileFetched(QGCCacheTile* tile);
+
+private:
+    QString _tileHash       (int index);
+    void    _fetchTiles     (int count);
+    void    _report         (const char* what, int tileCount, qint64 msecs);
+    void    _startWorker    (QGCCacheWorker* worker, const QString& databaseFile);
+    void    _fetchTileSets  (QGCCacheWorker* worker, int expectedCount, QList<QGCCachedTileSet*>& sets);
+
+    QTemporaryDir*  _tempDir;
+    QGCCacheWorker* _worker;
+    int             _fetchedCount;
+
+    static const int _tileCount = 5000;
+    static const int _bulkTileCount = 10000;            ///< Size of the synthetic cache used for export/import
+    static const int _bulkBenchmarkTileCount = 500000;  ///< Same, when benchmarks are enabled
+};
@@ -0,0 +1,142 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Tile downloader for offline tile sets
+ *
+ */
+
+#include "QGCTileDownloader.h"
+#include "QGCMapEngine.h"
+
+#include <QNetworkProxy>
+
+QGC_LOGGING_CATEGORY(QGCTileDownloaderLog, "QGCTileDownloaderLog")
+
+//-- Interval the download rate is computed over
+#define RATE_INTERVAL_MS    1000
+
+//-----------------------------------------------------------------------------
+QGCTileDownloader::QGCTileDownloader(QObject* parent)
+    : QObject(parent)
+    , _networkManager(new QNetworkAccessManager(this))
+    , _maxInFlight(48)
+    , _rateCount(0)
+    , _tilesPerSecond(0.0)
+{
+#if !defined(__mobile__)
+    QNetworkProxy tProxy;
+    tProxy.setType(QNetworkProxy::DefaultProxy);
+    _networkManager->setProxy(tProxy);
+#endif
+    _rateTimer.setInterval(RATE_INTERVAL_MS);
+    connect(&_rateTimer, &QTimer::timeout, this, &QGCTileDownloader::_updateRate);
+}
+
+//-----------------------------------------------------------------------------
+QGCTileDownloader::~QGCTileDownloader()
+{
+    //-- Replies in flight go with the network manager
+    qDeleteAll(_queue);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloader::enqueue(const QList<QGCTile*>& tiles)
+{
+    foreach(QGCTile* tile, tiles) {
+        _queue.enqueue(tile);
+    }
+    if(!_rateTimer.isActive()) {
+        _rateCount = 0;
+        _rateElapsed.start();
+        _rateTimer.start();
+    }
+    _sendRequests();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloader::cancel()
+{
+    qDeleteAll(_queue);
+    _queue.clear();
+    QList<QNetworkReply*> replies = _replies.keys();
+    _replies.clear();
+    foreach(QNetworkReply* reply, replies) {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    _updateRate();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloader::_sendRequests()
+{
+    while(_replies.count() < _maxInFlight && _queue.count()) {
+        QGCTile* tile = _queue.dequeue();
+        QNetworkRequest request;
+        if(_urlTemplate.isEmpty()) {
+            request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
+        } else {
+            request.setUrl(QUrl(_urlTemplate.arg(tile->z()).arg(tile->x()).arg(tile->y())));
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+        //-- Lets all requests to a host share one connection where the server speaks HTTP/2
+        request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+        QNetworkReply* reply = _networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, this, &QGCTileDownloader::_replyFinished);
+        _replies.insert(reply, tile->hash());
+        delete tile;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloader::_replyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
+    if(!reply || !_replies.contains(reply)) {
+        qWarning() << "QGCTileDownloader::_replyFinished() Reply not in list";
+        return;
+    }
+    QString hash = _replies.take(reply);
+    _rateCount++;
+    if(reply->error() != QNetworkReply::NoError) {
+        qCDebug(QGCTileDownloaderLog) << "Error fetching tile" << hash << reply->errorString();
+        emit tileFailed(hash, reply->errorString());
+    } else {
+        qCDebug(QGCTileDownloaderLog) << "Tile fetched" << hash;
+        emit tileDownloaded(hash, reply->readAll());
+    }
+    reply->deleteLater();
+    _sendRequests();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileDownloader::_updateRate()
+{
+    qint64 elapsed = _rateElapsed.isValid() ? _rateElapsed.restart() : 0;
+    double rate = elapsed > 0 ? (double)_rateCount * 1000.0 / (double)elapsed : 0.0;
+    _rateCount = 0;
+    if(idle()) {
+        _rateTimer.stop();
+        rate = 0.0;
+    }
+    if(rate != _tilesPerSecond) {
+        _tilesPerSecond = rate;
+        emit tilesPerSecondChanged(_tilesPerSecond);
+    }
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Tile downloader for offline tile sets
+ *
+ */
+
+#ifndef QGC_TILE_DOWNLOADER_H
+#define QGC_TILE_DOWNLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileDownloaderLog)
+
+class QGCTile;
+
+//-----------------------------------------------------------------------------
+//-- Keeps a deep pipeline of tile requests in flight. QNetworkAccessManager reuses
+//   its keep-alive connections to each host (and multiplexes them over HTTP/2 where
+//   the server supports it), so requests queued beyond its per host connection limit
+//   go out as soon as a connection is free instead of waiting for the next refill.
+class QGCTileDownloader : public QObject
+{
+    Q_OBJECT
+public:
+    QGCTileDownloader   (QObject* parent = NULL);
+    ~QGCTileDownloader  ();
+
+    //-- Queues tiles for download. Takes ownership of the tiles.
+    void        enqueue         (const QList<QGCTile*>& tiles);
+    //-- Drops queued tiles and aborts the ones in flight without reporting them
+    void        cancel          ();
+    void        setMaxInFlight  (int maxInFlight)           { _maxInFlight = maxInFlight; }
+    //-- Fetches tiles from the given server instead of the map provider. %1 is replaced
+    //   by the zoom level, %2 by x and %3 by y. An empty template uses the map provider.
+    void        setUrlTemplate  (const QString& urlTemplate) { _urlTemplate = urlTemplate; }
+
+    int         queuedCount     () const { return _queue.count(); }
+    int         inFlightCount   () const { return _replies.count(); }
+    bool        idle            () const { return _queue.isEmpty() && _replies.isEmpty(); }
+    //-- Tiles completed (downloaded or failed) per second, over the last second
+    double      tilesPerSecond  () const { return _tilesPerSecond; }
+
+signals:
+    void        tileDownloaded          (QString hash, QByteArray image);
+    void        tileFailed              (QString hash, QString errorString);
+    void        tilesPerSecondChanged   (double tilesPerSecond);
+
+private slots:
+    void        _replyFinished          ();
+    void        _updateRate             ();
+
+private:
+    void        _sendRequests           ();
+
+    QNetworkAccessManager*          _networkManager;
+    QQueue<QGCTile*>                _queue;
+    QHash<QNetworkReply*, QString>  _replies;       ///< Tile hash of each request in flight
+    int                             _maxInFlight;
+    QString                         _urlTemplate;
+    QTimer                          _rateTimer;
+    QElapsedTimer                   _rateElapsed;
+    int                             _rateCount;
+    double                          _tilesPerSecond;
+};
+
+#endif // QGC_TILE_DOWNLOADER_H
@@ -0,0 +1,169 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileDownloaderTest.h"
+#include "QGCTileDownloader.h"
+#include "QGCMapEngine.h"
+
+#include <QElapsedTimer>
+
+QGCTileDownloaderTest::QGCTileDownloaderTest(void)
+    : _server(NULL)
+    , _connectionCount(0)
+    , _requestCount(0)
+{
+
+}
+
+void QGCTileDownloaderTest::init(void)
+{
+    UnitTest::init();
+
+    _connectionCount = 0;
+    _requestCount = 0;
+    _server = new QTcpServer(this);
+    connect(_server, &QTcpServer::newConnection, this, &QGCTileDownloaderTest::_newConnection);
+    QVERIFY(_server->listen(QHostAddress::LocalHost));
+}
+
+void QGCTileDownloaderTest::cleanup(void)
+{
+    delete _server;
+    _server = NULL;
+    _requestBuffers.clear();
+
+    UnitTest::cleanup();
+}
+
+void QGCTileDownloaderTest::_newConnection(void)
+{
+    while (_server->hasPendingConnections()) {
+        QTcpSocket* socket = _server->nextPendingConnection();
+        _connectionCount++;
+        _requestBuffers[socket] = QByteArray();
+        connect(socket, &QTcpSocket::readyRead, this, &QGCTileDownloaderTest::_readRequests);
+    }
+}
+
+/// Stand-in tile server: answers every request on a keep-alive connection with a small png, zoom 0 tiles are missing
+void QGCTileDownloaderTest::_readRequests(void)
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    QByteArray& buffer = _requestBuffers[socket];
+    buffer.append(socket->readAll());
+
+    int headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        QList<QByteArray> requestLine = buffer.left(buffer.indexOf("\r\n")).split(' ');
+        buffer.remove(0, headerEnd + 4);
+        _requestCount++;
+
+        QByteArray path = requestLine.count() > 1 ? requestLine[1] : QByteArray();
+        if (path.startsWith("/0/")) {
+            socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        } else {
+            QByteArray image("\x89PNG\r\n\x1a\n", 8);
+            image.append(QByteArray(1024, 'x'));
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: image/png\r\nContent-Length: " + QByteArray::number(image.size()) + "\r\n\r\n");
+            socket->write(image);
+        }
+    }
+}
+
+QList<QGCTile*> QGCTileDownloaderTest::_tiles(int count, int zoom)
+{
+    QList<QGCTile*> tiles;
+    for (int i=0; i<count; i++) {
+        QGCTile* tile = new QGCTile;
+        tile->setX(i % 100);
+        tile->setY(i / 100);
+        tile->setZ(zoom);
+        tile->setType(UrlFactory::GoogleSatellite);
+        tile->setHash(QGCMapEngine::getTileHash(UrlFactory::GoogleSatellite, tile->x(), tile->y(), zoom));
+        tiles.append(tile);
+    }
+    return tiles;
+}
+
+QString QGCTileDownloaderTest::_url(void) const
+{
+    return QString("http://127.0.0.1:%1").arg(_server->serverPort()) + QStringLiteral("/%1/%2/%3");
+}
+
+void QGCTileDownloaderTest::_download_test(void)
+{
+    const int tileCount = 2000;
+    const int maxInFlight = 48;
+
+    QGCTileDownloader downloader;
+    downloader.setUrlTemplate(_url());
+    downloader.setMaxInFlight(maxInFlight);
+    QSignalSpy downloadedSpy(&downloader, &QGCTileDownloader::tileDownloaded);
+    QSignalSpy failedSpy(&downloader, &QGCTileDownloader::tileFailed);
+    QSignalSpy rateSpy(&downloader, &QGCTileDownloader::tilesPerSecondChanged);
+
+    QElapsedTimer timer;
+    timer.start();
+    downloader.enqueue(_tiles(tileCount, 17));
+
+    // The pipeline is filled right away, the rest waits in the queue
+    QCOMPARE(downloader.inFlightCount(), maxInFlight);
+    QCOMPARE(downloader.queuedCount(), tileCount - maxInFlight);
+
+    QTRY_COMPARE_WITH_TIMEOUT(downloadedSpy.count(), tileCount, 60000);
+    qint64 msecs = timer.elapsed();
+    qDebug() << "Downloaded" << tileCount << "tiles in" << msecs << "msecs," << (msecs ? (tileCount * 1000) / msecs : tileCount * 1000) << "tiles/sec"
+             << "over" << _connectionCount << "connections";
+
+    QCOMPARE(failedSpy.count(), 0);
+    QCOMPARE(_requestCount, tileCount);
+    QVERIFY(downloader.idle());
+    QCOMPARE(downloadedSpy[0][1].toByteArray().left(4), QByteArray("\x89PNG", 4));
+
+    // Connections are kept alive and reused, not opened per tile
+    QVERIFY(_connectionCount <= 6);
+
+    // The rate readout goes back to 0 once idle
+    QTRY_COMPARE_WITH_TIMEOUT(downloader.tilesPerSecond(), 0.0, 5000);
+    QVERIFY(rateSpy.count() > 0);
+}
+
+void QGCTileDownloaderTest::_error_test(void)
+{
+    QGCTileDownloader downloader;
+    downloader.setUrlTemplate(_url());
+    QSignalSpy downloadedSpy(&downloader, &QGCTileDownloader::tileDownloaded);
+    QSignalSpy failedSpy(&downloader, &QGCTileDownloader::tileFailed);
+
+    QList<QGCTile*> tiles = _tiles(1, 0);
+    QString missingHash = tiles[0]->hash();
+    downloader.enqueue(tiles + _tiles(10, 17));
+
+    QTRY_COMPARE_WITH_TIMEOUT(downloadedSpy.count() + failedSpy.count(), 11, 10000);
+    QCOMPARE(failedSpy.count(), 1);
+    QCOMPARE(failedSpy[0][0].toString(), missingHash);
+}
+
+void QGCTileDownloaderTest::_cancel_test(void)
+{
+    QGCTileDownloader downloader;
+    downloader.setUrlTemplate(_url());
+    downloader.setMaxInFlight(10);
+    QSignalSpy downloadedSpy(&downloader, &QGCTileDownloader::tileDownloaded);
+    QSignalSpy failedSpy(&downloader, &QGCTileDownloader::tileFailed);
+
+    downloader.enqueue(_tiles(100, 17));
+    downloader.cancel();
+    QVERIFY(downloader.idle());
+
+    // Aborted requests are not reported as failed tiles
+    QTest::qWait(500);
+    QCOMPARE(downloadedSpy.count(), 0);
+    QCOMPARE(failedSpy.count(), 0);
+}
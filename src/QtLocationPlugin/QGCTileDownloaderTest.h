@@ -0,0 +1,48 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+
+class QGCTile;
+
+/// Tile set downloads against a local stand-in tile server. Results are reported as tiles/sec.
+class QGCTileDownloaderTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTileDownloaderTest(void);
+
+protected slots:
+    void init(void);
+    void cleanup(void);
+
+private slots:
+    void _download_test(void);
+    void _error_test(void);
+    void _cancel_test(void);
+
+    void _newConnection(void);
+    void _readRequests(void);
+
+private:
+    QList<QGCTile*> _tiles  (int count, int zoom);
+    QString         _url    (void) const;
+
+    QTcpServer*                     _server;
+    QHash<QTcpSocket*, QByteArray>  _requestBuffers;
+    int                             _connectionCount;
+    int                             _requestCount;
+};
@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief In-memory LRU tier in front of the map tile database
+ *
+ */
+
+#include "QGCTileMemCache.h"
+#include "QGCMapEngineData.h"
+
+//-----------------------------------------------------------------------------
+QGCTileMemCache::QGCTileMemCache(int maxBytes)
+    : _cache(maxBytes)
+    , _hits(0)
+    , _misses(0)
+    , _evictions(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheTile*
+QGCTileMemCache::find(const QString& hash)
+{
+    QMutexLocker lock(&_mutex);
+    //-- QCache::object() also moves the entry to the front of the LRU list
+    Entry_t* entry = _cache.object(hash);
+    if(!entry) {
+        _misses++;
+        return NULL;
+    }
+    _hits++;
+    return new QGCCacheTile(hash, entry->img, entry->format, entry->type);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemCache::insert(const QString& hash, const QByteArray& img, const QString& format, UrlFactory::MapType type)
+{
+    QMutexLocker lock(&_mutex);
+    if(img.isEmpty() || img.size() > _cache.maxCost()) {
+        return;
+    }
+    Entry_t* entry = new Entry_t;
+    entry->img      = img;
+    entry->format   = format;
+    entry->type     = type;
+    int expectedCount = _cache.count() + (_cache.contains(hash) ? 0 : 1);
+    _cache.insert(hash, entry, img.size());
+    _evictions += expectedCount - _cache.count();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemCache::remove(const QString& hash)
+{
+    QMutexLocker lock(&_mutex);
+    _cache.remove(hash);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemCache::clear()
+{
+    QMutexLocker lock(&_mutex);
+    _cache.clear();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemCache::setMaxBytes(int maxBytes)
+{
+    QMutexLocker lock(&_mutex);
+    int count = _cache.count();
+    _cache.setMaxCost(maxBytes);
+    _evictions += count - _cache.count();
+}
+
+//-----------------------------------------------------------------------------
+QGCTileMemCache::Stats_t
+QGCTileMemCache::stats()
+{
+    QMutexLocker lock(&_mutex);
+    Stats_t stats;
+    stats.hits      = _hits;
+    stats.misses    = _misses;
+    stats.evictions = _evictions;
+    stats.tileCount = _cache.count();
+    stats.bytes     = _cache.totalCost();
+    stats.maxBytes  = _cache.maxCost();
+    return stats;
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief In-memory LRU tier in front of the map tile database
+ *
+ */
+
+#ifndef QGC_TILE_MEM_CACHE_H
+#define QGC_TILE_MEM_CACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include <QByteArray>
+#include <QString>
+
+#include "QGCMapUrlEngine.h"
+
+class QGCCacheTile;
+
+//-----------------------------------------------------------------------------
+/// Byte-bounded, thread-safe LRU of encoded tile images keyed by tile hash. Tiles are
+/// inserted from the worker thread (database hits) and the GUI thread (network downloads)
+/// and looked up before a fetch task is queued to the database worker.
+class QGCTileMemCache
+{
+public:
+    QGCTileMemCache     (int maxBytes = 0);
+
+    struct Stats_t {
+        quint64 hits;
+        quint64 misses;
+        quint64 evictions;
+        int     tileCount;
+        int     bytes;
+        int     maxBytes;
+    };
+
+    /// Returns a new tile (owned by the caller) if hash is cached, NULL otherwise
+    QGCCacheTile*   find        (const QString& hash);
+    void            insert      (const QString& hash, const QByteArray& img, const QString& format, UrlFactory::MapType type);
+    void            remove      (const QString& hash);
+    void            clear       ();
+    /// Sets the byte budget. A budget of 0 disables the cache.
+    void            setMaxBytes (int maxBytes);
+    Stats_t         stats       ();
+
+private:
+    struct Entry_t {
+        QByteArray          img;
+        QString             format;
+        UrlFactory::MapType type;
+    };
+
+    QMutex                      _mutex;
+    QCache<QString, Entry_t>    _cache;     ///< Cost is the image size in bytes
+    quint64                     _hits;
+    quint64                     _misses;
+    quint64                     _evictions;
+};
+
+#endif // QGC_TILE_MEM_CACHE_H
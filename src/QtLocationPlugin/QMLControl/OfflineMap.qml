@@ -459,6 +459,13 @@ QGCView {
                         QGCLabel {  text: qsTr("Downloaded:"); width: infoView._labelWidth; }
                         QGCLabel {  text: (offlineMapView._currentSelection ? offlineMapView._currentSelection.savedTileCountStr : "") + " (" + (offlineMapView._currentSelection ? offlineMapView._currentSelection.savedTileSizeStr : "") + ")"; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
                     }
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        visible:    offlineMapView && offlineMapView._currentSelection && !_defaultSet && offlineMapView._currentSelection.downloading
+                        QGCLabel {  text: qsTr("Rate:"); width: infoView._labelWidth; }
+                        QGCLabel {  text: offlineMapView._currentSelection ? qsTr("%1 tiles/s").arg(offlineMapView._currentSelection.downloadRate.toFixed(0)) : ""; horizontalAlignment: Text.AlignRight; width: infoView._valueWidth; }
+                    }
                     Row {
                         spacing:    ScreenTools.defaultFontPixelWidth
                         anchors.horizontalCenter: parent.horizontalCenter
@@ -1076,6 +1083,11 @@ QGCView {
                         value:          QGroundControl.mapEngineManager.actionProgress
                         anchors.horizontalCenter: parent.horizontalCenter
                     }
+                    QGCLabel {
+                        text:           qsTr("%1 tiles/sec").arg(QGroundControl.mapEngineManager.actionThroughput.toFixed(0))
+                        visible:        QGroundControl.mapEngineManager ? QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionExporting : false
+                        anchors.horizontalCenter: parent.horizontalCenter
+                    }
                     BusyIndicator {
                         visible:        QGroundControl.mapEngineManager ? QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionExporting : false
                         running:        QGroundControl.mapEngineManager ? QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionExporting : false
@@ -1140,6 +1152,11 @@ QGCView {
                         value:          QGroundControl.mapEngineManager.actionProgress
                         anchors.horizontalCenter: parent.horizontalCenter
                     }
+                    QGCLabel {
+                        text:           qsTr("%1 tiles/sec").arg(QGroundControl.mapEngineManager.actionThroughput.toFixed(0))
+                        visible:        QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionImporting
+                        anchors.horizontalCenter: parent.horizontalCenter
+                    }
                     BusyIndicator {
                         visible:        QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionImporting
                         running:        QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionImporting
@@ -42,6 +42,7 @@ QGCMapEngineManager::QGCMapEngineManager(QGCApplication* app, QGCToolbox* toolbo
     , _freeDiskSpace(0)
     , _diskSpace(0)
     , _actionProgress(0)
+    , _actionThroughput(0.0)
     , _importAction(ActionNone)
     , _importReplace(false)
 {
@@ -420,9 +421,11 @@ QGCMapEngineManager::importSets(QString path) {
     if(!dir.isEmpty()) {
         _importAction = ActionImporting;
         emit importActionChanged();
+        _actionThroughputHandler(0.0);
         QGCImportTileTask* task = new QGCImportTileTask(dir, _importReplace);
         connect(task, &QGCImportTileTask::actionCompleted, this, &QGCMapEngineManager::_actionCompleted);
         connect(task, &QGCImportTileTask::actionProgress, this, &QGCMapEngineManager::_actionProgressHandler);
+        connect(task, &QGCImportTileTask::actionThroughput, this, &QGCMapEngineManager::_actionThroughputHandler);
         connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
         getQGCMapEngine()->addTask(task);
         return true;
@@ -460,9 +463,11 @@ QGCMapEngineManager::exportSets(QString path) {
         if(sets.count()) {
             _importAction = ActionExporting;
             emit importActionChanged();
+            _actionThroughputHandler(0.0);
             QGCExportTileTask* task = new QGCExportTileTask(sets, dir);
             connect(task, &QGCExportTileTask::actionCompleted, this, &QGCMapEngineManager::_actionCompleted);
             connect(task, &QGCExportTileTask::actionProgress, this, &QGCMapEngineManager::_actionProgressHandler);
+            connect(task, &QGCExportTileTask::actionThroughput, this, &QGCMapEngineManager::_actionThroughputHandler);
             connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
             getQGCMapEngine()->addTask(task);
             return true;
@@ -479,6 +484,14 @@ QGCMapEngineManager::_actionProgressHandler(int percentage)
     emit actionProgressChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::_actionThroughputHandler(double tilesPerSecond)
+{
+    _actionThroughput = tilesPerSecond;
+    emit actionThroughputChanged();
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMapEngineManager::_actionCompleted()
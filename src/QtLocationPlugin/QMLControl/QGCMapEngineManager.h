@@ -56,6 +56,8 @@ public:
     //-- Tile set export
     Q_PROPERTY(int                  selectedCount   READ    selectedCount   NOTIFY selectedCountChanged)
     Q_PROPERTY(int                  actionProgress  READ    actionProgress  NOTIFY actionProgressChanged)
+    //-- Tiles per second copied by the running export or import
+    Q_PROPERTY(double               actionThroughput READ   actionThroughput NOTIFY actionThroughputChanged)
     Q_PROPERTY(ImportAction         importAction    READ    importAction    WRITE  setImportAction   NOTIFY importActionChanged)
 
     Q_PROPERTY(bool                 importReplace   READ    importReplace   WRITE   setImportReplace   NOTIFY importReplaceChanged)
@@ -92,6 +94,7 @@ public:
     quint64                         diskSpace               () { return _diskSpace; }
     int                             selectedCount           ();
     int                             actionProgress          () { return _actionProgress; }
+    double                          actionThroughput        () { return _actionThroughput; }
     ImportAction                    importAction            () { return _importAction; }
     bool                            importReplace           () { return _importReplace; }
 
@@ -118,6 +121,7 @@ signals:
     void freeDiskSpaceChanged   ();
     void selectedCountChanged   ();
     void actionProgressChanged  ();
+    void actionThroughputChanged();
     void importActionChanged    ();
     void importReplaceChanged   ();
 
@@ -132,6 +136,7 @@ private slots:
     void _resetCompleted        ();
     void _actionCompleted       ();
     void _actionProgressHandler (int percentage);
+    void _actionThroughputHandler(double tilesPerSecond);
 
 private:
     void _updateDiskFreeSpace   ();
@@ -150,6 +155,7 @@ private:
     QmlObjectListModel _tileSets;
     QString     _errorMessage;
     int         _actionProgress;
+    double      _actionThroughput;
     ImportAction _importAction;
     bool        _importReplace;
 };
@@ -177,7 +177,15 @@ Vehicle::Vehicle(LinkInterface*             link,
 
     _mavlink = _toolbox->mavlinkProtocol();
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,     this, &Vehicle::_mavlinkMessageReceived);
+    // Only route messages for this vehicle to us, instead of filtering every message from every system.
+    // RADIO_STATUS comes from the radio's own sysid, so we need to see it from all systems.
+    MAVLinkProtocol::MessageHandler messageHandler = [this](LinkInterface* link, const mavlink_message_t& message) {
+        _mavlinkMessageReceived(link, message);
+    };
+    QString subscriberName = QStringLiteral("Vehicle %1").arg(_id);
+    _mavlink->subscribeMessages(this, subscriberName, _id, QList<uint32_t>(), messageHandler);
+    _mavlink->subscribeMessages(this, subscriberName, 0, QList<uint32_t>(), messageHandler);
+    _mavlink->subscribeMessages(this, subscriberName, MAVLinkProtocol::anySystemId, QList<uint32_t>() << MAVLINK_MSG_ID_RADIO_STATUS, messageHandler);
 
     connect(this, &Vehicle::_sendMessageOnLinkOnThread, this, &Vehicle::_sendMessageOnLink, Qt::QueuedConnection);
     connect(this, &Vehicle::flightModeChanged,          this, &Vehicle::_handleFlightModeChanged);
@@ -417,6 +425,10 @@ Vehicle::~Vehicle()
 {
     qCDebug(VehicleLog) << "~Vehicle" << this;
 
+    if (_mavlink) {
+        _mavlink->unsubscribeMessages(this);
+    }
+
     delete _missionManager;
     _missionManager = NULL;
 
@@ -802,7 +802,6 @@ signals:
     void requestProtocolVersion(unsigned version);
 
 private slots:
-    void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
     void _linkInactiveOrDeleted(LinkInterface* link);
     void _sendMessageOnLink(LinkInterface* link, mavlink_message_t message);
     void _sendMessageMultipleNext(void);
@@ -836,6 +835,7 @@ private slots:
     void _updateDistanceToHome(void);
 
 private:
+    void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
     bool _containsLink(LinkInterface* link);
     void _addLink(LinkInterface* link);
     void _loadSettings(void);
@@ -19,11 +19,17 @@
 #include <QSerialPortInfo>
 #include <QDebug>
 #include <QTime>
+#include <QQueue>
 
 #include "QGC.h"
 
 Bootloader::Bootloader(QObject *parent) :
     QObject(parent)
+    , _boardID(0)
+    , _boardFlashSize(0)
+    , _imageCRC(0)
+    , _bootloaderVersion(0)
+    , _pipelineDepth(_defaultPipelineDepth)
 {
 
 }
@@ -66,8 +72,9 @@ bool Bootloader::_read(QextSerialPort* port, uint8_t* data, qint64 maxSize, int
             QGC::SLEEP::usleep(100);
         }
         
+        // Only what is still missing, with commands in flight the following responses may be available already
         qint64 bytesRead;
-        bytesRead = port->read((char*)&data[bytesAlreadyRead], maxSize);
+        bytesRead = port->read((char*)&data[bytesAlreadyRead], maxSize - bytesAlreadyRead);
         
         if (bytesRead == -1) {
             _errorString = tr("Read failed: error: %1").arg(port->errorString());
@@ -189,60 +196,65 @@ bool Bootloader::_binProgram(QextSerialPort* port, const FirmwareImage* image)
     }
     uint32_t imageSize = (uint32_t)firmwareFile.size();
     
-    uint8_t imageBuf[PROG_MULTI_MAX];
+    // PROTO_PROG_MULTI, count, bytes, PROTO_EOC
+    uint8_t commandBuf[PROG_MULTI_MAX + 3];
+    uint8_t* imageBuf = &commandBuf[2];
     uint32_t bytesSent = 0;
+    uint32_t bytesAcked = 0;
+    QQueue<uint32_t> blocksInFlight;    // Address of each block waiting for its response
     _imageCRC = 0;
     
     Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
     
-    while (bytesSent < imageSize) {
-        int bytesToSend = imageSize - bytesSent;
-        if (bytesToSend > (int)sizeof(imageBuf)) {
-            bytesToSend = (int)sizeof(imageBuf);
-        }
-        
-        Q_ASSERT((bytesToSend % 4) == 0);
-        
-        int bytesRead = firmwareFile.read((char *)imageBuf, bytesToSend);
-        if (bytesRead == -1 || bytesRead != bytesToSend) {
-            _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
-            return false;
-        }
-        
-        Q_ASSERT(bytesToSend <= 0x8F);
-        
-        bool failed = true;
-        if (_write(port, PROTO_PROG_MULTI)) {
-            if (_write(port, (uint8_t)bytesToSend)) {
-                if (_write(port, imageBuf, bytesToSend)) {
-                    if (_write(port, PROTO_EOC)) {
-                        port->flush();
-                        if (_getCommandResponse(port)) {
-                            failed = false;
-                        }
-                    }
-                }
+    // Blocks are sent ahead of their responses, up to the pipeline depth. The bootloader handles commands in order
+    // and USB flow controls the ones it has not gotten to yet, so round trips overlap instead of adding up.
+    while (bytesAcked < imageSize) {
+        while (bytesSent < imageSize && blocksInFlight.count() < _pipelineDepth) {
+            int bytesToSend = imageSize - bytesSent;
+            if (bytesToSend > PROG_MULTI_MAX) {
+                bytesToSend = PROG_MULTI_MAX;
             }
+            
+            Q_ASSERT((bytesToSend % 4) == 0);
+            
+            int bytesRead = firmwareFile.read((char *)imageBuf, bytesToSend);
+            if (bytesRead == -1 || bytesRead != bytesToSend) {
+                _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
+                return false;
+            }
+            
+            Q_ASSERT(bytesToSend <= 0x8F);
+            
+            commandBuf[0] = PROTO_PROG_MULTI;
+            commandBuf[1] = (uint8_t)bytesToSend;
+            commandBuf[bytesToSend + 2] = PROTO_EOC;
+            if (!_write(port, commandBuf, bytesToSend + 3)) {
+                _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+                return false;
+            }
+            
+            // Calculate the CRC now so we can test it after the board is flashed.
+            _imageCRC = QGC::crc32(imageBuf, bytesToSend, _imageCRC);
+            
+            blocksInFlight.enqueue(bytesSent);
+            bytesSent += bytesToSend;
         }
-        if (failed) {
-            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+        port->flush();
+        
+        uint32_t blockAddress = blocksInFlight.dequeue();
+        if (!_getCommandResponse(port)) {
+            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(blockAddress, 8, 16, QLatin1Char('0'));
             return false;
         }
+        bytesAcked = blocksInFlight.isEmpty() ? bytesSent : blocksInFlight.head();
         
-        bytesSent += bytesToSend;
-        
-        // Calculate the CRC now so we can test it after the board is flashed.
-        _imageCRC = QGC::crc32((uint8_t *)imageBuf, bytesToSend, _imageCRC);
-        
-        emit updateProgress(bytesSent, imageSize);
+        emit updateProgress(bytesAcked, imageSize);
     }
     firmwareFile.close();
     
     // We calculate the CRC using the entire flash size, filling the remainder with 0xFF.
-    while (bytesSent < _boardFlashSize) {
-        const uint8_t fill = 0xFF;
-        _imageCRC = QGC::crc32(&fill, 1, _imageCRC);
-        bytesSent++;
+    if (bytesSent < _boardFlashSize) {
+        _imageCRC = QGC::crc32Fill(0xFF, _boardFlashSize - bytesSent, _imageCRC);
     }
     
     return true;
@@ -365,17 +377,35 @@ bool Bootloader::_binVerifyBytes(QextSerialPort* port, const FirmwareImage* imag
     
     uint8_t fileBuf[READ_MULTI_MAX];
     uint8_t readBuf[READ_MULTI_MAX];
+    uint32_t bytesRequested = 0;
     uint32_t bytesVerified = 0;
+    QQueue<int> readsInFlight;          // Byte count of each read waiting for its response
     
     Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
     
+    // Reads are requested ahead of their responses the same way blocks are programmed
     while (bytesVerified < imageSize) {
-        int bytesToRead = imageSize - bytesVerified;
-        if (bytesToRead > (int)sizeof(readBuf)) {
-            bytesToRead = (int)sizeof(readBuf);
+        while (bytesRequested < imageSize && readsInFlight.count() < _pipelineDepth) {
+            int bytesToRead = imageSize - bytesRequested;
+            if (bytesToRead > (int)sizeof(readBuf)) {
+                bytesToRead = (int)sizeof(readBuf);
+            }
+            
+            Q_ASSERT((bytesToRead % 4) == 0);
+            Q_ASSERT(bytesToRead <= 0x8F);
+            
+            uint8_t commandBuf[3] = { PROTO_READ_MULTI, (uint8_t)bytesToRead, PROTO_EOC };
+            if (!_write(port, commandBuf, sizeof(commandBuf))) {
+                _errorString = tr("Read failed: %1 at address: 0x%2").arg(_errorString).arg(bytesRequested, 8, 16, QLatin1Char('0'));
+                return false;
+            }
+            
+            readsInFlight.enqueue(bytesToRead);
+            bytesRequested += bytesToRead;
         }
+        port->flush();
         
-        Q_ASSERT((bytesToRead % 4) == 0);
+        int bytesToRead = readsInFlight.dequeue();
         
         int bytesRead = firmwareFile.read((char *)fileBuf, bytesToRead);
         if (bytesRead == -1 || bytesRead != bytesToRead) {
@@ -383,20 +413,7 @@ bool Bootloader::_binVerifyBytes(QextSerialPort* port, const FirmwareImage* imag
             return false;
         }
         
-        Q_ASSERT(bytesToRead <= 0x8F);
-        
-        bool failed = true;
-        if (_write(port, PROTO_READ_MULTI) &&
-            _write(port, (uint8_t)bytesToRead) &&
-            _write(port, PROTO_EOC)) {
-            port->flush();
-            if (_read(port, readBuf, bytesToRead)) {
-                if (_getCommandResponse(port)) {
-                    failed = false;
-                }
-            }
-        }
-        if (failed) {
+        if (!_read(port, readBuf, bytesToRead) || !_getCommandResponse(port)) {
             _errorString = tr("Read failed: %1 at address: 0x%2").arg(_errorString).arg(bytesVerified, 8, 16, QLatin1Char('0'));
             return false;
         }
@@ -60,6 +60,10 @@ public:
     /// @brief Sends a PROTO_REBOOT command to the bootloader
     bool reboot(QextSerialPort* port);
     
+    /// @brief Sets how many PROTO_PROG_MULTI/PROTO_READ_MULTI commands .bin programming and verification keep
+    ///         in flight ahead of their responses. 1 waits for each response before sending the next command.
+    void setPipelineDepth(int depth) { _pipelineDepth = qMax(depth, 1); }
+    
     // Supported bootloader board ids
     static const int boardIDPX4FMUV1 = 5;       ///< PX4 V1 board, as from USB PID
     static const int boardIDPX4FMUV2 = 9;       ///< PX4 V2 board, as from USB PID
@@ -141,6 +145,7 @@ private:
     uint32_t    _boardFlashSize;    ///< flash size for currently connected board
     uint32_t    _imageCRC;          ///< CRC for image in currently selected firmware file
     uint32_t    _bootloaderVersion; ///< Bootloader version
+    int         _pipelineDepth;     ///< Commands sent ahead of their responses while programming/verifying .bin images
     
     QString _firmwareFilename;      ///< Currently selected firmware file to flash
     
@@ -153,6 +158,7 @@ private:
     static const int _responseTimeout = 2000;               ///< Msecs to wait for command response bytes
     static const int _flashSizeSmall = 1032192;             ///< Flash size for boards with silicon error
     static const int _bootloaderVersionV2CorrectFlash = 5;  ///< Anything below this bootloader version on V2 boards cannot trust flash size
+    static const int _defaultPipelineDepth = 8;             ///< Keeps the bytes in flight well below the serial driver buffers
 };
 
 #endif // PX4FirmwareUpgrade_H
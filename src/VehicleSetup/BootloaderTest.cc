@@ -0,0 +1,448 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "BootloaderTest.h"
+#include "Bootloader.h"
+#include "FirmwareImage.h"
+#include "QGC.h"
+
+#include <QThread>
+#include <QQueue>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+/// Emulates a PX4 bootloader on the master side of a pty pair. Each response goes out a fixed latency after its
+/// command came in, the way USB round trips delay them, while the commands behind it keep being taken in.
+class MockBootloader : public QThread
+{
+public:
+    MockBootloader(uint32_t flashSize, uint32_t bootloaderVersion, int latencyUsecs)
+        : _master(-1)
+        , _slave(-1)
+        , _bootloaderVersion(bootloaderVersion)
+        , _latencyNsecs((qint64)latencyUsecs * 1000)
+        , _address(0)
+        , _failAddress(0xFFFFFFFF)
+        , _corruptAddress(0xFFFFFFFF)
+    {
+        _flash.fill((char)0xFF, flashSize);
+
+        _master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (_master == -1 || grantpt(_master) != 0 || unlockpt(_master) != 0) {
+            _close();
+            return;
+        }
+        _portName = QString::fromLocal8Bit(ptsname(_master));
+
+        // Keeps the pty alive across the port being closed and opened, raw until the port configures it
+        _slave = ::open(ptsname(_master), O_RDWR | O_NOCTTY);
+        struct termios settings;
+        if (_slave == -1 || tcgetattr(_slave, &settings) != 0) {
+            _close();
+            return;
+        }
+        cfmakeraw(&settings);
+        tcsetattr(_slave, TCSANOW, &settings);
+        fcntl(_master, F_SETFL, fcntl(_master, F_GETFL) | O_NONBLOCK);
+    }
+
+    ~MockBootloader()
+    {
+        stop();
+        _close();
+    }
+
+    bool        isValid         (void) const { return _master != -1; }
+    QString     portName        (void) const { return _portName; }
+    QByteArray  flash           (void) const { return _flash; }
+
+    /// Answers the PROTO_PROG_MULTI for this address with PROTO_FAILED
+    void        failProgramAt   (uint32_t address) { _failAddress = address; }
+    /// Flips the bits of the byte programmed at this address
+    void        corruptAt       (uint32_t address) { _corruptAddress = address; }
+
+    void stop(void)
+    {
+        _stop.store(1);
+        wait();
+    }
+
+protected:
+    void run(void)
+    {
+        QElapsedTimer clock;
+        clock.start();
+        QByteArray rxBuffer;
+
+        while (!_stop.load()) {
+            bool idle = true;
+
+            char buf[4096];
+            ssize_t bytesRead = ::read(_master, buf, sizeof(buf));
+            if (bytesRead > 0) {
+                rxBuffer.append(buf, (int)bytesRead);
+                idle = false;
+            }
+
+            QByteArray response;
+            while (_processCommand(rxBuffer, response)) {
+                if (!response.isEmpty()) {
+                    Response_t pending = { clock.nsecsElapsed() + _latencyNsecs, response };
+                    _responses.enqueue(pending);
+                }
+                response.clear();
+            }
+
+            while (!_responses.isEmpty() && _responses.head().dueNsecs <= clock.nsecsElapsed()) {
+                QByteArray bytes = _responses.dequeue().bytes;
+                if (::write(_master, bytes.constData(), bytes.size()) != bytes.size()) {
+                    qWarning() << "MockBootloader: write failed";
+                }
+                idle = false;
+            }
+
+            if (idle) {
+                QThread::usleep(20);
+            }
+        }
+    }
+
+private:
+    typedef struct {
+        qint64      dueNsecs;
+        QByteArray  bytes;
+    } Response_t;
+
+    enum {
+        PROTO_INSYNC =      0x12,
+        PROTO_EOC =         0x20,
+        PROTO_OK =          0x10,
+        PROTO_FAILED =      0x11,
+        PROTO_INVALID =     0x13,
+        PROTO_GET_SYNC =    0x21,
+        PROTO_GET_DEVICE =  0x22,
+        PROTO_CHIP_ERASE =  0x23,
+        PROTO_CHIP_VERIFY = 0x24,
+        PROTO_PROG_MULTI =  0x27,
+        PROTO_READ_MULTI =  0x28,
+        PROTO_GET_CRC =     0x29,
+        PROTO_BOOT =        0x30,
+    };
+
+    static void _appendWord(QByteArray& bytes, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++) {
+            bytes.append((char)((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+    static void _appendStatus(QByteArray& bytes, uint8_t status)
+    {
+        bytes.append((char)PROTO_INSYNC);
+        bytes.append((char)status);
+    }
+
+    /// Takes the next complete command off the buffer
+    ///     @param[out] response Bytes to send back, empty for none
+    /// @return false: no complete command in buffer
+    bool _processCommand(QByteArray& rxBuffer, QByteArray& response)
+    {
+        if (rxBuffer.isEmpty()) {
+            return false;
+        }
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(rxBuffer.constData());
+        int length = 2;
+        switch (data[0]) {
+        case PROTO_GET_DEVICE:
+        case PROTO_READ_MULTI:
+            length = 3;
+            break;
+        case PROTO_PROG_MULTI:
+            if (rxBuffer.size() < 2) {
+                return false;
+            }
+            length = data[1] + 3;
+            break;
+        case PROTO_GET_SYNC:
+        case PROTO_CHIP_ERASE:
+        case PROTO_CHIP_VERIFY:
+        case PROTO_GET_CRC:
+        case PROTO_BOOT:
+            break;
+        default:
+            rxBuffer.remove(0, 1);
+            _appendStatus(response, PROTO_INVALID);
+            return true;
+        }
+        if (rxBuffer.size() < length) {
+            return false;
+        }
+        if (data[length - 1] != PROTO_EOC) {
+            rxBuffer.remove(0, 1);
+            _appendStatus(response, PROTO_INVALID);
+            return true;
+        }
+
+        uint8_t status = PROTO_OK;
+        switch (data[0]) {
+        case PROTO_GET_DEVICE:
+            switch (data[1]) {
+            case 1:
+                _appendWord(response, _bootloaderVersion);
+                break;
+            case 2:
+                _appendWord(response, Bootloader::boardIDPX4FMUV4);
+                break;
+            case 4:
+                _appendWord(response, _flash.size());
+                break;
+            default:
+                status = PROTO_INVALID;
+                break;
+            }
+            break;
+        case PROTO_CHIP_ERASE:
+            _flash.fill((char)0xFF);
+            _address = 0;
+            break;
+        case PROTO_CHIP_VERIFY:
+            _address = 0;
+            break;
+        case PROTO_PROG_MULTI:
+            if (_address == _failAddress || _address + data[1] > (uint32_t)_flash.size()) {
+                status = PROTO_FAILED;
+            } else {
+                for (int i = 0; i < data[1]; i++) {
+                    _flash[_address + i] = (char)(_address + i == _corruptAddress ? ~data[2 + i] : data[2 + i]);
+                }
+                _address += data[1];
+            }
+            break;
+        case PROTO_READ_MULTI:
+            if (_address + data[1] > (uint32_t)_flash.size()) {
+                status = PROTO_FAILED;
+            } else {
+                response.append(_flash.mid(_address, data[1]));
+                _address += data[1];
+            }
+            break;
+        case PROTO_GET_CRC:
+            _appendWord(response, QGC::crc32(reinterpret_cast<const quint8*>(_flash.constData()), _flash.size(), 0));
+            break;
+        case PROTO_BOOT:
+            rxBuffer.remove(0, length);
+            return true;
+        default:
+            break;
+        }
+        _appendStatus(response, status);
+
+        rxBuffer.remove(0, length);
+        return true;
+    }
+
+    void _close(void)
+    {
+        if (_slave != -1) {
+            ::close(_slave);
+            _slave = -1;
+        }
+        if (_master != -1) {
+            ::close(_master);
+            _master = -1;
+        }
+    }
+
+    int                 _master;
+    int                 _slave;
+    QString             _portName;
+    QByteArray          _flash;
+    uint32_t            _bootloaderVersion;
+    qint64              _latencyNsecs;
+    uint32_t            _address;
+    uint32_t            _failAddress;
+    uint32_t            _corruptAddress;
+    QQueue<Response_t>  _responses;
+    QAtomicInt          _stop;
+};
+#endif
+
+BootloaderTest::BootloaderTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void BootloaderTest::initTestCase(void)
+{
+    UnitTest::initTestCase();
+
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+
+    qsrand(1);
+    _imageBytes.resize(_imageSize);
+    for (int i = 0; i < _imageBytes.size(); i++) {
+        _imageBytes[i] = (char)(qrand() & 0xFF);
+    }
+    _imageFile = _tempDir->path() + QStringLiteral("/image.bin");
+    QFile file(_imageFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(_imageBytes), (qint64)_imageBytes.size());
+}
+
+void BootloaderTest::cleanupTestCase(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanupTestCase();
+}
+
+void BootloaderTest::_program_test_data(void)
+{
+    QTest::addColumn<int>("pipelineDepth");
+    QTest::addColumn<int>("bootloaderVersion");
+
+    QTest::newRow("Lockstep, CRC verify") << 1 << 5;
+    QTest::newRow("Pipelined, CRC verify") << 8 << 5;
+    QTest::newRow("Lockstep, read back verify") << 1 << 2;
+    QTest::newRow("Pipelined, read back verify") << 8 << 2;
+}
+
+/// Same sequence as PX4FirmwareUpgradeThread: sync, board info, erase, program, verify
+void BootloaderTest::_program_test(void)
+{
+#ifdef Q_OS_UNIX
+    QFETCH(int, pipelineDepth);
+    QFETCH(int, bootloaderVersion);
+
+    MockBootloader mock(_flashSize, bootloaderVersion, _latencyUsecs);
+    QVERIFY(mock.isValid());
+    mock.start();
+
+    FirmwareImage image;
+    QVERIFY(image.load(_imageFile, Bootloader::boardIDPX4FMUV4));
+
+    QextSerialPort port(QextSerialPort::Polling);
+    Bootloader bootloader;
+    bootloader.setPipelineDepth(pipelineDepth);
+    QVERIFY2(bootloader.open(&port, mock.portName()), qPrintable(bootloader.errorString()));
+    QVERIFY2(bootloader.sync(&port), qPrintable(bootloader.errorString()));
+
+    uint32_t version, boardID, flashSize;
+    QVERIFY2(bootloader.getPX4BoardInfo(&port, version, boardID, flashSize), qPrintable(bootloader.errorString()));
+    QCOMPARE(version, (uint32_t)bootloaderVersion);
+    QCOMPARE(flashSize, (uint32_t)_flashSize);
+    QVERIFY2(bootloader.erase(&port), qPrintable(bootloader.errorString()));
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY2(bootloader.program(&port, &image), qPrintable(bootloader.errorString()));
+    qint64 programMsecs = timer.restart();
+    QVERIFY2(bootloader.verify(&port, &image), qPrintable(bootloader.errorString()));
+    qint64 verifyMsecs = timer.elapsed();
+    qDebug() << "Program" << _imageSize << "bytes in" << programMsecs << "msecs, verify in" << verifyMsecs << "msecs";
+
+    port.close();
+    mock.stop();
+    QCOMPARE(mock.flash().left(_imageSize), _imageBytes);
+    QCOMPARE(mock.flash().mid(_imageSize), QByteArray(_flashSize - _imageSize, (char)0xFF));
+#else
+    QSKIP("Bootloader emulator needs a pty");
+#endif
+}
+
+/// A failed block is reported at its own address, not at the address of the last block sent
+void BootloaderTest::_programFailure_test(void)
+{
+#ifdef Q_OS_UNIX
+    const uint32_t failAddress = 0x1000;
+
+    MockBootloader mock(_flashSize, 5, _latencyUsecs);
+    QVERIFY(mock.isValid());
+    mock.failProgramAt(failAddress);
+    mock.start();
+
+    FirmwareImage image;
+    QVERIFY(image.load(_imageFile, Bootloader::boardIDPX4FMUV4));
+
+    QextSerialPort port(QextSerialPort::Polling);
+    Bootloader bootloader;
+    QVERIFY(bootloader.open(&port, mock.portName()));
+    QVERIFY(bootloader.sync(&port));
+    uint32_t version, boardID, flashSize;
+    QVERIFY(bootloader.getPX4BoardInfo(&port, version, boardID, flashSize));
+    QVERIFY(bootloader.erase(&port));
+
+    QVERIFY(!bootloader.program(&port, &image));
+    QVERIFY2(bootloader.errorString().contains(QString("PROTO_FAILED")), qPrintable(bootloader.errorString()));
+    QVERIFY2(bootloader.errorString().contains(QString("0x%1").arg(failAddress, 8, 16, QLatin1Char('0'))), qPrintable(bootloader.errorString()));
+
+    port.close();
+#else
+    QSKIP("Bootloader emulator needs a pty");
+#endif
+}
+
+void BootloaderTest::_verifyFailure_test_data(void)
+{
+    QTest::addColumn<int>("bootloaderVersion");
+    QTest::addColumn<QString>("error");
+
+    QTest::newRow("CRC verify") << 5 << QString("CRC mismatch");
+    QTest::newRow("Read back verify") << 2 << QString("Compare failed");
+}
+
+/// A byte that did not make it into flash is caught by either way of verifying
+void BootloaderTest::_verifyFailure_test(void)
+{
+#ifdef Q_OS_UNIX
+    QFETCH(int, bootloaderVersion);
+    QFETCH(QString, error);
+
+    const uint32_t corruptAddress = _imageSize / 2 + 5;
+
+    MockBootloader mock(_flashSize, bootloaderVersion, _latencyUsecs);
+    QVERIFY(mock.isValid());
+    mock.corruptAt(corruptAddress);
+    mock.start();
+
+    FirmwareImage image;
+    QVERIFY(image.load(_imageFile, Bootloader::boardIDPX4FMUV4));
+
+    QextSerialPort port(QextSerialPort::Polling);
+    Bootloader bootloader;
+    QVERIFY(bootloader.open(&port, mock.portName()));
+    QVERIFY(bootloader.sync(&port));
+    uint32_t version, boardID, flashSize;
+    QVERIFY(bootloader.getPX4BoardInfo(&port, version, boardID, flashSize));
+    QVERIFY(bootloader.erase(&port));
+    QVERIFY2(bootloader.program(&port, &image), qPrintable(bootloader.errorString()));
+
+    QVERIFY(!bootloader.verify(&port, &image));
+    QVERIFY2(bootloader.errorString().contains(error), qPrintable(bootloader.errorString()));
+    if (bootloaderVersion <= 2) {
+        QVERIFY2(bootloader.errorString().contains(QString("0x%1").arg(corruptAddress, 8, 16, QLatin1Char('0'))), qPrintable(bootloader.errorString()));
+    }
+
+    port.close();
+#else
+    QSKIP("Bootloader emulator needs a pty");
+#endif
+}
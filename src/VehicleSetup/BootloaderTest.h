@@ -0,0 +1,48 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef BootloaderTest_H
+#define BootloaderTest_H
+
+#include "UnitTest.h"
+
+#include <QByteArray>
+#include <QTemporaryDir>
+
+/// Programs and verifies .bin images through Bootloader against a bootloader emulator on a pty pair. The timed
+/// tests compare waiting for each command response with keeping commands in flight.
+class BootloaderTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    BootloaderTest(void);
+
+private slots:
+    void initTestCase(void);
+    void cleanupTestCase(void);
+
+    void _program_test(void);
+    void _program_test_data(void);
+    void _programFailure_test(void);
+    void _verifyFailure_test(void);
+    void _verifyFailure_test_data(void);
+
+private:
+    QTemporaryDir*  _tempDir;
+    QString         _imageFile;
+    QByteArray      _imageBytes;
+
+    static const int _imageSize =       128 * 1024;
+    static const int _flashSize =       1024 * 1024;
+    static const int _latencyUsecs =    1000;           ///< Round trip of a USB full speed frame
+};
+
+#endif
@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "LogReplayIndex.h"
+#include "MAVLinkProtocol.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+
+#include <algorithm>
+
+LogReplayIndex::LogReplayIndex(void)
+{
+
+}
+
+QString LogReplayIndex::indexFilename(const QString& logFilename)
+{
+    return logFilename + QStringLiteral(".idx");
+}
+
+quint64 LogReplayIndex::parseTimestamp(const char* bytes)
+{
+    quint64 timestamp = qFromBigEndian<quint64>((const uchar*)bytes);
+    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > currentTimestamp) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+/// Checks for a complete MAVLink frame with a valid crc at the start of data
+/// @return Length of the frame, 0 if there isn't a valid frame
+int LogReplayIndex::_frameLength(const char* data, int size)
+{
+    if (size < 1 || ((uint8_t)data[0] != MAVLINK_STX && (uint8_t)data[0] != MAVLINK_STX_MAVLINK1)) {
+        return 0;
+    }
+
+    // The link is replaying on its own mavlink channel while we scan, so parse into private buffers
+    mavlink_message_t   rxMessage;
+    mavlink_status_t    rxStatus;
+    mavlink_message_t   message;
+    mavlink_status_t    status;
+    memset(&rxStatus, 0, sizeof(rxStatus));
+    rxMessage.len = 0;
+
+    for (int i=0; i<size && i<MAVLINK_MAX_PACKET_LEN; i++) {
+        uint8_t result = mavlink_frame_char_buffer(&rxMessage, &rxStatus, (uint8_t)data[i], &message, &status);
+        if (result == MAVLINK_FRAMING_OK) {
+            return i + 1;
+        } else if (result != MAVLINK_FRAMING_INCOMPLETE || rxStatus.parse_state <= MAVLINK_PARSE_STATE_IDLE) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+bool LogReplayIndex::build(const QString& logFilename, const QAtomicInt& abort)
+{
+    QFile logFile(logFilename);
+
+    _entries.clear();
+    if (!logFile.open(QFile::ReadOnly)) {
+        qWarning() << "Unable to open log for indexing" << logFilename << logFile.errorString();
+        return false;
+    }
+
+    // A tlog is a sequence of [timestamp][frame]. Walk it record by record, which also keeps timestamp
+    // bytes which happen to look like a start of frame from being taken for one. On garbage, resync
+    // on the next start of frame marker.
+    const int   chunkSize = 1024 * 1024;
+    const int   maxRecordSize = cbTimestamp + MAVLINK_MAX_PACKET_LEN;
+    QByteArray  buffer;
+    qint64      bufferStart = 0;    ///< File offset of buffer[0]
+    int         pos = 0;
+
+    while (true) {
+        if (buffer.size() - pos < maxRecordSize && !logFile.atEnd()) {
+            if (abort.load()) {
+                _entries.clear();
+                return false;
+            }
+            buffer = buffer.mid(pos) + logFile.read(chunkSize);
+            bufferStart += pos;
+            pos = 0;
+        }
+
+        const char* data = buffer.constData();
+        int         available = buffer.size() - pos;
+        if (available <= cbTimestamp) {
+            break;
+        }
+
+        int frameLength = _frameLength(data + pos + cbTimestamp, available - cbTimestamp);
+        if (frameLength) {
+            // Timestamps which go backwards are skipped so the entries stay sorted
+            quint64 timeUSecs = parseTimestamp(data + pos);
+            if (_entries.isEmpty() || timeUSecs >= _entries.last().timeUSecs + _entryIntervalUSecs) {
+                Entry_t entry;
+                entry.timeUSecs = timeUSecs;
+                entry.offset = bufferStart + pos;
+                _entries.append(entry);
+            }
+            pos += cbTimestamp + frameLength;
+        } else {
+            int stx = MAVLinkProtocol::findNextStx(data, pos + cbTimestamp + 1, buffer.size());
+            if (stx == buffer.size()) {
+                // Keep the tail, a frame may start right after it
+                pos = buffer.size() - cbTimestamp;
+                if (logFile.atEnd()) {
+                    break;
+                }
+            } else {
+                pos = stx - cbTimestamp;
+            }
+        }
+    }
+
+    return true;
+}
+
+qint64 LogReplayIndex::findOffset(quint64 timeUSecs) const
+{
+    // First entry past the requested time, the one before it is where the scan starts
+    QVector<Entry_t>::const_iterator it = std::upper_bound(_entries.constBegin(), _entries.constEnd(), timeUSecs,
+                                                           [](quint64 time, const Entry_t& entry) { return time < entry.timeUSecs; });
+    if (it == _entries.constBegin()) {
+        return _entries.isEmpty() ? -1 : _entries.first().offset;
+    }
+    return (it - 1)->offset;
+}
+
+bool LogReplayIndex::load(const QString& logFilename)
+{
+    QFileInfo   logInfo(logFilename);
+    QFile       indexFile(indexFilename(logFilename));
+
+    _entries.clear();
+    if (!indexFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&indexFile);
+    quint32     magic, version, count;
+    qint64      logSize, logModified;
+
+    stream >> magic >> version >> logSize >> logModified >> count;
+    if (stream.status() != QDataStream::Ok || magic != _fileMagic || version != _fileVersion) {
+        return false;
+    }
+    if (logSize != logInfo.size() || logModified != logInfo.lastModified().toMSecsSinceEpoch()) {
+        // Log has been changed since the index was built
+        return false;
+    }
+    if ((qint64)count * (qint64)sizeof(Entry_t) > indexFile.size()) {
+        return false;
+    }
+
+    _entries.resize(count);
+    for (quint32 i=0; i<count; i++) {
+        stream >> _entries[i].timeUSecs >> _entries[i].offset;
+    }
+    if (stream.status() != QDataStream::Ok) {
+        _entries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool LogReplayIndex::save(const QString& logFilename) const
+{
+    QFileInfo   logInfo(logFilename);
+    QFile       indexFile(indexFilename(logFilename));
+
+    if (!indexFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        // Not fatal, the log may be in a read-only location. We'll just have to build it again next time.
+        qWarning() << "Unable to save log index" << indexFile.fileName() << indexFile.errorString();
+        return false;
+    }
+
+    QDataStream stream(&indexFile);
+    stream << _fileMagic << _fileVersion << (qint64)logInfo.size() << (qint64)logInfo.lastModified().toMSecsSinceEpoch() << (quint32)_entries.count();
+    for (int i=0; i<_entries.count(); i++) {
+        stream << _entries[i].timeUSecs << _entries[i].offset;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,67 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef LogReplayIndex_H
+#define LogReplayIndex_H
+
+#include <QString>
+#include <QVector>
+#include <QAtomicInt>
+
+/// Sparse timestamp to file offset index for timestamped (.tlog) MAVLink logs. Each entry points at the
+/// timestamp which precedes a MAVLink message, with entries spaced at least _entryIntervalUSecs apart.
+/// The index is saved next to the log so it only has to be built once per log.
+class LogReplayIndex
+{
+public:
+    LogReplayIndex(void);
+
+    typedef struct {
+        quint64 timeUSecs;  ///< Timestamp of the message
+        qint64  offset;     ///< File offset of the timestamp which precedes the message
+    } Entry_t;
+
+    /// Loads a previously saved index
+    /// @return false: no index saved, or the log has changed since it was saved
+    bool load(const QString& logFilename);
+
+    /// Saves the index next to the log
+    bool save(const QString& logFilename) const;
+
+    /// Scans the log and builds the index
+    ///     @param abort Set to non-zero from another thread to stop the scan
+    /// @return false: log could not be read, or the scan was aborted
+    bool build(const QString& logFilename, const QAtomicInt& abort);
+
+    /// @return File offset of the last entry at or before timeUSecs, -1 if there is none
+    qint64 findOffset(quint64 timeUSecs) const;
+
+    int count(void) const { return _entries.count(); }
+
+    /// @return Filename the index for logFilename is saved to
+    static QString indexFilename(const QString& logFilename);
+
+    /// Parses a tlog timestamp
+    /// @return A Unix timestamp in microseconds UTC
+    static quint64 parseTimestamp(const char* bytes);
+
+    static const int cbTimestamp = sizeof(quint64);
+
+private:
+    static int _frameLength(const char* data, int size);
+
+    QVector<Entry_t>    _entries;
+
+    static const quint64    _entryIntervalUSecs = 250000;
+    static const quint32    _fileMagic = 0x51474349;    ///< "QGCI"
+    static const quint32    _fileVersion = 1;
+};
+
+#endif
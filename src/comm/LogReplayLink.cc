@@ -11,9 +11,14 @@
 #include "LogReplayLink.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
+#include "QGCLoggingCategory.h"
 
 #include <QFileInfo>
 #include <QtEndian>
+#include <QtConcurrent>
+#include <QElapsedTimer>
+
+QGC_LOGGING_CATEGORY(LogReplayLinkLog, "LogReplayLinkLog")
 
 const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
 
@@ -116,6 +121,10 @@ bool LogReplayLink::_connect(void)
 
 void LogReplayLink::_disconnect(void)
 {
+    // Stop any index build which is still running against the log
+    _indexAbort.store(1);
+    _indexFuture.waitForFinished();
+
     if (_connected) {
         quit();
         wait();
@@ -164,16 +173,10 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
 /// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
 quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
 {
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
+    if (bytes.size() < cbTimestamp) {
+        return 0;
     }
-    
-    return timestamp;
+    return LogReplayIndex::parseTimestamp(bytes.constData());
 }
 
 /// Reads the next mavlink message from the log
@@ -291,6 +294,10 @@ bool LogReplayLink::_loadLogFile(void)
 
         // Reset our log file so when we go to read it for the first time, we start at the beginning.
         _logFile.reset();
+
+        // The time index used for seeking is loaded or built in the background so playback can start right away
+        _indexAbort.store(0);
+        _indexFuture = QtConcurrent::run(this, &LogReplayLink::_buildIndex, logFilename);
         
         logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
     } else {
@@ -445,6 +452,51 @@ void LogReplayLink::_resetPlaybackToBeginning(void)
     _logCurrentTimeUSecs = _logStartTimeUSecs;
 }
 
+/// Loads the saved time index for the log, or builds and saves it if there isn't one. Runs on a pool thread.
+bool LogReplayLink::_buildIndex(const QString& logFilename)
+{
+    if (_index.load(logFilename)) {
+        qCDebug(LogReplayLinkLog) << "Loaded log index" << _index.count() << "entries";
+        return true;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    if (!_index.build(logFilename, _indexAbort)) {
+        return false;
+    }
+    qCDebug(LogReplayLinkLog) << "Built log index" << _index.count() << "entries in" << timer.elapsed() << "msecs";
+    _index.save(logFilename);
+    return true;
+}
+
+/// Positions the log at the first message at or after the specified time using the time index
+/// @return false: index not available yet
+bool LogReplayLink::_seekToTime(quint64 timeUSecs)
+{
+    if (!_indexFuture.isFinished() || !_indexFuture.result()) {
+        return false;
+    }
+    qint64 offset = _index.findOffset(timeUSecs);
+    if (offset < 0 || !_logFile.seek(offset)) {
+        return false;
+    }
+
+    // Drop any partial message left in the parser from the previous position
+    mavlink_get_channel_status(_mavlinkChannel)->parse_state = MAVLINK_PARSE_STATE_IDLE;
+
+    // Index entries are sparse, scan forward to the exact message
+    _logCurrentTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
+    QByteArray bytes;
+    while (_logCurrentTimeUSecs < timeUSecs) {
+        quint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
+        if (nextTimeUSecs == 0 || _logFile.atEnd()) {
+            break;
+        }
+        _logCurrentTimeUSecs = nextTimeUSecs;
+    }
+    return true;
+}
+
 void LogReplayLink::movePlayhead(int percentComplete)
 {
     if (isPlaying()) {
@@ -459,9 +511,14 @@ void LogReplayLink::movePlayhead(int percentComplete)
     
     float floatPercentComplete = (float)percentComplete / 100.0f;
     
-    if (_logTimestamped) {
-        // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-        // time through the file.
+    if (_logTimestamped && _seekToTime(_logStartTimeUSecs + (quint64)(floatPercentComplete * _logDurationUSecs))) {
+        // Exact jump using the time index
+        float newRelativeTimeUSecs = (float)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+        percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
+        emit playbackPercentCompleteChanged(percentComplete);
+    } else if (_logTimestamped) {
+        // Index isn't ready yet. Aim to hit that percentage in terms of time through the file
+        // by estimating the position from the average data rate.
         qint64 newFilePos = (qint64)(floatPercentComplete * (float)_logFile.size());
         
         // Now seek to the appropriate position, failing gracefully if we can't.
@@ -14,9 +14,15 @@
 #include "LinkInterface.h"
 #include "LinkConfiguration.h"
 #include "MAVLinkProtocol.h"
+#include "LogReplayIndex.h"
 
 #include <QTimer>
 #include <QFile>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayLinkLog)
 
 class LogReplayLinkConfiguration : public LinkConfiguration
 {
@@ -119,6 +125,8 @@ private:
     void _finishPlayback(void);
     void _playbackError(void);
     void _resetPlaybackToBeginning(void);
+    bool _buildIndex(const QString& logFilename);
+    bool _seekToTime(quint64 timeUSecs);
 
     // Virtuals from LinkInterface
     virtual bool _connect(void);
@@ -151,7 +159,11 @@ private:
     quint64             _logFileSize;
     bool                _logTimestamped;    ///< true: Timestamped log format, false: no timestamps
 
-    static const int cbTimestamp = sizeof(quint64);
+    LogReplayIndex      _index;             ///< Only valid once _indexFuture has finished successfully
+    QFuture<bool>       _indexFuture;       ///< Background load/build of _index
+    QAtomicInt          _indexAbort;
+
+    static const int cbTimestamp = LogReplayIndex::cbTimestamp;
 };
 
 #endif
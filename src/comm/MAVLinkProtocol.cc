@@ -24,8 +24,10 @@
 #include <QStandardPaths>
 #include <QtEndian>
 #include <QMetaType>
+#include <QMetaMethod>
 #include <QDir>
 #include <QFileInfo>
+#include <QVarLengthArray>
 
 #include "MAVLinkProtocol.h"
 #include "UASInterface.h"
@@ -63,6 +65,8 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _tempLogFile(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension))
     , _linkMgr(NULL)
     , _multiVehicleManager(NULL)
+    , _lastMessagePoolMessageCount(0)
+    , _lastMessagePoolAllocationCount(0)
 {
     memset(&totalReceiveCounter, 0, sizeof(totalReceiveCounter));
     memset(&totalLossCounter, 0, sizeof(totalLossCounter));
@@ -103,6 +107,7 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+   qRegisterMetaType<SharedMAVLinkMessage>("SharedMAVLinkMessage");
 
    loadSettings();
 
@@ -125,9 +130,31 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
+   // Compare messages copied to receivers against pool allocations once a second
+   _messagePoolStatsElapsed.start();
+   _messagePoolStatsTimer.setInterval(1000);
+   connect(&_messagePoolStatsTimer, &QTimer::timeout, this, &MAVLinkProtocol::_logMessagePoolStats);
+   _messagePoolStatsTimer.start();
+
    emit versionCheckChanged(m_enable_version_check);
 }
 
+void MAVLinkProtocol::_logMessagePoolStats(void)
+{
+    quint64 messageCount =      SharedMAVLinkMessage::messageCount();
+    quint64 allocationCount =   SharedMAVLinkMessage::slotAllocationCount();
+    double  elapsedSecs =       _messagePoolStatsElapsed.restart() / 1000.0;
+
+    if (elapsedSecs > 0 && messageCount != _lastMessagePoolMessageCount) {
+        qCDebug(MAVLinkProtocolLog) << "Shared messages/sec:" << (messageCount - _lastMessagePoolMessageCount) / elapsedSecs
+                                    << "pool allocations/sec:" << (allocationCount - _lastMessagePoolAllocationCount) / elapsedSecs
+                                    << "pool slots:" << allocationCount;
+    }
+
+    _lastMessagePoolMessageCount = messageCount;
+    _lastMessagePoolAllocationCount = allocationCount;
+}
+
 void MAVLinkProtocol::loadSettings()
 {
     // Load defaults from settings
@@ -190,8 +217,15 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
     static bool checkedUserNonMavlink = false;
     static bool warnedUserNonMavlink = false;
 
-    for (int position = 0; position < b.size(); position++) {
-        unsigned int decodeState = mavlink_parse_char(mavlinkChannel, (uint8_t)(b[position]), &message, &status);
+    for (int position = 0; position < b.size(); ) {
+        unsigned int decodeState;
+
+        if (link->decodedFirstMavlinkPacket()) {
+            // Steady state: bytes between frames are skipped in bulk instead of being fed through the parser
+            decodeState = parseNextMessage(mavlinkChannel, b, position, &message, &status) ? 1 : 0;
+        } else {
+            decodeState = mavlink_parse_char(mavlinkChannel, (uint8_t)(b[position++]), &message, &status);
+        }
 
         if (decodeState == 0 && !link->decodedFirstMavlinkPacket())
         {
@@ -337,10 +371,194 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                 emit receiveLossTotalChanged(message.sysid, totalLossCounter[mavlinkChannel]);
             }
 
+            // Subscribers only see the messages they asked for
+            _routeMessage(link, message);
+
             // The packet is emitted as a whole, as it is only 255 - 261 bytes short
             // kind of inefficient, but no issue for a groundstation pc.
             // It buys as reentrancy for the whole code over all threads
             emit messageReceived(link, message);
+
+            // Only fill a pool slot if someone is listening
+            if (isSignalConnected(QMetaMethod::fromSignal(&MAVLinkProtocol::sharedMessageReceived))) {
+                emit sharedMessageReceived(link, SharedMAVLinkMessage(message));
+            }
+        }
+    }
+}
+
+/**
+ * Skips forward to the next MAVLink 1 or 2 start-of-frame marker. Uses memchr so the scan
+ * over non-frame bytes is done by the vectorized libc routine rather than the parser.
+ * @return Index of next marker, or size if none found
+ **/
+int MAVLinkProtocol::findNextStx(const char* data, int from, int size)
+{
+    if (from >= size) {
+        return size;
+    }
+
+    const char* start = data + from;
+    const char* end = data + size;
+
+    const char* stx = (const char*)memchr(start, MAVLINK_STX, end - start);
+    if (!stx) {
+        stx = end;
+    }
+    const char* stx1 = (const char*)memchr(start, MAVLINK_STX_MAVLINK1, stx - start);
+    if (stx1) {
+        stx = stx1;
+    }
+
+    return stx - data;
+}
+
+/**
+ * Feeds bytes to the channel parser until a complete message is decoded or the buffer is used up.
+ * While the parser is idle (between frames) mavlink_parse_char does nothing with bytes other than
+ * a start-of-frame marker, so these are skipped in bulk. Output is identical to feeding every byte.
+ * @param position Index to start at, updated to one past the last byte consumed
+ * @return true: message was decoded
+ **/
+bool MAVLinkProtocol::parseNextMessage(uint8_t channel, const QByteArray& bytes, int& position, mavlink_message_t* message, mavlink_status_t* status)
+{
+    const mavlink_status_t* channelStatus = mavlink_get_channel_status(channel);
+    const char* data = bytes.constData();
+    const int size = bytes.size();
+
+    while (position < size) {
+        if (channelStatus->parse_state == MAVLINK_PARSE_STATE_IDLE || channelStatus->parse_state == MAVLINK_PARSE_STATE_UNINIT) {
+            position = findNextStx(data, position, size);
+            if (position == size) {
+                break;
+            }
+        }
+        if (mavlink_parse_char(channel, (uint8_t)data[position++], message, status) == 1) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MAVLinkProtocol::subscribeMessages(QObject* subscriber, const QString& name, int sysid, const QList<uint32_t>& msgIds, MessageHandler handler)
+{
+    if (sysid != anySystemId && (sysid < 0 || sysid > 255)) {
+        qWarning() << "MAVLinkProtocol::subscribeMessages invalid sysid" << sysid;
+        return;
+    }
+
+    QSharedPointer<MessageSubscriber_t> messageSubscriber;
+    foreach (const QSharedPointer<MessageSubscriber_t>& existingSubscriber, _messageSubscribers) {
+        if (existingSubscriber->subscriber == subscriber) {
+            messageSubscriber = existingSubscriber;
+            break;
+        }
+    }
+    if (!messageSubscriber) {
+        messageSubscriber = QSharedPointer<MessageSubscriber_t>(new MessageSubscriber_t);
+        messageSubscriber->subscriber = subscriber;
+        messageSubscriber->handler = handler;
+        messageSubscriber->stats.name = name;
+        messageSubscriber->stats.messageCount = 0;
+        messageSubscriber->stats.dispatchNsecs = 0;
+        _messageSubscribers.append(messageSubscriber);
+        connect(subscriber, &QObject::destroyed, this, &MAVLinkProtocol::_subscriberDestroyed);
+    }
+
+    MessageSubscription_t subscription;
+    subscription.subscriber = messageSubscriber;
+    subscription.msgIds = msgIds.toSet();
+
+    if (sysid == anySystemId) {
+        _anySystemSubscriptions.append(subscription);
+    } else {
+        _systemSubscriptions[sysid].append(subscription);
+    }
+}
+
+void MAVLinkProtocol::unsubscribeMessages(QObject* subscriber)
+{
+    for (int i=0; i<_messageSubscribers.count(); i++) {
+        if (_messageSubscribers[i]->subscriber == subscriber) {
+            const MessageSubscriber_t* messageSubscriber = _messageSubscribers[i].data();
+            qCDebug(MAVLinkProtocolLog) << "Unsubscribe" << messageSubscriber->stats.name
+                                        << "messages:" << messageSubscriber->stats.messageCount
+                                        << "dispatch msecs:" << messageSubscriber->stats.dispatchNsecs / 1000000;
+
+            // Message may be in the middle of being routed, so only mark it as gone. The shared pointer keeps it alive.
+            _messageSubscribers[i]->subscriber = NULL;
+            _messageSubscribers.removeAt(i);
+            disconnect(subscriber, &QObject::destroyed, this, &MAVLinkProtocol::_subscriberDestroyed);
+            break;
+        }
+    }
+
+    for (int sysid=0; sysid<256; sysid++) {
+        _removeSubscriptions(_systemSubscriptions[sysid], subscriber);
+    }
+    _removeSubscriptions(_anySystemSubscriptions, subscriber);
+}
+
+void MAVLinkProtocol::_removeSubscriptions(QVector<MessageSubscription_t>& subscriptions, QObject* subscriber)
+{
+    for (int i=subscriptions.count()-1; i>=0; i--) {
+        if (subscriptions[i].subscriber->subscriber == subscriber || subscriptions[i].subscriber->subscriber == NULL) {
+            subscriptions.remove(i);
+        }
+    }
+}
+
+void MAVLinkProtocol::_subscriberDestroyed(QObject* subscriber)
+{
+    unsubscribeMessages(subscriber);
+}
+
+QList<MAVLinkProtocol::SubscriberStats_t> MAVLinkProtocol::subscriberStats(void) const
+{
+    QList<SubscriberStats_t> stats;
+
+    foreach (const QSharedPointer<MessageSubscriber_t>& messageSubscriber, _messageSubscribers) {
+        stats.append(messageSubscriber->stats);
+    }
+
+    return stats;
+}
+
+/// Delivers the message to all subscribers for its sysid/msgid, each subscriber at most once
+void MAVLinkProtocol::_routeMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    QVarLengthArray<QSharedPointer<MessageSubscriber_t>, 8> targets;
+
+    const QVector<MessageSubscription_t>* subscriptionLists[2] = { &_systemSubscriptions[message.sysid], &_anySystemSubscriptions };
+    for (int list=0; list<2; list++) {
+        foreach (const MessageSubscription_t& subscription, *subscriptionLists[list]) {
+            if (!subscription.msgIds.isEmpty() && !subscription.msgIds.contains(message.msgid)) {
+                continue;
+            }
+            bool alreadyTargeted = false;
+            for (int i=0; i<targets.count(); i++) {
+                if (targets[i] == subscription.subscriber) {
+                    alreadyTargeted = true;
+                    break;
+                }
+            }
+            if (!alreadyTargeted) {
+                targets.append(subscription.subscriber);
+            }
+        }
+    }
+
+    QElapsedTimer dispatchTimer;
+    for (int i=0; i<targets.count(); i++) {
+        MessageSubscriber_t* messageSubscriber = targets[i].data();
+
+        // A previous handler may have unsubscribed this one
+        if (messageSubscriber->subscriber) {
+            dispatchTimer.start();
+            messageSubscriber->handler(link, message);
+            messageSubscriber->stats.dispatchNsecs += dispatchTimer.nsecsElapsed();
+            messageSubscriber->stats.messageCount++;
         }
     }
 }
@@ -18,9 +18,16 @@
 #include <QMap>
 #include <QByteArray>
 #include <QLoggingCategory>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <functional>
 
 #include "LinkInterface.h"
 #include "QGCMAVLink.h"
+#include "SharedMAVLinkMessage.h"
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
 #include "QGCToolbox.h"
@@ -100,6 +107,43 @@ public:
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
+    /// Returns the index of the next MAVLink 1/2 start-of-frame byte at or after from, or size if there is none
+    static int findNextStx(const char* data, int from, int size);
+
+    /// Callback for routed messages. Called on the MAVLinkProtocol thread.
+    typedef std::function<void(LinkInterface* link, const mavlink_message_t& message)> MessageHandler;
+
+    /// Subscription sysid which matches messages from any system
+    static const int anySystemId = -1;
+
+    /// Per-subscriber routing statistics
+    typedef struct {
+        QString     name;
+        quint64     messageCount;   ///< Number of messages routed to the subscriber
+        qint64      dispatchNsecs;  ///< Total time spent in the subscriber's handler
+    } SubscriberStats_t;
+
+    /// Routes messages from the specified system to handler. Unlike messageReceived, which goes to every listener,
+    /// routed messages are only delivered to subscribers with a matching sysid/msgid. A subscriber may subscribe
+    /// multiple times, it will still only see each message once. Subscriptions are removed automatically when
+    /// subscriber is destroyed.
+    ///     @param subscriber Owner of the subscription, used for unsubscribeMessages
+    ///     @param sysid System id to receive messages from, anySystemId for all systems
+    ///     @param msgIds Message ids to receive, empty for all messages
+    void subscribeMessages(QObject* subscriber, const QString& name, int sysid, const QList<uint32_t>& msgIds, MessageHandler handler);
+
+    /// Removes all subscriptions for the specified subscriber
+    void unsubscribeMessages(QObject* subscriber);
+
+    /// @return Routing statistics for all current subscribers
+    QList<SubscriberStats_t> subscriberStats(void) const;
+
+    /// Decodes the next message from bytes starting at position on the specified channel. Bytes outside
+    /// of a frame are skipped in bulk. Output is byte-exact with calling mavlink_parse_char on every byte.
+    ///     @param position Updated to one past the last byte consumed
+    /// @return true: message decoded into message/status
+    static bool parseNextMessage(uint8_t channel, const QByteArray& bytes, int& position, mavlink_message_t* message, mavlink_status_t* status);
+
 public slots:
     /** @brief Receive bytes from a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
@@ -141,6 +185,9 @@ signals:
 
     /** @brief Message received and directly copied via signal */
     void messageReceived(LinkInterface* link, mavlink_message_t message);
+    /// Message received, passed as a pooled handle. Use this instead of messageReceived for receivers on other
+    /// threads, the queued connection then only copies the handle instead of the whole message.
+    void sharedMessageReceived(LinkInterface* link, SharedMAVLinkMessage message);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -173,8 +220,24 @@ signals:
 
 private slots:
     void _vehicleCountChanged(void);
+    void _subscriberDestroyed(QObject* subscriber);
+    void _logMessagePoolStats(void);
     
 private:
+    typedef struct {
+        QObject*            subscriber;     ///< NULL once unsubscribed
+        MessageHandler      handler;
+        SubscriberStats_t   stats;
+    } MessageSubscriber_t;
+
+    typedef struct {
+        QSharedPointer<MessageSubscriber_t> subscriber;
+        QSet<uint32_t>                      msgIds;     ///< Empty for all messages
+    } MessageSubscription_t;
+
+    void _routeMessage(LinkInterface* link, const mavlink_message_t& message);
+    void _removeSubscriptions(QVector<MessageSubscription_t>& subscriptions, QObject* subscriber);
+
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
@@ -189,6 +252,15 @@ private:
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    QTimer                  _messagePoolStatsTimer;
+    QElapsedTimer           _messagePoolStatsElapsed;
+    quint64                 _lastMessagePoolMessageCount;
+    quint64                 _lastMessagePoolAllocationCount;
+
+    QList<QSharedPointer<MessageSubscriber_t>>  _messageSubscribers;
+    QVector<MessageSubscription_t>              _systemSubscriptions[256];  ///< Subscriptions indexed by sysid
+    QVector<MessageSubscription_t>              _anySystemSubscriptions;
 };
 
 #endif // MAVLINKPROTOCOL_H_
@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "SharedMAVLinkMessage.h"
+
+#include <QMutexLocker>
+
+QMutex                          SharedMAVLinkMessage::_poolMutex;
+SharedMAVLinkMessage::Slot_t*   SharedMAVLinkMessage::_freeSlots = NULL;
+QAtomicInteger<quint64>         SharedMAVLinkMessage::_messageCount;
+QAtomicInteger<quint64>         SharedMAVLinkMessage::_slotAllocationCount;
+
+SharedMAVLinkMessage::SharedMAVLinkMessage(void)
+    : _slot(NULL)
+{
+
+}
+
+SharedMAVLinkMessage::SharedMAVLinkMessage(const mavlink_message_t& message)
+    : _slot(_acquireSlot())
+{
+    _slot->message = message;
+    _slot->refCount.store(1);
+    _messageCount.fetchAndAddRelaxed(1);
+}
+
+SharedMAVLinkMessage::SharedMAVLinkMessage(const SharedMAVLinkMessage& other)
+    : _slot(other._slot)
+{
+    _ref();
+}
+
+SharedMAVLinkMessage::~SharedMAVLinkMessage()
+{
+    _deref();
+}
+
+SharedMAVLinkMessage& SharedMAVLinkMessage::operator=(const SharedMAVLinkMessage& other)
+{
+    if (_slot != other._slot) {
+        _deref();
+        _slot = other._slot;
+        _ref();
+    }
+    return *this;
+}
+
+void SharedMAVLinkMessage::_ref(void)
+{
+    if (_slot) {
+        _slot->refCount.ref();
+    }
+}
+
+void SharedMAVLinkMessage::_deref(void)
+{
+    if (_slot && !_slot->refCount.deref()) {
+        _releaseSlot(_slot);
+    }
+    _slot = NULL;
+}
+
+SharedMAVLinkMessage::Slot_t* SharedMAVLinkMessage::_acquireSlot(void)
+{
+    {
+        QMutexLocker lock(&_poolMutex);
+        if (_freeSlots) {
+            Slot_t* slot = _freeSlots;
+            _freeSlots = slot->nextFree;
+            return slot;
+        }
+    }
+
+    _slotAllocationCount.fetchAndAddRelaxed(1);
+    return new Slot_t;
+}
+
+void SharedMAVLinkMessage::_releaseSlot(Slot_t* slot)
+{
+    QMutexLocker lock(&_poolMutex);
+    slot->nextFree = _freeSlots;
+    _freeSlots = slot;
+}
+
+quint64 SharedMAVLinkMessage::messageCount(void)
+{
+    return _messageCount.load();
+}
+
+quint64 SharedMAVLinkMessage::slotAllocationCount(void)
+{
+    return _slotAllocationCount.load();
+}
@@ -0,0 +1,73 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef SharedMAVLinkMessage_H
+#define SharedMAVLinkMessage_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QMetaType>
+#include <QMutex>
+
+#include "QGCMAVLink.h"
+
+/// Reference counted handle to a mavlink_message_t which lives in a recycled pool slot.
+///
+/// Passing a mavlink_message_t through a queued connection heap allocates a copy of the whole ~290 byte
+/// message for every receiver. Passing this handle instead only copies a pointer, the message itself
+/// is written once into a pool slot which goes back to the pool when the last handle is released.
+/// Handles can be released from any thread. The message is read-only once shared.
+class SharedMAVLinkMessage
+{
+public:
+    SharedMAVLinkMessage(void);
+    explicit SharedMAVLinkMessage(const mavlink_message_t& message);
+    SharedMAVLinkMessage(const SharedMAVLinkMessage& other);
+    ~SharedMAVLinkMessage();
+
+    SharedMAVLinkMessage& operator=(const SharedMAVLinkMessage& other);
+
+    bool isNull(void) const { return _slot == NULL; }
+
+    const mavlink_message_t& message(void) const { return _slot->message; }
+    const mavlink_message_t* operator->(void) const { return &_slot->message; }
+
+    /// @return Number of handles created from a message since startup. Each of these used to be a heap copy per receiver.
+    static quint64 messageCount(void);
+
+    /// @return Number of pool slots which have been heap allocated since startup
+    static quint64 slotAllocationCount(void);
+
+private:
+    typedef struct Slot_s {
+        QAtomicInt          refCount;
+        mavlink_message_t   message;
+        struct Slot_s*      nextFree;
+    } Slot_t;
+
+    static Slot_t*  _acquireSlot(void);
+    static void     _releaseSlot(Slot_t* slot);
+
+    void _ref(void);
+    void _deref(void);
+
+    Slot_t* _slot;
+
+    // The pool is shared by all links. Slots are never freed, so the pool only grows to the high water mark of
+    // messages in flight. That is bounded by how far the slowest receiver's queue falls behind.
+    static QMutex                   _poolMutex;
+    static Slot_t*                  _freeSlots;
+    static QAtomicInteger<quint64>  _messageCount;
+    static QAtomicInteger<quint64>  _slotAllocationCount;
+};
+
+Q_DECLARE_METATYPE(SharedMAVLinkMessage)
+
+#endif
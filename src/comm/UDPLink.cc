@@ -176,30 +176,115 @@ void UDPLink::_writeBytes(const QByteArray data)
 void UDPLink::readBytes()
 {
     QByteArray databuffer;
+    QList<DatagramSender_t> senders;
+    qint64 totalBytes = 0;
+
     while (_socket->hasPendingDatagrams())
     {
-        QByteArray datagram;
-        datagram.resize(_socket->pendingDatagramSize());
+        // Datagrams are read straight into the outgoing buffer
+        int offset = databuffer.size();
+        databuffer.resize(offset + qMax(_socket->pendingDatagramSize(), (qint64)0));
         QHostAddress sender;
         quint16 senderPort;
-        _socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
-        databuffer.append(datagram);
+        qint64 datagramSize = _socket->readDatagram(databuffer.data() + offset, databuffer.size() - offset, &sender, &senderPort);
+        databuffer.resize(offset + qMax(datagramSize, (qint64)0));
+        if (datagramSize > 0) {
+            totalBytes += datagramSize;
+            _addSender(senders, sender, senderPort);
+        }
+
+#if defined(UDPLINK_BATCHED_RECEIVE)
+        // Qt only re-arms its read notifier from readDatagram, so the first datagram always goes through Qt above.
+        // Whatever else is queued on the socket is drained in batches.
+        int batchedOffset = databuffer.size();
+        _readBatchedBytes(databuffer, senders);
+        totalBytes += databuffer.size() - batchedOffset;
+#endif
+
         //-- Wait a bit before sending it over
         if(databuffer.size() > 10 * 1024) {
             emit bytesReceived(this, databuffer);
             databuffer.clear();
         }
-        _logInputDataRate(datagram.length(), QDateTime::currentMSecsSinceEpoch());
-        // TODO This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        _udpConfig->addHost(sender.toString(), (int)senderPort);
     }
     //-- Send whatever is left
     if(databuffer.size()) {
         emit bytesReceived(this, databuffer);
     }
+
+    if (totalBytes) {
+        _logInputDataRate(totalBytes, QDateTime::currentMSecsSinceEpoch());
+    }
+
+    // TODO This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    foreach (const DatagramSender_t& sender, senders) {
+        _udpConfig->addHost(sender.address.toString(), (int)sender.port);
+    }
+}
+
+/// Adds the sender to the list of senders seen in this batch if it is not already there
+void UDPLink::_addSender(QList<DatagramSender_t>& senders, const QHostAddress& address, quint16 port)
+{
+    for (int i=0; i<senders.count(); i++) {
+        if (senders[i].address == address) {
+            senders[i].port = port;
+            return;
+        }
+    }
+
+    DatagramSender_t sender;
+    sender.address = address;
+    sender.port = port;
+    senders.append(sender);
+}
+
+/// Drains all datagrams currently queued on the socket into databuffer using recvmmsg. Does nothing
+/// on platforms without batched receive.
+void UDPLink::_readBatchedBytes(QByteArray& databuffer, QList<DatagramSender_t>& senders)
+{
+#if defined(UDPLINK_BATCHED_RECEIVE)
+    int fd = (int)_socket->socketDescriptor();
+    if (fd == -1) {
+        return;
+    }
+
+    if (_batchBuffer.isEmpty()) {
+        _batchBuffer.resize(_batchDatagramCount * _batchDatagramSize);
+    }
+
+    while (true) {
+        for (int i=0; i<_batchDatagramCount; i++) {
+            _batchIovecs[i].iov_base = _batchBuffer.data() + (i * _batchDatagramSize);
+            _batchIovecs[i].iov_len = _batchDatagramSize;
+            memset(&_batchHeaders[i], 0, sizeof(_batchHeaders[i]));
+            _batchHeaders[i].msg_hdr.msg_iov = &_batchIovecs[i];
+            _batchHeaders[i].msg_hdr.msg_iovlen = 1;
+            _batchHeaders[i].msg_hdr.msg_name = &_batchSenders[i];
+            _batchHeaders[i].msg_hdr.msg_namelen = sizeof(_batchSenders[i]);
+        }
+
+        int count = recvmmsg(fd, _batchHeaders, _batchDatagramCount, MSG_DONTWAIT, NULL);
+        if (count <= 0) {
+            // EAGAIN: socket is drained
+            return;
+        }
+
+        for (int i=0; i<count; i++) {
+            databuffer.append((const char*)_batchIovecs[i].iov_base, _batchHeaders[i].msg_len);
+            _addSender(senders, QHostAddress((const struct sockaddr*)&_batchSenders[i]), ntohs(_batchSenders[i].sin_port));
+        }
+
+        if (count < _batchDatagramCount) {
+            return;
+        }
+    }
+#else
+    Q_UNUSED(databuffer);
+    Q_UNUSED(senders);
+#endif
 }
 
 /**
@@ -34,6 +34,13 @@
 #include "QGCConfig.h"
 #include "LinkManager.h"
 
+// Linux can drain many datagrams with a single recvmmsg call
+#if defined(Q_OS_LINUX) && !defined(__android__)
+#define UDPLINK_BATCHED_RECEIVE
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
 class UDPConfiguration : public LinkConfiguration
 {
     Q_OBJECT
@@ -201,6 +208,25 @@ private:
     void _registerZeroconf(uint16_t port, const std::string& regType);
     void _deregisterZeroconf();
 
+    /// Sender of a datagram, used to update the host list once per batch
+    typedef struct {
+        QHostAddress    address;
+        quint16         port;
+    } DatagramSender_t;
+
+    void _addSender         (QList<DatagramSender_t>& senders, const QHostAddress& address, quint16 port);
+    void _readBatchedBytes  (QByteArray& databuffer, QList<DatagramSender_t>& senders);
+
+#if defined(UDPLINK_BATCHED_RECEIVE)
+    static const int    _batchDatagramCount =   32;
+    static const int    _batchDatagramSize =    65536;  ///< Max UDP payload, so datagrams are never truncated
+
+    QByteArray          _batchBuffer;   ///< Preallocated receive slots, reused for every batch
+    struct mmsghdr      _batchHeaders[_batchDatagramCount];
+    struct iovec        _batchIovecs[_batchDatagramCount];
+    struct sockaddr_in  _batchSenders[_batchDatagramCount];
+#endif
+
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef  _dnssServiceRef;
 #endif
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "CRC32Test.h"
+#include "QGC.h"
+
+CRC32Test::CRC32Test(void)
+{
+    qsrand(1);
+    _buffer.resize(_bufferSize);
+    for (int i = 0; i < _buffer.size(); i++) {
+        _buffer[i] = (char)(qrand() & 0xff);
+    }
+}
+
+/// Reference implementation straight from the polynomial
+quint32 CRC32Test::_bitwiseCRC(const quint8* src, unsigned len, quint32 state)
+{
+    for (unsigned i = 0; i < len; i++) {
+        state ^= src[i];
+        for (int bit = 0; bit < 8; bit++) {
+            state = (state >> 1) ^ (0xEDB88320u & (0u - (state & 1)));
+        }
+    }
+    return state;
+}
+
+/// Byte at a time table loop QGC::crc32 used to be, for the benchmark
+quint32 CRC32Test::_byteCRC(const quint8* src, unsigned len, quint32 state)
+{
+    static quint32 table[256];
+    if (!table[1]) {
+        for (int i = 0; i < 256; i++) {
+            quint8 byte = (quint8)i;
+            table[i] = _bitwiseCRC(&byte, 1, 0);
+        }
+    }
+    for (unsigned i = 0; i < len; i++) {
+        state = table[(state ^ src[i]) & 0xff] ^ (state >> 8);
+    }
+    return state;
+}
+
+void CRC32Test::_bitExact_test(void)
+{
+    const quint8* data = reinterpret_cast<const quint8*>(_buffer.constData());
+
+    // Known value: "123456789" with the usual ~0 pre and post conditioning is 0xCBF43926
+    QCOMPARE(~QGC::crc32(reinterpret_cast<const quint8*>("123456789"), 9, 0xFFFFFFFF), 0xCBF43926u);
+
+    // All alignments and the lengths around each of the block sizes used internally
+    for (unsigned offset = 0; offset < 16; offset++) {
+        for (unsigned len = 0; len < 300; len++) {
+            quint32 state = (quint32)qrand() * 65599u;
+            QCOMPARE(QGC::crc32(data + offset, len, state), _bitwiseCRC(data + offset, len, state));
+        }
+    }
+
+    QCOMPARE(QGC::crc32(data, _bufferSize, 0), _bitwiseCRC(data, _bufferSize, 0));
+}
+
+void CRC32Test::_chained_test(void)
+{
+    // Feeding the data in pieces, as the bootloader does, gives the same result as all at once
+    const quint8* data = reinterpret_cast<const quint8*>(_buffer.constData());
+    quint32 whole = QGC::crc32(data, _bufferSize, 0);
+
+    quint32 state = 0;
+    unsigned offset = 0;
+    while (offset < (unsigned)_bufferSize) {
+        unsigned len = qMin((unsigned)(qrand() % 1000), _bufferSize - offset);
+        state = QGC::crc32(data + offset, len, state);
+        offset += len;
+    }
+    QCOMPARE(state, whole);
+}
+
+void CRC32Test::_fill_test(void)
+{
+    for (unsigned len = 0; len < 2000; len += 13) {
+        quint8 fill = (quint8)qrand();
+        quint32 state = (quint32)qrand() * 65599u;
+        QByteArray bytes(len, (char)fill);
+        QCOMPARE(QGC::crc32Fill(fill, len, state), _bitwiseCRC(reinterpret_cast<const quint8*>(bytes.constData()), len, state));
+    }
+
+    // Bootloader padding of a small image to the full flash size
+    QByteArray padding(_flashSize - 1000, (char)0xFF);
+    quint32 state = QGC::crc32(reinterpret_cast<const quint8*>(_buffer.constData()), 1000, 0);
+    QCOMPARE(QGC::crc32Fill(0xFF, padding.size(), state), QGC::crc32(reinterpret_cast<const quint8*>(padding.constData()), padding.size(), state));
+}
+
+void CRC32Test::_crcBenchmark_test_data(void)
+{
+    QTest::addColumn<bool>("fast");
+
+    QTest::newRow("Byte table") << false;
+    QTest::newRow("QGC::crc32") << true;
+}
+
+/// CRC of 1MB, in the size of the chunks read from a firmware file and in one call
+void CRC32Test::_crcBenchmark_test(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(bool, fast);
+
+    const quint8* data = reinterpret_cast<const quint8*>(_buffer.constData());
+    quint32 state = 0;
+    QBENCHMARK {
+        state = 0;
+        for (int offset = 0; offset < _bufferSize; offset += 252) {
+            unsigned len = qMin(252, _bufferSize - offset);
+            state = fast ? QGC::crc32(data + offset, len, state) : _byteCRC(data + offset, len, state);
+        }
+        state = fast ? QGC::crc32(data, _bufferSize, state) : _byteCRC(data, _bufferSize, state);
+    }
+    Q_UNUSED(state);
+}
+
+void CRC32Test::_fillBenchmark_test_data(void)
+{
+    QTest::addColumn<bool>("fast");
+
+    QTest::newRow("Byte at a time") << false;
+    QTest::newRow("QGC::crc32Fill") << true;
+}
+
+/// Padding of a 100KB image to the full flash size
+void CRC32Test::_fillBenchmark_test(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(bool, fast);
+
+    const unsigned len = _flashSize - (100 * 1024);
+    quint32 state = 0;
+    QBENCHMARK {
+        if (fast) {
+            state = QGC::crc32Fill(0xFF, len, state);
+        } else {
+            const quint8 fill = 0xFF;
+            for (unsigned i = 0; i < len; i++) {
+                state = QGC::crc32(&fill, 1, state);
+            }
+        }
+    }
+    Q_UNUSED(state);
+}
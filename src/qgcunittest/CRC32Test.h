@@ -0,0 +1,45 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef CRC32Test_H
+#define CRC32Test_H
+
+#include "UnitTest.h"
+
+#include <QByteArray>
+
+/// Unit test and throughput benchmark for QGC::crc32 and QGC::crc32Fill
+class CRC32Test : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    CRC32Test(void);
+
+private slots:
+    void _bitExact_test(void);
+    void _chained_test(void);
+    void _fill_test(void);
+    void _crcBenchmark_test(void);
+    void _crcBenchmark_test_data(void);
+    void _fillBenchmark_test(void);
+    void _fillBenchmark_test_data(void);
+
+private:
+    static quint32 _bitwiseCRC(const quint8* src, unsigned len, quint32 state);
+    static quint32 _byteCRC(const quint8* src, unsigned len, quint32 state);
+
+    QByteArray _buffer;
+
+    static const int _bufferSize =      1024 * 1024;
+    static const int _flashSize =       2 * 1024 * 1024;    ///< Largest Pixhawk flash
+};
+
+#endif
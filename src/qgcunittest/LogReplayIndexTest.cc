@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "LogReplayIndexTest.h"
+#include "LogReplayIndex.h"
+#include "QGCMAVLink.h"
+
+#include <QtEndian>
+
+LogReplayIndexTest::LogReplayIndexTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void LogReplayIndexTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir;
+    QVERIFY(_tempDir->isValid());
+    _tlogFilename = _tempDir->path() + QStringLiteral("/LogReplayIndexTest.tlog");
+    _writeTlog();
+}
+
+void LogReplayIndexTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanup();
+}
+
+/// Writes a tlog with a message every _spacingUSecs. Some messages are followed by junk bytes.
+void LogReplayIndexTest::_writeTlog(void)
+{
+    QFile               tlog(_tlogFilename);
+    mavlink_message_t   msg;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    QVERIFY(tlog.open(QFile::WriteOnly));
+    _messageTimes.clear();
+    _messageOffsets.clear();
+    for (int i=0; i<_messageCount; i++) {
+        quint64 timeUSecs = _startTimeUSecs + i * _spacingUSecs;
+        uchar rawTime[LogReplayIndex::cbTimestamp];
+        qToBigEndian(timeUSecs, rawTime);
+
+        _messageTimes.append(timeUSecs);
+        _messageOffsets.append(tlog.pos());
+        tlog.write((const char*)rawTime, sizeof(rawTime));
+
+        mavlink_msg_attitude_pack_chan(1, 1, _packChannel, &msg, i, 0.1f * i, -0.2f * i, 0.3f, 0, 0, 0);
+        int len = mavlink_msg_to_send_buffer(buffer, &msg);
+        tlog.write((const char*)buffer, len);
+
+        if (i % 17 == 0) {
+            tlog.write("\xfd\x01\x02", 3);
+        }
+    }
+}
+
+void LogReplayIndexTest::_build_test(void)
+{
+    LogReplayIndex  index;
+    QAtomicInt      abort;
+
+    QVERIFY(index.build(_tlogFilename, abort));
+
+    // 20 seconds of log with an entry every quarter second
+    QCOMPARE(index.count(), (int)((_messageCount * _spacingUSecs) / 250000));
+}
+
+void LogReplayIndexTest::_findOffset_test(void)
+{
+    LogReplayIndex  index;
+    QAtomicInt      abort;
+
+    QVERIFY(index.build(_tlogFilename, abort));
+
+    QCOMPARE(index.findOffset(0), _messageOffsets.first());
+    QCOMPARE(index.findOffset(_startTimeUSecs), _messageOffsets.first());
+    QCOMPARE(index.findOffset(_startTimeUSecs + 250000), _messageOffsets[25]);
+    QCOMPARE(index.findOffset(_startTimeUSecs + 260000), _messageOffsets[25]);
+    QCOMPARE(index.findOffset(_startTimeUSecs + 499999), _messageOffsets[25]);
+    QCOMPARE(index.findOffset(_startTimeUSecs + 500000), _messageOffsets[50]);
+
+    // Every offset must land on a timestamp at or before the requested time, no further back than one entry
+    for (int i=0; i<_messageCount; i++) {
+        qint64 offset = index.findOffset(_messageTimes[i]);
+        int messageIndex = _messageOffsets.indexOf(offset);
+        QVERIFY(messageIndex != -1);
+        QVERIFY(_messageTimes[messageIndex] <= _messageTimes[i]);
+        QVERIFY(_messageTimes[i] - _messageTimes[messageIndex] < 250000);
+    }
+}
+
+void LogReplayIndexTest::_saveLoad_test(void)
+{
+    LogReplayIndex  index;
+    LogReplayIndex  loadedIndex;
+    QAtomicInt      abort;
+
+    QVERIFY(!loadedIndex.load(_tlogFilename));
+
+    QVERIFY(index.build(_tlogFilename, abort));
+    QVERIFY(index.save(_tlogFilename));
+    QVERIFY(QFile::exists(LogReplayIndex::indexFilename(_tlogFilename)));
+
+    QVERIFY(loadedIndex.load(_tlogFilename));
+    QCOMPARE(loadedIndex.count(), index.count());
+    for (int i=0; i<_messageCount; i += 7) {
+        QCOMPARE(loadedIndex.findOffset(_messageTimes[i]), index.findOffset(_messageTimes[i]));
+    }
+
+    // A changed log invalidates the saved index
+    QFile tlog(_tlogFilename);
+    QVERIFY(tlog.open(QFile::Append));
+    tlog.write("junk");
+    tlog.close();
+    QVERIFY(!loadedIndex.load(_tlogFilename));
+    QCOMPARE(loadedIndex.count(), 0);
+}
+
+void LogReplayIndexTest::_abort_test(void)
+{
+    LogReplayIndex  index;
+    QAtomicInt      abort(1);
+
+    QVERIFY(!index.build(_tlogFilename, abort));
+    QCOMPARE(index.count(), 0);
+}
@@ -0,0 +1,51 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef LOGREPLAYINDEXTEST_H
+#define LOGREPLAYINDEXTEST_H
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// @file
+///     @brief Unit test for the LogReplayLink time index
+
+class LogReplayIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogReplayIndexTest(void);
+
+private slots:
+    void init(void);
+    void cleanup(void);
+
+    void _build_test(void);
+    void _findOffset_test(void);
+    void _saveLoad_test(void);
+    void _abort_test(void);
+
+private:
+    void _writeTlog(void);
+
+    QTemporaryDir*  _tempDir;
+    QString         _tlogFilename;
+    QList<quint64>  _messageTimes;      ///< Timestamp of each message written to the tlog
+    QList<qint64>   _messageOffsets;    ///< File offset of the timestamp preceding each message
+
+    static const quint64 _startTimeUSecs =  1500000000000000ull;
+    static const quint64 _spacingUSecs =    10000;
+    static const int     _messageCount =    2000;
+    static const uint8_t _packChannel =     MAVLINK_COMM_NUM_BUFFERS - 3;
+};
+
+#endif
@@ -0,0 +1,177 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "MAVLinkProtocolTest.h"
+#include "MAVLinkProtocol.h"
+
+const char* MAVLinkProtocolTest::_benchmarkTlogEnvVar = "QGC_BENCHMARK_TLOG";
+
+MAVLinkProtocolTest::MAVLinkProtocolTest(void)
+{
+
+}
+
+/// Builds a stream of mixed MAVLink 1/2 frames interleaved with noise, stray STX bytes and corrupt frames
+QByteArray MAVLinkProtocolTest::_buildStream(void)
+{
+    QByteArray          stream;
+    mavlink_message_t   msg;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    mavlink_reset_channel_status(_packChannel);
+    mavlink_status_t* packStatus = mavlink_get_channel_status(_packChannel);
+
+    for (int i=0; i<200; i++) {
+        if (i & 1) {
+            packStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        } else {
+            packStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+
+        // Noise which includes stray start-of-frame markers
+        for (int j=0; j<i % 13; j++) {
+            stream.append((char)((i * 31 + j * 7) & 0xFF));
+        }
+        if (i % 5 == 0) {
+            stream.append((char)MAVLINK_STX);
+        }
+        if (i % 7 == 0) {
+            stream.append((char)MAVLINK_STX_MAVLINK1);
+        }
+
+        if (i % 3 == 0) {
+            mavlink_msg_heartbeat_pack_chan(1, 1, _packChannel, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, i, MAV_STATE_ACTIVE);
+        } else {
+            mavlink_msg_attitude_pack_chan(1 + (i % 4), 1, _packChannel, &msg, i, 0.1f * i, -0.2f * i, 0.3f, 0, 0, 0);
+        }
+        int len = mavlink_msg_to_send_buffer(buffer, &msg);
+
+        if (i % 11 == 0) {
+            // Corrupt the crc
+            buffer[len - 1] ^= 0x55;
+        }
+        stream.append((const char*)buffer, len);
+    }
+
+    return stream;
+}
+
+/// Returns the stream to benchmark against. Timestamps in a tlog act as inter-frame noise.
+QByteArray MAVLinkProtocolTest::_loadBenchmarkStream(void)
+{
+    QString tlogPath = QString::fromLocal8Bit(qgetenv(_benchmarkTlogEnvVar));
+
+    if (!tlogPath.isEmpty()) {
+        QFile tlog(tlogPath);
+        if (tlog.open(QIODevice::ReadOnly)) {
+            return tlog.readAll();
+        }
+        qWarning() << "Unable to open" << tlogPath << tlog.errorString();
+    }
+
+    QByteArray stream = _buildStream();
+    for (int i=0; i<6; i++) {
+        stream.append(stream);
+    }
+    return stream;
+}
+
+/// Reference decode: every byte through mavlink_parse_char. Returns all decoded messages re-serialized.
+QByteArray MAVLinkProtocolTest::_parseBytewise(uint8_t channel, const QByteArray& bytes)
+{
+    QByteArray          decoded;
+    mavlink_message_t   msg;
+    mavlink_status_t    status;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    mavlink_reset_channel_status(channel);
+    for (int i=0; i<bytes.size(); i++) {
+        if (mavlink_parse_char(channel, (uint8_t)bytes[i], &msg, &status) == 1) {
+            decoded.append((const char*)buffer, mavlink_msg_to_send_buffer(buffer, &msg));
+        }
+    }
+
+    return decoded;
+}
+
+/// Bulk decode using MAVLinkProtocol::parseNextMessage, with bytes delivered in chunks of chunkSize
+QByteArray MAVLinkProtocolTest::_parseBulk(uint8_t channel, const QByteArray& bytes, int chunkSize)
+{
+    QByteArray          decoded;
+    mavlink_message_t   msg;
+    mavlink_status_t    status;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    mavlink_reset_channel_status(channel);
+    for (int offset=0; offset<bytes.size(); offset+=chunkSize) {
+        QByteArray chunk = bytes.mid(offset, chunkSize);
+        int position = 0;
+        while (MAVLinkProtocol::parseNextMessage(channel, chunk, position, &msg, &status)) {
+            decoded.append((const char*)buffer, mavlink_msg_to_send_buffer(buffer, &msg));
+        }
+    }
+
+    return decoded;
+}
+
+void MAVLinkProtocolTest::_findNextStx_test(void)
+{
+    const char data[] = { 0x01, 0x02, (char)MAVLINK_STX_MAVLINK1, 0x03, (char)MAVLINK_STX, 0x04 };
+    const int size = sizeof(data);
+
+    QCOMPARE(MAVLinkProtocol::findNextStx(data, 0, size), 2);
+    QCOMPARE(MAVLinkProtocol::findNextStx(data, 2, size), 2);
+    QCOMPARE(MAVLinkProtocol::findNextStx(data, 3, size), 4);
+    QCOMPARE(MAVLinkProtocol::findNextStx(data, 5, size), size);
+    QCOMPARE(MAVLinkProtocol::findNextStx(data, size, size), size);
+}
+
+void MAVLinkProtocolTest::_parseNextMessageByteExact_test(void)
+{
+    QByteArray stream = _buildStream();
+    QByteArray expected = _parseBytewise(_bytewiseChannel, stream);
+
+    QVERIFY(!expected.isEmpty());
+
+    // Chunk sizes which split frames at every possible point as well as whole-stream delivery
+    QList<int> chunkSizes;
+    chunkSizes << 1 << 3 << 17 << 64 << 263 << stream.size();
+    foreach (int chunkSize, chunkSizes) {
+        QCOMPARE(_parseBulk(_bulkChannel, stream, chunkSize), expected);
+    }
+}
+
+void MAVLinkProtocolTest::_parseBenchmark_test_data(void)
+{
+    QTest::addColumn<bool>("bulk");
+
+    QTest::newRow("bytewise") << false;
+    QTest::newRow("bulk") << true;
+}
+
+void MAVLinkProtocolTest::_parseBenchmark_test(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(bool, bulk);
+
+    QByteArray stream = _loadBenchmarkStream();
+    QByteArray decoded;
+
+    QBENCHMARK {
+        if (bulk) {
+            decoded = _parseBulk(_bulkChannel, stream, 4096);
+        } else {
+            decoded = _parseBytewise(_bytewiseChannel, stream);
+        }
+    }
+
+    QVERIFY(!decoded.isEmpty());
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef MAVLINKPROTOCOLTEST_H
+#define MAVLINKPROTOCOLTEST_H
+
+#include "UnitTest.h"
+
+/// @file
+///     @brief Unit test for the MAVLinkProtocol bulk frame scanner
+
+class MAVLinkProtocolTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkProtocolTest(void);
+
+private slots:
+    void _findNextStx_test(void);
+    void _parseNextMessageByteExact_test(void);
+    void _parseBenchmark_test(void);
+    void _parseBenchmark_test_data(void);
+
+private:
+    QByteArray  _buildStream(void);
+    QByteArray  _loadBenchmarkStream(void);
+    QByteArray  _parseBytewise(uint8_t channel, const QByteArray& bytes);
+    QByteArray  _parseBulk(uint8_t channel, const QByteArray& bytes, int chunkSize);
+
+    // High channels are used so we don't collide with links created by other tests
+    static const uint8_t _bytewiseChannel =  MAVLINK_COMM_NUM_BUFFERS - 1;
+    static const uint8_t _bulkChannel =      MAVLINK_COMM_NUM_BUFFERS - 2;
+    static const uint8_t _packChannel =      MAVLINK_COMM_NUM_BUFFERS - 3;
+
+    /// Set to the path of a recorded tlog to benchmark against real traffic, benchmarks run with QGC_BENCHMARK set
+    static const char*  _benchmarkTlogEnvVar;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "TimeSeriesDataTest.h"
+#include "LinechartPlot.h"
+
+#include <cmath>
+
+TimeSeriesDataTest::TimeSeriesDataTest(void)
+{
+
+}
+
+/// Deterministic, noisy test signal
+double TimeSeriesDataTest::_sampleValue(int i)
+{
+    return 100.0 * sin(i * 0.1) + (i % 7) - 3.0;
+}
+
+/// Incremental mean and variance must match a full recalculation over the average window
+void TimeSeriesDataTest::_rollingStats_test(void)
+{
+    const int       window = 50;
+    TimeSeriesData  data(NULL, "test", 10000);
+    QList<double>   values;
+
+    data.setAverageWindowSize(window);
+    for (int i=0; i<5000; i++) {
+        double value = _sampleValue(i);
+        values.append(value);
+        data.append(i, value);
+
+        if (i % 97 == 0 || i == 4999) {
+            int     count = qMin(values.count(), window);
+            double  mean = 0;
+            double  variance = 0;
+            for (int j=values.count() - count; j<values.count(); j++) {
+                mean += values[j];
+            }
+            mean /= count;
+            for (int j=values.count() - count; j<values.count(); j++) {
+                variance += (values[j] - mean) * (values[j] - mean);
+            }
+            variance /= count;
+
+            QVERIFY(fabs(data.getMean() - mean) < 1e-6);
+            QVERIFY(fabs(data.getVariance() - variance) < 1e-6 * qMax(1.0, variance));
+        }
+    }
+    QCOMPARE(data.getCurrentValue(), values.last());
+    QCOMPARE(data.getCount(), values.count());
+}
+
+/// Changing the average window recalculates from the stored samples
+void TimeSeriesDataTest::_averageWindow_test(void)
+{
+    TimeSeriesData data(NULL, "test", 10000);
+
+    for (int i=0; i<100; i++) {
+        data.append(i, i);
+    }
+    data.setAverageWindowSize(10);
+    QCOMPARE(data.getMean(), 94.5);
+    QCOMPARE(data.getVariance(), 8.25);
+
+    data.append(100, 100);
+    QVERIFY(fabs(data.getMean() - 95.5) < 1e-9);
+    QVERIFY(fabs(data.getVariance() - 8.25) < 1e-9);
+}
+
+/// The plot view is contiguous, covers the plot interval and survives wrapping around the ring
+void TimeSeriesDataTest::_plotSamples_test(void)
+{
+    const quint64   plotInterval = 1000;
+    const quint64   spacing = 10;
+    const int       sampleCount = 10 * TimeSeriesData::INITIAL_CAPACITY;
+    TimeSeriesData  data(NULL, "test", plotInterval);
+
+    for (int i=0; i<sampleCount; i++) {
+        data.append(i * spacing, _sampleValue(i));
+    }
+    QCOMPARE(data.getCapacity(), (int)TimeSeriesData::INITIAL_CAPACITY);
+
+    TimeSeriesData::Samples_t samples = data.getPlotSamples();
+    QCOMPARE(samples.count, (int)(plotInterval / spacing) + 1);
+    int first = sampleCount - samples.count;
+    for (int i=0; i<samples.count; i++) {
+        QCOMPARE(samples.x[i], (double)((first + i) * spacing));
+        QCOMPARE(samples.y[i], _sampleValue(first + i));
+    }
+
+    // Widening the interval pulls older samples still in the ring back into view
+    data.setInterval(2 * plotInterval);
+    QCOMPARE(data.getPlotSamples().count, (int)(2 * plotInterval / spacing) + 1);
+}
+
+/// A plot interval larger than the ring grows it without losing samples
+void TimeSeriesDataTest::_grow_test(void)
+{
+    const int       sampleCount = 5 * TimeSeriesData::INITIAL_CAPACITY;
+    TimeSeriesData  data(NULL, "test", sampleCount * 2);
+
+    for (int i=0; i<sampleCount; i++) {
+        data.append(i, _sampleValue(i));
+    }
+    QVERIFY(data.getCapacity() >= 2 * sampleCount);
+
+    TimeSeriesData::Samples_t samples = data.getPlotSamples();
+    QCOMPARE(samples.count, sampleCount);
+    for (int i=0; i<samples.count; i++) {
+        QCOMPARE(samples.x[i], (double)i);
+        QCOMPARE(samples.y[i], _sampleValue(i));
+    }
+    QCOMPARE(data.getSamples().count, sampleCount);
+}
+
+/// Decimation keeps every column's extremes in time order and bounds the number of points
+void TimeSeriesDataTest::_decimation_test(void)
+{
+    const int       sampleCount = 60000;
+    const int       columns = 100;
+    const int       spikeIndex = 31234;
+    TimeSeriesData  data(NULL, "test", sampleCount * 2);
+
+    for (int i=0; i<sampleCount; i++) {
+        data.append(i, i == spikeIndex ? 1000.0 : _sampleValue(i));
+    }
+
+    QVector<QPointF> points;
+    data.getDecimatedPlotSamples(columns, points);
+    QVERIFY(points.count() > columns);
+    QVERIFY(points.count() <= 2 * columns);
+
+    double minValue = points[0].y();
+    double maxValue = points[0].y();
+    bool   spikeFound = false;
+    for (int i=1; i<points.count(); i++) {
+        QVERIFY(points[i].x() > points[i-1].x());
+        minValue = qMin(minValue, points[i].y());
+        maxValue = qMax(maxValue, points[i].y());
+        if (points[i].x() == spikeIndex) {
+            spikeFound = true;
+        }
+    }
+    QVERIFY(spikeFound);
+    QCOMPARE(maxValue, 1000.0);
+
+    double expectedMin = _sampleValue(0);
+    for (int i=1; i<sampleCount; i++) {
+        expectedMin = qMin(expectedMin, _sampleValue(i));
+    }
+    QCOMPARE(minValue, expectedMin);
+}
@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef TIMESERIESDATATEST_H
+#define TIMESERIESDATATEST_H
+
+#include "UnitTest.h"
+
+/// @file
+///     @brief Unit test for the line chart time series ring buffer
+
+class TimeSeriesDataTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TimeSeriesDataTest(void);
+
+private slots:
+    void _rollingStats_test(void);
+    void _averageWindow_test(void);
+    void _plotSamples_test(void);
+    void _grow_test(void);
+    void _decimation_test(void);
+
+private:
+    static double _sampleValue(int i);
+};
+
+#endif
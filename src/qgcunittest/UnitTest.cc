@@ -523,3 +523,8 @@ bool UnitTest::doubleNaNCompare(double value1, double value2)
         return ret;
     }
 }
+
+bool UnitTest::benchmarksEnabled(void)
+{
+    return qEnvironmentVariableIsSet("QGC_BENCHMARK");
+}
@@ -27,6 +27,12 @@
 
 #define UT_REGISTER_TEST(className) static UnitTestWrapper<className> className(#className);
 
+/// Skips the calling test unless benchmarks are enabled, see UnitTest::benchmarksEnabled
+#define UT_BENCHMARK_ONLY() \
+    if (!UnitTest::benchmarksEnabled()) { \
+        QSKIP("Benchmark, set QGC_BENCHMARK in the environment to run it"); \
+    }
+
 class QGCMessageBox;
 class QGCQFileDialog;
 class LinkManager;
@@ -96,6 +102,11 @@ public:
     /// @return true: equal
     static bool doubleNaNCompare(double value1, double value2);
 
+    /// Benchmarks and long running stress tests only run when QGC_BENCHMARK is set in the environment, so the
+    /// regular unit test run stays with the correctness checks.
+    /// @return true: benchmarks should be run
+    static bool benchmarksEnabled(void);
+
 protected slots:
     
     // These are all pure virtuals to force the derived class to implement each one and in turn
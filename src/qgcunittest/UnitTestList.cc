@@ -38,6 +38,18 @@
 #include "PlanMasterControllerTest.h"
 #include "MissionSettingsTest.h"
 #include "QGCMapPolygonTest.h"
+#include "MAVLinkProtocolTest.h"
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileDownloaderTest.h"
+#include "LogReplayIndexTest.h"
+#include "TimeSeriesDataTest.h"
+#include "ParameterCacheTest.h"
+#include "ParameterMetaDataCacheTest.h"
+#include "ParameterRequestWindowTest.h"
+#include "ParameterStoreTest.h"
+#include "CRC32Test.h"
+#include "BootloaderTest.h"
+#include "GeoTagLogParserTest.h"
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
@@ -63,6 +75,18 @@ UT_REGISTER_TEST(SpeedSectionTest)
 UT_REGISTER_TEST(PlanMasterControllerTest)
 UT_REGISTER_TEST(MissionSettingsTest)
 UT_REGISTER_TEST(QGCMapPolygonTest)
+UT_REGISTER_TEST(MAVLinkProtocolTest)
+UT_REGISTER_TEST(QGCTileCacheWorkerTest)
+UT_REGISTER_TEST(QGCTileDownloaderTest)
+UT_REGISTER_TEST(LogReplayIndexTest)
+UT_REGISTER_TEST(TimeSeriesDataTest)
+UT_REGISTER_TEST(ParameterCacheTest)
+UT_REGISTER_TEST(ParameterMetaDataCacheTest)
+UT_REGISTER_TEST(ParameterRequestWindowTest)
+UT_REGISTER_TEST(ParameterStoreTest)
+UT_REGISTER_TEST(CRC32Test)
+UT_REGISTER_TEST(BootloaderTest)
+UT_REGISTER_TEST(GeoTagLogParserTest)
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
@@ -4,7 +4,7 @@
 #include <QDebug>
 
 MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol) :
-    QThread(), creationThread(QThread::currentThread())
+    QThread(), _subscriptionGeneration(-1), creationThread(QThread::currentThread())
 {
     // We're doing it wrong - because the Qt folks got the API wrong:
     // http://blog.qt.digia.com/blog/2010/06/17/youre-doing-it-wrong/
@@ -40,12 +40,20 @@ MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol) :
     textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_INT, false);
 //    textMessageFilter.insert(MAVLINK_MSG_ID_HIGHRES_IMU, false);
 
-    connect(protocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkDecoder::receiveMessage);
+    qRegisterMetaType<MAVLinkFieldBatch>("MAVLinkFieldBatch");
+    qRegisterMetaType<MAVLinkFieldSetPtr>("MAVLinkFieldSetPtr");
+
+    connect(protocol, &MAVLinkProtocol::sharedMessageReceived, this, &MAVLinkDecoder::receiveMessage);
     connect(this, &MAVLinkDecoder::finish, this, &QThread::quit);
 
     start(LowestPriority);
 }
 
+MAVLinkDecoder::~MAVLinkDecoder()
+{
+    qDeleteAll(_messageDecoders);
+}
+
 /**
  * @brief Runs the thread
  *
@@ -56,59 +64,123 @@ void MAVLinkDecoder::run()
     moveToThread(creationThread);
 }
 
-void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t message)
+void MAVLinkDecoder::receiveMessage(LinkInterface* link, SharedMAVLinkMessage sharedMessage)
 {
     Q_UNUSED(link);
 
-    uint32_t msgid = message.msgid;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
-    if(!msgInfo) {
-        qWarning() << "Invalid MAVLink message received. ID:" << msgid;
+    const mavlink_message_t& message = sharedMessage.message();
+    MessageDecoder_t* decoder = _messageDecoder(message);
+    if (!decoder) {
+        qWarning() << "Invalid MAVLink message received. ID:" << message.msgid;
         return;
     }
-
-    msgDict[message.msgid] = message;
-
-    // Store an arrival time for this message. This value ends up being calculated later.
-    quint64 time = 0;
+    const uint8_t* payload = (const uint8_t*)(message.payload64);
 
     // The SYSTEM_TIME message is special, in that it's handled here for synchronizing the QGC time with the remote time.
     if (message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME)
     {
         mavlink_system_time_t timebase;
         mavlink_msg_system_time_decode(&message, &timebase);
-        sysDict[msgid].onboardTimeOffset = (timebase.time_unix_usec+500)/1000 - timebase.time_boot_ms;
-        sysDict[msgid].onboardToGCSUnixTimeOffsetAndDelay  = static_cast<qint64>(QGC::groundTimeMilliseconds() - (timebase.time_unix_usec+500)/1000);
+        sysDict[message.msgid].onboardTimeOffset = (timebase.time_unix_usec+500)/1000 - timebase.time_boot_ms;
+        sysDict[message.msgid].onboardToGCSUnixTimeOffsetAndDelay  = static_cast<qint64>(QGC::groundTimeMilliseconds() - (timebase.time_unix_usec+500)/1000);
     }
-    else
-    {
 
-        // See if first value is a time value and if it is, use that as the arrival time for this data.
-        uint8_t fieldid = 0;
-        uint8_t* m = (uint8_t*)(msgDict[msgid].payload64);
+    // Multi component detection, per message id
+    SystemData& systemData = sysDict[message.msgid];
+    if (systemData.componentID == -1) {
+        systemData.componentID = message.compid;
+    } else if (systemData.componentID != message.compid) {
+        systemData.componentMulti = true;
+    }
 
-        if (QString(msgInfo->fields[fieldid].name) == QString("time_boot_ms") && msgInfo->fields[fieldid].type == MAVLINK_TYPE_UINT32_T)
-        {
-            time = *((quint32*)(m+msgInfo->fields[fieldid].wire_offset));
+    if (decoder->filtered) {
+        return;
+    }
+    decoder->receivedCount++;
+
+    // Let the charts know about values they have not seen yet. Content dependent and multi component
+    // names can change from message to message, those always go through the field set cache.
+    MAVLinkFieldSetPtr fieldSet;
+    bool multiComponent = systemData.componentMulti;
+    if (decoder->contentNames || multiComponent || !decoder->announcedSystems.testBit(message.sysid)) {
+        fieldSet = _fieldSet(decoder, message, multiComponent);
+        if (!decoder->contentNames && !multiComponent) {
+            decoder->announcedSystems.setBit(message.sysid);
         }
-        else if (QString(msgInfo->fields[fieldid].name).contains("usec") && msgInfo->fields[fieldid].type == MAVLINK_TYPE_UINT64_T)
-        {
-            time = *((quint64*)(m+msgInfo->fields[fieldid].wire_offset));
-            time = (time+500)/1000; // Scale to milliseconds, round up/down correctly
+    }
+
+    // Nobody looking at this message, nothing more to do
+    int generation = _subscriptions.generation();
+    if (generation != _subscriptionGeneration) {
+        _subscriptionSnapshot = _subscriptions.snapshot();
+        _subscriptionGeneration = generation;
+    }
+    MAVLinkSubscriptions::Snapshot_t::const_iterator subscription = _subscriptionSnapshot.constFind(MAVLinkSubscriptions::key(message.sysid, message.msgid));
+    if (subscription == _subscriptionSnapshot.constEnd()) {
+        return;
+    }
+    decoder->decodedCount++;
+    if (!fieldSet) {
+        fieldSet = _fieldSet(decoder, message, multiComponent);
+    }
+
+    // Use the time field of the message as the arrival time if it has one
+    quint64 time = 0;
+    if (decoder->timeOffset >= 0 && message.msgid != MAVLINK_MSG_ID_SYSTEM_TIME) {
+        if (decoder->timeInUSecs) {
+            quint64 timeUSecs;
+            memcpy(&timeUSecs, payload + decoder->timeOffset, sizeof(timeUSecs));
+            time = (timeUSecs+500)/1000; // Scale to milliseconds, round up/down correctly
+        } else {
+            quint32 timeMSecs;
+            memcpy(&timeMSecs, payload + decoder->timeOffset, sizeof(timeMSecs));
+            time = timeMSecs;
         }
     }
 
     // Align UAS time to global time
     time = getUnixTimeFromMs(message.sysid, time);
 
-    // Send out all field values for this message
-    for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
-    {
-        emitFieldValue(&message, i, time);
+    MAVLinkFieldBatch batch;
+    batch.sysid = message.sysid;
+    batch.compid = message.compid;
+    batch.msgid = message.msgid;
+    batch.time = time;
+    batch.fields = fieldSet;
+    const QVector<int>& fields = subscription.value();
+    int valueCount = decoder->values.count();
+    if (fields.first() == MAVLinkSubscriptions::AllFields) {
+        batch.indices.resize(valueCount);
+        batch.values.resize(valueCount);
+        for (int i = 0; i < valueCount; i++) {
+            batch.indices[i] = i;
+            batch.values[i] = _decodeValue(payload, decoder->values[i]);
+        }
+    } else {
+        batch.indices.reserve(fields.count());
+        batch.values.reserve(fields.count());
+        foreach (int field, fields) {
+            if (field < valueCount) {
+                batch.indices.append(field);
+                batch.values.append(_decodeValue(payload, decoder->values[field]));
+            }
+        }
+    }
+    if (!batch.values.isEmpty()) {
+        emit valuesReceived(batch);
     }
 
-    // Send out combined math expressions
-    // FIXME XXX TODO
+    if (!decoder->textFiltered && !decoder->texts.isEmpty()) {
+        QString label = decoder->contentNames ? _contentLabel(decoder, message) : QString(decoder->info->name);
+        QString prefix = _sourcePrefix(message, multiComponent);
+        foreach (const TextDecoder_t& text, decoder->texts) {
+            // The payload is shared, the string may not be terminated
+            QByteArray str((const char*)(payload + text.offset), text.length);
+            str.truncate(qstrnlen(str.constData(), text.length - 1));
+            QString name = QString("%1%2.%3").arg(prefix).arg(label).arg(text.name);
+            emit textMessageReceived(message.sysid, message.compid, MAV_SEVERITY_INFO, name + ": " + str);
+        }
+    }
 }
 
 quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
@@ -189,318 +261,284 @@ quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
     return ret;
 }
 
-void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+/// Returns the compiled decoder for the message id, building it on first use
+MAVLinkDecoder::MessageDecoder_t* MAVLinkDecoder::_messageDecoder(const mavlink_message_t& message)
 {
-    bool multiComponentSourceDetected = false;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
+    MessageDecoder_t* decoder = _messageDecoders.value(message.msgid, NULL);
+    if (decoder) {
+        return decoder;
+    }
 
-    uint32_t msgid = msg->msgid;
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
+    if (!msgInfo) {
+        return NULL;
+    }
 
-    // create new system data if it wasn't dectected yet
-    if (!(sysDict.keys().contains(msgid))) {
-        sysDict[msgid] = SystemData();
+    decoder = new MessageDecoder_t;
+    decoder->info = msgInfo;
+    decoder->filtered = messageFilter.contains(message.msgid);
+    decoder->textFiltered = textMessageFilter.contains(message.msgid);
+    decoder->contentNames = false;
+    decoder->labelOnly = false;
+    decoder->timeOffset = -1;
+    decoder->timeInUSecs = false;
+    decoder->announcedSystems.resize(256);
+    decoder->receivedCount = 0;
+    decoder->decodedCount = 0;
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_DEBUG:
+    case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
+    case MAVLINK_MSG_ID_NAMED_VALUE_INT:
+        decoder->labelOnly = true;
+        // Fall through
+    case MAVLINK_MSG_ID_DEBUG_VECT:
+    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+    case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        decoder->contentNames = true;
+        break;
     }
 
-    // Store component ID
-    if (sysDict[msgid].componentID == -1)
-    {
-        sysDict[msgid].componentID = msg->compid;
+    // See if first value is a time value and if it is, use that as the arrival time for this data.
+    if (msgInfo->num_fields > 0) {
+        const mavlink_field_info_t& field = msgInfo->fields[0];
+        if (strcmp(field.name, "time_boot_ms") == 0 && field.type == MAVLINK_TYPE_UINT32_T) {
+            decoder->timeOffset = field.wire_offset;
+        } else if (strstr(field.name, "usec") && field.type == MAVLINK_TYPE_UINT64_T) {
+            decoder->timeOffset = field.wire_offset;
+            decoder->timeInUSecs = true;
+        }
     }
-    else
-    {
-        // Got this message already
-        if (sysDict[msgid].componentID != msg->compid)
-        {
-            sysDict[msgid].componentMulti = true;
+
+    for (unsigned int i = 0; i < msgInfo->num_fields; i++) {
+        const mavlink_field_info_t& field = msgInfo->fields[i];
+        QString fieldName(field.name);
+
+        if (field.type == MAVLINK_TYPE_CHAR && field.array_length > 0) {
+            TextDecoder_t text;
+            text.offset = field.wire_offset;
+            text.length = field.array_length;
+            text.name = fieldName;
+            decoder->texts.append(text);
+            continue;
+        }
+
+        QString type;
+        unsigned int elementSize;
+        switch (field.type) {
+        case MAVLINK_TYPE_CHAR:     type = QString("char[%1]").arg(field.array_length); elementSize = 1; break;
+        case MAVLINK_TYPE_UINT8_T:  type = "uint8_t";   elementSize = 1; break;
+        case MAVLINK_TYPE_INT8_T:   type = "int8_t";    elementSize = 1; break;
+        case MAVLINK_TYPE_UINT16_T: type = "uint16_t";  elementSize = 2; break;
+        case MAVLINK_TYPE_INT16_T:  type = "int16_t";   elementSize = 2; break;
+        case MAVLINK_TYPE_UINT32_T: type = "uint32_t";  elementSize = 4; break;
+        case MAVLINK_TYPE_INT32_T:  type = "int32_t";   elementSize = 4; break;
+        case MAVLINK_TYPE_FLOAT:    type = "float";     elementSize = 4; break;
+        case MAVLINK_TYPE_DOUBLE:   type = "double";    elementSize = 8; break;
+        case MAVLINK_TYPE_UINT64_T: type = "uint64_t";  elementSize = 8; break;
+        case MAVLINK_TYPE_INT64_T:  type = "int64_t";   elementSize = 8; break;
+        default:
+            qDebug() << "WARNING: UNKNOWN MAVLINK TYPE";
+            continue;
+        }
+        bool isFloat = field.type == MAVLINK_TYPE_FLOAT || field.type == MAVLINK_TYPE_DOUBLE;
+
+        ValueDecoder_t value;
+        value.type = field.type;
+        if (field.array_length > 0) {
+            QString unit = QString("%1[%2]").arg(type).arg(field.array_length);
+            for (unsigned int j = 0; j < field.array_length; j++) {
+                QString suffix = QString(".%1").arg(j);
+                value.offset = field.wire_offset + j * elementSize;
+                decoder->values.append(value);
+                decoder->valueNames.append(fieldName + suffix);
+                decoder->valueSuffixes.append(suffix);
+                decoder->valueUnits.append(unit);
+                decoder->valueIsFloat.append(isFloat);
+            }
+        } else {
+            value.offset = field.wire_offset;
+            decoder->values.append(value);
+            decoder->valueNames.append(fieldName);
+            decoder->valueSuffixes.append(QString());
+            decoder->valueUnits.append(type);
+            decoder->valueIsFloat.append(isFloat);
         }
     }
 
-    if (sysDict[msgid].componentMulti == true) {
-        multiComponentSourceDetected = true;
+    _messageDecoders[message.msgid] = decoder;
+    return decoder;
+}
+
+/// Returns the names for the values of a message from this source, building and announcing them on first use
+MAVLinkFieldSetPtr MAVLinkDecoder::_fieldSet(MessageDecoder_t* decoder, const mavlink_message_t& message, bool multiComponent)
+{
+    if (decoder->contentNames) {
+        QString label = _contentLabel(decoder, message);
+        QString key = QString("%1:%2:%3").arg(message.sysid).arg(multiComponent ? message.compid + 1 : 0).arg(label);
+        MAVLinkFieldSetPtr fieldSet = decoder->contentFieldSets.value(key);
+        if (!fieldSet) {
+            fieldSet = _buildFieldSet(decoder, message, _sourcePrefix(message, multiComponent), label);
+            decoder->contentFieldSets[key] = fieldSet;
+            emit fieldsAvailable(fieldSet);
+        }
+        return fieldSet;
     }
 
-    // Add field tree widget item
-    if (messageFilter.contains(msgid)) return;
-    QString fieldName(msgInfo->fields[fieldid].name);
-    QString fieldType;
-    uint8_t* m = (uint8_t*)(msgDict[msgid].payload64);
-    QString name("%1.%2");
-    QString unit("");
+    quint32 key = (message.sysid << 16) | (multiComponent ? message.compid + 1 : 0);
+    MAVLinkFieldSetPtr fieldSet = decoder->fieldSets.value(key);
+    if (!fieldSet) {
+        fieldSet = _buildFieldSet(decoder, message, _sourcePrefix(message, multiComponent), QString(decoder->info->name));
+        decoder->fieldSets[key] = fieldSet;
+        emit fieldsAvailable(fieldSet);
+    }
+    return fieldSet;
+}
 
-    // Debug vector messages
-    if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
+void MAVLinkDecoder::announceFields(void)
+{
+    foreach (const MessageDecoder_t* decoder, _messageDecoders) {
+        foreach (const MAVLinkFieldSetPtr& fieldSet, decoder->fieldSets) {
+            emit fieldsAvailable(fieldSet);
+        }
+        foreach (const MAVLinkFieldSetPtr& fieldSet, decoder->contentFieldSets) {
+            emit fieldsAvailable(fieldSet);
+        }
+    }
+}
+
+MAVLinkFieldSetPtr MAVLinkDecoder::_buildFieldSet(const MessageDecoder_t* decoder, const mavlink_message_t& message, const QString& prefix, const QString& label)
+{
+    MAVLinkFieldSet* fieldSet = new MAVLinkFieldSet;
+    fieldSet->sysid = message.sysid;
+    fieldSet->msgid = message.msgid;
+
+    for (int i = 0; i < decoder->values.count(); i++) {
+        if (decoder->labelOnly) {
+            fieldSet->names.append(prefix + label + decoder->valueSuffixes[i]);
+        } else {
+            fieldSet->names.append(prefix + label + "." + decoder->valueNames[i]);
+        }
+    }
+    fieldSet->units = decoder->valueUnits;
+    fieldSet->isFloat = decoder->valueIsFloat;
+
+    return MAVLinkFieldSetPtr(fieldSet);
+}
+
+/// @return Prefix identifying the source of a value: M<sysid>: and C<compid>: if there are multiple components
+QString MAVLinkDecoder::_sourcePrefix(const mavlink_message_t& message, bool multiComponent)
+{
+    if (multiComponent) {
+        return QString("M%1:C%2:").arg(message.sysid).arg(message.compid);
+    }
+    return QString("M%1:").arg(message.sysid);
+}
+
+/// @return Label which replaces the message name for messages whose value names depend on their content
+QString MAVLinkDecoder::_contentLabel(const MessageDecoder_t* decoder, const mavlink_message_t& message)
+{
+    char buf[11];
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_DEBUG_VECT:
     {
         mavlink_debug_vect_t debug;
-        mavlink_msg_debug_vect_decode(msg, &debug);
-        char buf[11];
+        mavlink_msg_debug_vect_decode(&message, &debug);
         strncpy(buf, debug.name, 10);
         buf[10] = '\0';
-        name = QString("%1.%2").arg(buf).arg(fieldName);
-        time = getUnixTimeFromMs(msg->sysid, (debug.time_usec+500)/1000); // Scale to milliseconds, round up/down correctly
+        return QString(buf);
     }
-    else if (msgid == MAVLINK_MSG_ID_DEBUG)
-    {
-        mavlink_debug_t debug;
-        mavlink_msg_debug_decode(msg, &debug);
-        name = name.arg(QString("debug")).arg(debug.ind);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
-    }
-    else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
+    case MAVLINK_MSG_ID_DEBUG:
+        return QString("debug.%1").arg(mavlink_msg_debug_get_ind(&message));
+    case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
     {
         mavlink_named_value_float_t debug;
-        mavlink_msg_named_value_float_decode(msg, &debug);
-        char buf[11];
+        mavlink_msg_named_value_float_decode(&message, &debug);
         strncpy(buf, debug.name, 10);
         buf[10] = '\0';
-        name = QString(buf);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        return QString(buf);
     }
-    else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT)
+    case MAVLINK_MSG_ID_NAMED_VALUE_INT:
     {
         mavlink_named_value_int_t debug;
-        mavlink_msg_named_value_int_decode(msg, &debug);
-        char buf[11];
+        mavlink_msg_named_value_int_decode(&message, &debug);
         strncpy(buf, debug.name, 10);
         buf[10] = '\0';
-        name = QString(buf);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
-    }
-    else if (msgid == MAVLINK_MSG_ID_RC_CHANNELS_RAW)
-    {
-        // XXX this is really ugly, but we do not know a better way to do this
-        mavlink_rc_channels_raw_t raw;
-        mavlink_msg_rc_channels_raw_decode(msg, &raw);
-        name = name.arg(msgInfo->name).arg(fieldName);
-        name.prepend(QString("port%1_").arg(raw.port));
-    }
-    else if (msgid == MAVLINK_MSG_ID_RC_CHANNELS_SCALED)
-    {
-        // XXX this is really ugly, but we do not know a better way to do this
-        mavlink_rc_channels_scaled_t scaled;
-        mavlink_msg_rc_channels_scaled_decode(msg, &scaled);
-        name = name.arg(msgInfo->name).arg(fieldName);
-        name.prepend(QString("port%1_").arg(scaled.port));
-    }
-    else if (msgid == MAVLINK_MSG_ID_SERVO_OUTPUT_RAW)
-    {
-        // XXX this is really ugly, but we do not know a better way to do this
-        mavlink_servo_output_raw_t servo;
-        mavlink_msg_servo_output_raw_decode(msg, &servo);
-        name = name.arg(msgInfo->name).arg(fieldName);
-        name.prepend(QString("port%1_").arg(servo.port));
-    }
-    else
-    {
-        name = name.arg(msgInfo->name).arg(fieldName);
+        return QString(buf);
     }
-
-    if (multiComponentSourceDetected)
-    {
-        name = name.prepend(QString("C%1:").arg(msg->compid));
+    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+        return QString("port%1_%2").arg(mavlink_msg_rc_channels_raw_get_port(&message)).arg(decoder->info->name);
+    case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
+        return QString("port%1_%2").arg(mavlink_msg_rc_channels_scaled_get_port(&message)).arg(decoder->info->name);
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        return QString("port%1_%2").arg(mavlink_msg_servo_output_raw_get_port(&message)).arg(decoder->info->name);
+    default:
+        return QString(decoder->info->name);
     }
+}
 
-    name = name.prepend(QString("M%1:").arg(msg->sysid));
+double MAVLinkDecoder::_decodeValue(const uint8_t* payload, const ValueDecoder_t& value)
+{
+    const uint8_t* p = payload + value.offset;
 
-    switch (msgInfo->fields[fieldid].type)
-    {
+    switch (value.type) {
     case MAVLINK_TYPE_CHAR:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            char* str = (char*)(m+msgInfo->fields[fieldid].wire_offset);
-            // Enforce null termination
-            str[msgInfo->fields[fieldid].array_length-1] = '\0';
-            QString string(name + ": " + str);
-            if (!textMessageFilter.contains(msgid)) emit textMessageReceived(msg->sysid, msg->compid, MAV_SEVERITY_INFO, string);
-        }
-        else
-        {
-            // Single char
-            char b = *((char*)(m+msgInfo->fields[fieldid].wire_offset));
-            unit = QString("char[%1]").arg(msgInfo->fields[fieldid].array_length);
-            emit valueChanged(msg->sysid, name, unit, b, time);
-        }
-        break;
+        return *(const char*)p;
     case MAVLINK_TYPE_UINT8_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint8_t* nums = m+msgInfo->fields[fieldid].wire_offset;
-            fieldType = QString("uint8_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint8_t u = *(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = "uint8_t";
-            emit valueChanged(msg->sysid, name, fieldType, u, time);
-        }
-        break;
+        return *p;
     case MAVLINK_TYPE_INT8_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int8_t* nums = (int8_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int8_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int8_t n = *((int8_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int8_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
+        return *(const int8_t*)p;
     case MAVLINK_TYPE_UINT16_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint16_t* nums = (uint16_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("uint16_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint16_t n = *((uint16_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "uint16_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
+    {
+        uint16_t n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
     case MAVLINK_TYPE_INT16_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int16_t* nums = (int16_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int16_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int16_t n = *((int16_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int16_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
+    {
+        int16_t n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
     case MAVLINK_TYPE_UINT32_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint32_t* nums = (uint32_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("uint32_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint32_t n = *((uint32_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "uint32_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
+    {
+        uint32_t n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
     case MAVLINK_TYPE_INT32_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int32_t* nums = (int32_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int32_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int32_t n = *((int32_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int32_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
-        break;
+    {
+        int32_t n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
     case MAVLINK_TYPE_FLOAT:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            float* nums = (float*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("float[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (float)(nums[j]), time);
-            }
-        }
-        else
-        {
-            // Single value
-            float f = *((float*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "float";
-            emit valueChanged(msg->sysid, name, fieldType, f, time);
-        }
-        break;
+    {
+        float f;
+        memcpy(&f, p, sizeof(f));
+        return f;
+    }
     case MAVLINK_TYPE_DOUBLE:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            double* nums = (double*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("double[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            double f = *((double*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "double";
-            emit valueChanged(msg->sysid, name, fieldType, f, time);
-        }
-        break;
+    {
+        double d;
+        memcpy(&d, p, sizeof(d));
+        return d;
+    }
     case MAVLINK_TYPE_UINT64_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            uint64_t* nums = (uint64_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("uint64_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint64_t n = *((uint64_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "uint64_t";
-            emit valueChanged(msg->sysid, name, fieldType, (quint64) n, time);
-        }
-        break;
+    {
+        uint64_t n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
     case MAVLINK_TYPE_INT64_T:
-        if (msgInfo->fields[fieldid].array_length > 0)
-        {
-            int64_t* nums = (int64_t*)(m+msgInfo->fields[fieldid].wire_offset);
-            fieldType = QString("int64_t[%1]").arg(msgInfo->fields[fieldid].array_length);
-            for (unsigned int j = 0; j < msgInfo->fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int64_t n = *((int64_t*)(m+msgInfo->fields[fieldid].wire_offset));
-            fieldType = "int64_t";
-            emit valueChanged(msg->sysid, name, fieldType, (qint64) n, time);
-        }
-        break;
+    {
+        int64_t n;
+        memcpy(&n, p, sizeof(n));
+        return n;
+    }
     default:
-        qDebug() << "WARNING: UNKNOWN MAVLINK TYPE";
+        return 0;
     }
 }
@@ -3,8 +3,12 @@
 
 #include <QObject>
 #include <QHash>
+#include <QVector>
+#include <QSharedPointer>
+#include <QBitArray>
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkSubscriptions.h"
 
 struct SystemData {
     /**
@@ -24,32 +28,113 @@ struct SystemData {
     quint64 firstOnboardTime;   ///< First seen onboard time
 };
 
+/// Curve names and types of the numeric values decoded from one message id of one source.
+/// Built once and shared by all batches from that source.
+struct MAVLinkFieldSet {
+    int                 sysid;
+    quint32             msgid;
+    QVector<QString>    names;      ///< Value names, including the system/component prefix
+    QVector<QString>    units;      ///< Field type, e.g. "float" or "uint16_t[8]"
+    QVector<bool>       isFloat;    ///< true: floating point field
+};
+
+typedef QSharedPointer<const MAVLinkFieldSet> MAVLinkFieldSetPtr;
+
+Q_DECLARE_METATYPE(MAVLinkFieldSetPtr)
+
+/// The subscribed numeric values of one decoded message
+struct MAVLinkFieldBatch {
+    MAVLinkFieldBatch() : sysid(0), compid(0), msgid(0), time(0) { }
+
+    int                 sysid;
+    int                 compid;
+    quint32             msgid;
+    quint64             time;       ///< Unix time in milliseconds
+    MAVLinkFieldSetPtr  fields;     ///< Names and types of all values of the message
+    QVector<int>        indices;    ///< Index into fields for each value
+    QVector<double>     values;
+};
+
+Q_DECLARE_METATYPE(MAVLinkFieldBatch)
+
 class MAVLinkDecoder : public QThread
 {
     Q_OBJECT
 public:
     MAVLinkDecoder(MAVLinkProtocol* protocol);
+    ~MAVLinkDecoder();
 
     void run();
 
+    /// Fields registered here are decoded, everything else is only counted
+    MAVLinkSubscriptions* subscriptions(void) { return &_subscriptions; }
+
 signals:
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
+    /// Emitted once per decoded message with its subscribed numeric values
+    void valuesReceived(const MAVLinkFieldBatch& batch);
+    /// Emitted the first time values with these names are seen, whether subscribed or not
+    void fieldsAvailable(const MAVLinkFieldSetPtr& fields);
     void finish(); ///< Trigger a thread safe shutdown
 
 public slots:
     /** @brief Receive one message from the protocol and decode it */
-    void receiveMessage(LinkInterface* link,mavlink_message_t message);
+    void receiveMessage(LinkInterface* link, SharedMAVLinkMessage sharedMessage);
+    /** @brief Emit fieldsAvailable again for all fields seen so far */
+    void announceFields(void);
 protected:
-    /** @brief Emit the value of one message field */
-    void emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    /// One scalar value within the payload. Array fields have one entry per element.
+    typedef struct {
+        uint16_t    offset;     ///< Payload offset
+        uint8_t     type;       ///< MAVLINK_TYPE_*
+    } ValueDecoder_t;
+
+    /// One char array field within the payload
+    typedef struct {
+        uint16_t    offset;
+        uint8_t     length;
+        QString     name;
+    } TextDecoder_t;
+
+    /// Decoding table for one message id, compiled from its mavlink_message_info_t
+    typedef struct {
+        const mavlink_message_info_t*       info;
+        bool                                filtered;           ///< Message is not decoded at all
+        bool                                textFiltered;       ///< Text fields are not emitted
+        bool                                contentNames;       ///< Value names depend on the message content
+        bool                                labelOnly;          ///< Content label replaces the field names
+        int                                 timeOffset;         ///< Payload offset of the time field, -1 for none
+        bool                                timeInUSecs;        ///< true: uint64 usec time field, false: uint32 msec
+        QVector<ValueDecoder_t>             values;
+        QVector<QString>                    valueNames;         ///< field or field.index, without any prefix
+        QVector<QString>                    valueSuffixes;      ///< .index for array elements
+        QVector<QString>                    valueUnits;
+        QVector<bool>                       valueIsFloat;
+        QVector<TextDecoder_t>              texts;
+        QHash<quint32, MAVLinkFieldSetPtr>  fieldSets;          ///< By source, see _fieldSetKey
+        QHash<QString, MAVLinkFieldSetPtr>  contentFieldSets;   ///< By label for messages with contentNames
+        QBitArray                           announcedSystems;   ///< Systems whose single component field set was announced
+        quint64                             receivedCount;
+        quint64                             decodedCount;       ///< Messages with subscribed fields
+    } MessageDecoder_t;
+
     /** @brief Shift a timestamp in Unix time if necessary */
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
 
+    MessageDecoder_t* _messageDecoder(const mavlink_message_t& message);
+    MAVLinkFieldSetPtr _fieldSet(MessageDecoder_t* decoder, const mavlink_message_t& message, bool multiComponent);
+    MAVLinkFieldSetPtr _buildFieldSet(const MessageDecoder_t* decoder, const mavlink_message_t& message, const QString& prefix, const QString& label);
+    static QString _sourcePrefix(const mavlink_message_t& message, bool multiComponent);
+    QString _contentLabel(const MessageDecoder_t* decoder, const mavlink_message_t& message);
+    static double _decodeValue(const uint8_t* payload, const ValueDecoder_t& value);
+
     QMap<uint16_t, bool> messageFilter;                     ///< Message/field names not to emit
     QMap<uint16_t, bool> textMessageFilter;                 ///< Message/field names not to emit in text mode
-    QHash<int, mavlink_message_t> msgDict; ///< dictionary of all mavlink messages
+    QHash<quint32, MessageDecoder_t*> _messageDecoders;     ///< Compiled decoders by message id
     QHash<int, SystemData> sysDict; ///< dictionary of all systmes
+    MAVLinkSubscriptions _subscriptions;
+    MAVLinkSubscriptions::Snapshot_t _subscriptionSnapshot;     ///< Decoder thread copy of the subscriptions
+    int _subscriptionGeneration;
     QThread* creationThread;                                ///< QThread on which the object is created
 };
 
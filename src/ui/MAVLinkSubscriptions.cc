@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#include "MAVLinkSubscriptions.h"
+
+MAVLinkSubscriptions::MAVLinkSubscriptions(void)
+    : _generation(0)
+{
+
+}
+
+void MAVLinkSubscriptions::subscribe(int sysid, quint32 msgid, int field)
+{
+    QMutexLocker locker(&_mutex);
+
+    quint64 messageKey = key(sysid, msgid);
+    QMap<int, int>& fields = _refCounts[messageKey];
+    if (fields[field]++ == 0) {
+        _snapshot[messageKey] = fields.keys().toVector();
+        _generation.fetchAndAddOrdered(1);
+    }
+}
+
+void MAVLinkSubscriptions::unsubscribe(int sysid, quint32 msgid, int field)
+{
+    QMutexLocker locker(&_mutex);
+
+    quint64 messageKey = key(sysid, msgid);
+    if (!_refCounts.contains(messageKey) || !_refCounts[messageKey].contains(field)) {
+        return;
+    }
+    QMap<int, int>& fields = _refCounts[messageKey];
+    if (--fields[field] > 0) {
+        return;
+    }
+    fields.remove(field);
+    if (fields.isEmpty()) {
+        _refCounts.remove(messageKey);
+        _snapshot.remove(messageKey);
+    } else {
+        _snapshot[messageKey] = fields.keys().toVector();
+    }
+    _generation.fetchAndAddOrdered(1);
+}
+
+bool MAVLinkSubscriptions::isSubscribed(int sysid, quint32 msgid) const
+{
+    QMutexLocker locker(&_mutex);
+    return _snapshot.contains(key(sysid, msgid));
+}
+
+MAVLinkSubscriptions::Snapshot_t MAVLinkSubscriptions::snapshot(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return _snapshot;
+}
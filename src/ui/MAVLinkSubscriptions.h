@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#ifndef MAVLinkSubscriptions_H
+#define MAVLinkSubscriptions_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+
+/// Reference counted registry of the MAVLink message fields someone is looking at, keyed by
+/// (sysid, msgid, field). Fields are the value indices of MAVLinkDecoder, AllFields subscribes a
+/// whole message. Widgets subscribe from the GUI thread, the decoder reads a snapshot which it only
+/// refreshes when the generation changed, so the per message check does not lock.
+class MAVLinkSubscriptions
+{
+public:
+    MAVLinkSubscriptions(void);
+
+    static const int AllFields = -1;
+
+    /// Subscribed fields by message key, sorted. A list starting with AllFields covers the whole message.
+    typedef QHash<quint64, QVector<int> > Snapshot_t;
+
+    void subscribe      (int sysid, quint32 msgid, int field);
+    void unsubscribe    (int sysid, quint32 msgid, int field);
+
+    /// @return true: Any field of the message is subscribed
+    bool isSubscribed   (int sysid, quint32 msgid) const;
+
+    /// @return Changes with every subscription change
+    int generation(void) const { return _generation.load(); }
+
+    Snapshot_t snapshot(void) const;
+
+    static quint64 key(int sysid, quint32 msgid) { return (static_cast<quint64>(sysid) << 32) | msgid; }
+
+private:
+    mutable QMutex                      _mutex;
+    QHash<quint64, QMap<int, int> >     _refCounts;     ///< Subscriber count by message key and field
+    Snapshot_t                          _snapshot;
+    QAtomicInt                          _generation;
+};
+
+#endif
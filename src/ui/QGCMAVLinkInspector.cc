@@ -39,6 +39,7 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action,
             this, &QGCMAVLinkInspector::selectDropDownMenuComponent);
 
     connect(ui->clearButton, &QPushButton::clicked, this, &QGCMAVLinkInspector::clearView);
+    connect(ui->treeWidget, &QTreeWidget::itemExpanded, this, &QGCMAVLinkInspector::_itemExpanded);
 
     // Connect external connections
     connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::vehicleAdded, this, &QGCMAVLinkInspector::_vehicleAdded);
@@ -246,6 +247,8 @@ void QGCMAVLinkInspector::refreshView()
             QStringList fields;
             fields << messageName;
             QTreeWidgetItem* widget = new QTreeWidgetItem();
+            widget->setData(0, Qt::UserRole, msg->sysid);
+            widget->setData(0, Qt::UserRole + 1, msg->msgid);
             for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
             {
                 QTreeWidgetItem* field = new QTreeWidgetItem();
@@ -263,14 +266,48 @@ void QGCMAVLinkInspector::refreshView()
         {
             message->setFirstColumnSpanned(true);
             message->setData(0, Qt::DisplayRole, QVariant(messageName));
-            for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
+            // Fields of collapsed messages are not visible, they get decoded once expanded
+            if (message->isExpanded())
             {
-                updateField(msg, msgInfo, i, message->child(i));
+                for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
+                {
+                    updateField(msg, msgInfo, i, message->child(i));
+                }
             }
         }
     }
 }
 
+void QGCMAVLinkInspector::_itemExpanded(QTreeWidgetItem* item)
+{
+    // Vehicle items carry no message
+    QVariant sysid = item->data(0, Qt::UserRole);
+    if (!sysid.isValid())
+    {
+        return;
+    }
+    int msgid = item->data(0, Qt::UserRole + 1).toInt();
+
+    QMap<int, mavlink_message_t* >::const_iterator ite = uasMessageStorage.find(sysid.toInt());
+    while ((ite != uasMessageStorage.constEnd()) && (ite.key() == sysid.toInt()))
+    {
+        mavlink_message_t* msg = ite.value();
+        if (msg->msgid == msgid)
+        {
+            const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
+            if (msgInfo)
+            {
+                for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
+                {
+                    updateField(msg, msgInfo, i, item->child(i));
+                }
+            }
+            return;
+        }
+        ++ite;
+    }
+}
+
 void QGCMAVLinkInspector::addUAStoTree(int sysId)
 {
     if(!uasTreeWidgetItems.contains(sysId))
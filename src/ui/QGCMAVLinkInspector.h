@@ -67,6 +67,8 @@ protected:
     
 private slots:
     void _vehicleAdded(Vehicle* vehicle);
+    /** @brief Decode the fields of a message once its item is expanded */
+    void _itemExpanded(QTreeWidgetItem* item);
 
 private:
     Ui::QGCMAVLinkInspector *ui;
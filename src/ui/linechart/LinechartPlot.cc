@@ -134,7 +134,8 @@ int LinechartPlot::getPlotId()
  */
 double LinechartPlot::getCurrentValue(QString id)
 {
-    return data.value(id)->getCurrentValue();
+    TimeSeriesData* dataset = data.value(id);
+    return dataset ? dataset->getCurrentValue() : 0;
 }
 
 /**
@@ -142,7 +143,8 @@ double LinechartPlot::getCurrentValue(QString id)
  */
 double LinechartPlot::getMean(QString id)
 {
-    return data.value(id)->getMean();
+    TimeSeriesData* dataset = data.value(id);
+    return dataset ? dataset->getMean() : 0;
 }
 
 /**
@@ -150,7 +152,8 @@ double LinechartPlot::getMean(QString id)
  */
 double LinechartPlot::getMedian(QString id)
 {
-    return data.value(id)->getMedian();
+    TimeSeriesData* dataset = data.value(id);
+    return dataset ? dataset->getMedian() : 0;
 }
 
 /**
@@ -158,7 +161,8 @@ double LinechartPlot::getMedian(QString id)
  */
 double LinechartPlot::getVariance(QString id)
 {
-    return data.value(id)->getVariance();
+    TimeSeriesData* dataset = data.value(id);
+    return dataset ? dataset->getVariance() : 0;
 }
 
 int LinechartPlot::getAverageWindow()
@@ -232,7 +236,8 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     datalock.lock();
 
     /* Check if dataset identifier already exists */
-    if(!data.contains(dataname)) {
+    bool newCurve = !data.contains(dataname);
+    if(newCurve) {
         addCurve(dataname);
         enforceGroundTime(m_groundTime);
 //        qDebug() << "ADDING CURVE WITH" << dataname << ms << value;
@@ -245,6 +250,8 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
 
     quint64 time;
 
+    int capacity = dataset->getCapacity();
+
     // Append data
     if (!m_groundTime)
     {
@@ -275,9 +282,11 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     if (value > maxValue) maxValue = value;
     valueInterval = maxValue - minValue;
 
-    // Assign dataset to curve
-    QwtPlotCurve* curve = _curves.value(dataname);
-    curve->setRawSamples(dataset->getPlotX(), dataset->getPlotY(), dataset->getPlotCount());
+    // Curves are normally refreshed by paintRealtime(). A grown ring moved the samples a curve may
+    // still point to, so those are refreshed right away.
+    if (newCurve || dataset->getCapacity() != capacity) {
+        updateCurve(dataname);
+    }
 
     //    qDebug() << "mintime" << minTime << "maxtime" << maxTime << "last max time" << "window position" << getWindowPosition();
 
@@ -314,6 +323,33 @@ bool LinechartPlot::groundTime()
     return m_groundTime;
 }
 
+/**
+ * @brief Hand the samples inside the plot interval to the curve
+ *
+ * Curves with only a few samples per pixel column draw straight from the data set. Denser curves
+ * are decimated first, so the number of points drawn only depends on the canvas width.
+ *
+ * @param id The id-string of the curve
+ **/
+void LinechartPlot::updateCurve(const QString& id)
+{
+    QwtPlotCurve* curve = _curves.value(id);
+    TimeSeriesData* dataset = data.value(id);
+    if (!curve || !dataset) {
+        return;
+    }
+
+    int columns = qMax(canvas()->width(), 1);
+    TimeSeriesData::Samples_t samples = dataset->getPlotSamples();
+    if (samples.count > DECIMATION_THRESHOLD * columns) {
+        QVector<QPointF> points;
+        dataset->getDecimatedPlotSamples(columns, points);
+        curve->setSamples(points);
+    } else {
+        curve->setRawSamples(samples.x, samples.y, samples.count);
+    }
+}
+
 void LinechartPlot::addCurve(QString id)
 {
     QColor currentColor = getNextColor();
@@ -633,10 +669,16 @@ void LinechartPlot::setLinearScaling()
 void LinechartPlot::setAverageWindow(int windowSize)
 {
     this->averageWindowSize = windowSize;
+    datalock.lock();
     foreach(TimeSeriesData* series, data)
     {
         series->setAverageWindowSize(windowSize);
     }
+    // A larger window may have grown the rings, which moves the samples the curves still point to
+    foreach (const QString& id, _curves.keys()) {
+        updateCurve(id);
+    }
+    datalock.unlock();
 }
 
 /**
@@ -679,6 +721,14 @@ void LinechartPlot::paintRealtime()
 
         windowLock.unlock();
 
+        datalock.lock();
+        foreach (const QString& id, _curves.keys()) {
+            if (_curves.value(id)->isVisible()) {
+                updateCurve(id);
+            }
+        }
+        datalock.unlock();
+
         replot();
 
         /*
@@ -732,13 +782,20 @@ void LinechartPlot::removeAllData()
 
 
 TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plotInterval, quint64 maxInterval, double zeroValue):
+    interval(0),
+    lastValue(0),
     minValue(DBL_MAX),
-    maxValue(DBL_MIN),
+    maxValue(-DBL_MAX),
     zeroValue(0),
-    count(0),
+    capacity(0),
+    mask(0),
+    written(0),
+    plotStart(0),
     mean(0.0),
     median(0.0),
     variance(0.0),
+    m2(0.0),
+    windowCount(0),
     averageWindow(50)
 {
     this->plot = plot;
@@ -751,7 +808,7 @@ TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plot
     startTime = QUINT64_MAX;
     stopTime = QUINT64_MIN;
 
-    plotCount = 0;
+    grow(INITIAL_CAPACITY);
 }
 
 TimeSeriesData::~TimeSeriesData()
@@ -759,90 +816,219 @@ TimeSeriesData::~TimeSeriesData()
 
 }
 
+/**
+ * @brief Set the plot interval
+ * Must be called from the thread which appends data.
+ *
+ * @param ms The plot interval in milliseconds
+ **/
 void TimeSeriesData::setInterval(quint64 ms)
 {
     plotInterval = ms;
+
+    quint32 end = written.load();
+    quint32 start = end - retained(end);
+    if (interval > plotInterval) {
+        // Samples arrive in time order, search for the first one inside the interval
+        double cutTime = stopTime - plotInterval;
+        quint32 count = end - start;
+        while (count > 0) {
+            quint32 step = count / 2;
+            quint32 n = start + step;
+            if (this->ms[n & mask] < cutTime) {
+                start = n + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+    }
+    plotStart.storeRelease(start);
 }
 
+/**
+ * @brief Set the number of samples the mean and variance are calculated over
+ * Must be called from the thread which appends data.
+ **/
 void TimeSeriesData::setAverageWindowSize(int windowSize)
 {
-    this->averageWindow = windowSize;
+    this->averageWindow = qMax(windowSize, 1);
+    grow(2 * averageWindow + 1);
+    resetAverage();
+}
+
+/**
+ * @brief Recalculate mean and variance from the samples in the ring buffer
+ **/
+void TimeSeriesData::resetAverage()
+{
+    quint32 end = written.load();
+    windowCount = qMin(retained(end), static_cast<quint32>(averageWindow));
+    mean = 0;
+    m2 = 0;
+    for (quint32 n = end - windowCount; n != end; n++) {
+        mean += value[n & mask];
+    }
+    if (windowCount > 0) {
+        mean /= windowCount;
+    }
+    for (quint32 n = end - windowCount; n != end; n++) {
+        double delta = value[n & mask] - mean;
+        m2 += delta * delta;
+    }
+    variance = windowCount > 0 ? m2 / windowCount : 0;
+}
+
+/**
+ * @brief Grow the ring buffer, keeping the samples it holds
+ *
+ * @param minCapacity The capacity needed at least
+ **/
+void TimeSeriesData::grow(int minCapacity)
+{
+    int newCapacity = qMax(capacity, static_cast<int>(INITIAL_CAPACITY));
+    while (newCapacity < minCapacity) {
+        newCapacity *= 2;
+    }
+    if (newCapacity == capacity) {
+        return;
+    }
+
+    quint32 end = written.load();
+    quint32 keep = retained(end);
+    quint32 newMask = newCapacity - 1;
+    QVector<double> newMs(2 * newCapacity);
+    QVector<double> newValue(2 * newCapacity);
+    for (quint32 n = end - keep; n != end; n++) {
+        int oldSlot = n & mask;
+        int newSlot = n & newMask;
+        newMs[newSlot] = newMs[newSlot + newCapacity] = this->ms[oldSlot];
+        newValue[newSlot] = newValue[newSlot + newCapacity] = this->value[oldSlot];
+    }
+    this->ms.swap(newMs);
+    this->value.swap(newValue);
+    capacity = newCapacity;
+    mask = newMask;
+
+    resetLevels();
+}
+
+/**
+ * @brief Size the min/max summary levels for the current capacity and fill them from the ring
+ **/
+void TimeSeriesData::resetLevels()
+{
+    for (int i = 0; i < DECIMATION_LEVELS; i++) {
+        DecimationLevel_t& level = levels[i];
+        int blocks = qMax(capacity >> (DECIMATION_SHIFT * (i + 1)), 1);
+        level.minTime.fill(0, blocks);
+        level.minValue.fill(0, blocks);
+        level.maxTime.fill(0, blocks);
+        level.maxValue.fill(0, blocks);
+        level.mask = blocks - 1;
+    }
+
+    quint32 end = written.load();
+    quint32 first = end - retained(end);
+    for (quint32 n = first; n != end; n++) {
+        addToLevels(n, this->ms[n & mask], this->value[n & mask], n == first);
+    }
+}
+
+/**
+ * @brief Add a sample to the block summaries it belongs to
+ *
+ * @param n The sample number
+ * @param restart true: Start the block summaries with this sample even if it is not the first of its block
+ **/
+void TimeSeriesData::addToLevels(quint32 n, double ms, double value, bool restart)
+{
+    for (int i = 0; i < DECIMATION_LEVELS; i++) {
+        DecimationLevel_t& level = levels[i];
+        int bits = DECIMATION_SHIFT * (i + 1);
+        int slot = (n >> bits) & level.mask;
+        if (restart || (n & ((1u << bits) - 1)) == 0) {
+            level.minTime[slot] = level.maxTime[slot] = ms;
+            level.minValue[slot] = level.maxValue[slot] = value;
+        } else if (value < level.minValue[slot]) {
+            level.minTime[slot] = ms;
+            level.minValue[slot] = value;
+        } else if (value > level.maxValue[slot]) {
+            level.maxTime[slot] = ms;
+            level.maxValue[slot] = value;
+        }
+    }
+}
+
+/**
+ * @return The number of samples before sample number end which are still held by the ring buffer
+ **/
+quint32 TimeSeriesData::retained(quint32 end) const
+{
+    return qMin(end, static_cast<quint32>(capacity));
 }
 
 /**
  * @brief Append a data point to this data set
  *
+ * There must only be a single thread appending data. Mean and variance over the average
+ * window are updated incrementally, so this is constant time.
+ *
  * @param ms The time in milliseconds
  * @param value The data value
  **/
 void TimeSeriesData::append(quint64 ms, double value)
 {
-    dataMutex.lock();
-    // Qt will automatically use a smart growth strategy: http://doc.qt.io/qt-5/containers.html#growth-strategies
-    this->ms.append(ms);
-    this->value.append(value);
+    quint32 end = written.load();
+    quint32 start = plotStart.load();
+
+    // Keep the plot interval and the average window in the first half of the ring, so readers
+    // still holding a view have plenty of appends before their samples are overwritten.
+    int needed = qMax(end - start, static_cast<quint32>(averageWindow)) + 1;
+    if (needed > capacity / 2) {
+        grow(2 * needed);
+    }
+
+    // Sliding window mean and variance (Welford), the sample leaving the window is still in the ring
+    if (windowCount < averageWindow) {
+        windowCount++;
+        double delta = value - mean;
+        mean += delta / windowCount;
+        m2 += delta * (value - mean);
+    } else {
+        double oldValue = this->value[(end - averageWindow) & mask];
+        double oldMean = mean;
+        mean += (value - oldValue) / averageWindow;
+        m2 += (value - oldValue) * (value - mean + oldValue - oldMean);
+    }
+    variance = qMax(m2 / windowCount, 0.0);
+
+    int slot = end & mask;
+    this->ms[slot] = this->ms[slot + capacity] = ms;
+    this->value[slot] = this->value[slot + capacity] = value;
     this->lastValue = value;
-    this->mean = 0;
-    //QList<double> medianList = QList<double>();
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->mean += this->value[count-i];
-        //medianList.append(this->value[count-i]);
-    }
-    this->mean = mean / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-    this->variance = 0;
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->variance += (this->value[count-i] - mean) * (this->value[count-i] - mean);
-    }
-    this->variance = this->variance / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-//    qSort(medianList);
-
-//    if (medianList.count() > 2)
-//    {
-//        if (medianList.count() % 2 == 0)
-//        {
-//            median = (medianList.at(medianList.count()/2) + medianList.at(medianList.count()/2+1)) / 2.0;
-//        }
-//        else
-//        {
-//            median = medianList.at(medianList.count()/2+1);
-//        }
-//    }
+    addToLevels(end, ms, value, false);
+    end++;
 
     // Update statistical values
     if(ms < startTime) startTime = ms;
     if(ms > stopTime) stopTime = ms;
     interval = stopTime - startTime;
 
-    if (interval > plotInterval) {
-        while (this->ms[count - plotCount] < stopTime - plotInterval) {
-            plotCount--;
-        }
-    }
-
-    count++;
-    plotCount++;
-
     if(minValue > value) minValue = value;
     if(maxValue < value) maxValue = value;
 
-    // Trim dataset if necessary
-    if(maxInterval > 0) {
-        // maxInterval = 0 means infinite
-
-        if(interval > maxInterval && !this->ms.isEmpty() && !this->value.isEmpty()) {
-            // The time at which this time series should be cut
-            double minTime = stopTime - maxInterval;
-            // Delete elements from the start of the list as long the time
-            // value of this elements is before the cut time
-            while(this->ms.first() < minTime) {
-                this->ms.pop_front();
-                this->value.pop_front();
-            }
+    // Move the start of the plot interval. Samples which fall out of it stay in the ring until
+    // they are overwritten, which also bounds the stored data.
+    if (interval > plotInterval) {
+        double cutTime = stopTime - plotInterval;
+        while (start != end && this->ms[start & mask] < cutTime) {
+            start++;
         }
     }
-    dataMutex.unlock();
+
+    plotStart.storeRelease(start);
+    written.storeRelease(end);
 }
 
 /**
@@ -927,64 +1113,159 @@ void TimeSeriesData::setZeroValue(double zeroValue)
 }
 
 /**
- * @brief Get the number of points in the dataset
+ * @brief Get the number of points appended to the dataset
  *
  * @return The number of points
  **/
 int TimeSeriesData::getCount() const
 {
-    return count;
+    return written.loadAcquire();
 }
 
 /**
- * @brief Get the number of points in the plot selection
+ * @brief Get the ring buffer size
+ * The ring buffer size is \e NOT equal to the number of items in the data set. Use getCount() to get
+ * the number of data points.
  *
- * @return The number of points
+ * @return The number of samples the ring buffer holds
+ * @see getCount()
  **/
-int TimeSeriesData::getPlotCount() const
+int TimeSeriesData::getCapacity() const
 {
-    return plotCount;
+    return capacity;
 }
 
-/**
- * @brief Get the data array size
- * The data array size is \e NOT equal to the number of items in the data set, as
- * array space is pre-allocated. Use getCount() to get the number of data points.
- *
- * @return The data array size
- * @see getCount()
- **/
-int TimeSeriesData::size() const
+TimeSeriesData::Samples_t TimeSeriesData::view(quint32 end, quint32 count) const
 {
-    return ms.size();
+    int first = (end - count) & mask;
+    Samples_t samples = { ms.constData() + first, value.constData() + first, static_cast<int>(count) };
+    return samples;
 }
 
 /**
- * @brief Get the X (time) values
- *
- * @return The x values
+ * @brief Get all samples still held by the ring buffer
  **/
-const double* TimeSeriesData::getX() const
+TimeSeriesData::Samples_t TimeSeriesData::getSamples() const
 {
-    return ms.data();
+    quint32 end = written.loadAcquire();
+    return view(end, retained(end));
 }
 
-const double* TimeSeriesData::getPlotX() const
+/**
+ * @brief Get the samples inside the plot interval
+ **/
+TimeSeriesData::Samples_t TimeSeriesData::getPlotSamples() const
 {
-    return ms.data() + (count - plotCount);
+    quint32 end = written.loadAcquire();
+    quint32 count = end - plotStart.loadAcquire();
+    if (count > static_cast<quint32>(capacity)) {
+        // The interval start was published after the counter we read, the interval moved past our snapshot
+        count = 0;
+    }
+    return view(end, count);
 }
 
 /**
- * @brief Get the Y (data) values
+ * @brief Get the samples inside the plot interval reduced for drawing
  *
- * @return The y values
+ * The interval is split into columns of equal time. Every column is reduced to its smallest and its
+ * largest sample, in time order, which keeps spikes and the envelope of the curve intact. Long stretches
+ * are taken from the coarsest block summary level which still has several blocks per column, only
+ * the partial blocks at both ends are read sample by sample.
+ *
+ * @param columns The number of columns, usually the canvas width in pixels
+ * @param points Returns the decimated samples
  **/
-const double* TimeSeriesData::getY() const
+void TimeSeriesData::getDecimatedPlotSamples(int columns, QVector<QPointF>& points) const
 {
-    return value.data();
-}
+    points.clear();
 
-const double* TimeSeriesData::getPlotY() const
-{
-    return value.data() + (count - plotCount);
+    quint32 end = written.loadAcquire();
+    quint32 count = end - plotStart.loadAcquire();
+    if (count > static_cast<quint32>(capacity) || count == 0 || columns <= 0) {
+        return;
+    }
+    quint32 start = end - count;
+
+    double firstTime = ms[start & mask];
+    double columnTime = (ms[(end - 1) & mask] - firstTime) / columns;
+
+    // Current column: smallest and largest sample so far
+    int column = -1;
+    double minTime = 0, minValue = 0, maxTime = 0, maxValue = 0;
+
+    auto flushColumn = [&]() {
+        if (column < 0) {
+            return;
+        }
+        if (minTime == maxTime && minValue == maxValue) {
+            points.append(QPointF(minTime, minValue));
+        } else if (minTime <= maxTime) {
+            points.append(QPointF(minTime, minValue));
+            points.append(QPointF(maxTime, maxValue));
+        } else {
+            points.append(QPointF(maxTime, maxValue));
+            points.append(QPointF(minTime, minValue));
+        }
+    };
+    auto add = [&](double blockMinTime, double blockMinValue, double blockMaxTime, double blockMaxValue) {
+        int blockColumn = columnTime > 0 ? static_cast<int>((qMin(blockMinTime, blockMaxTime) - firstTime) / columnTime) : 0;
+        blockColumn = qBound(0, blockColumn, columns - 1);
+        if (blockColumn != column) {
+            flushColumn();
+            column = blockColumn;
+            minTime = blockMinTime;
+            minValue = blockMinValue;
+            maxTime = blockMaxTime;
+            maxValue = blockMaxValue;
+            return;
+        }
+        if (blockMinValue < minValue) {
+            minTime = blockMinTime;
+            minValue = blockMinValue;
+        }
+        if (blockMaxValue > maxValue) {
+            maxTime = blockMaxTime;
+            maxValue = blockMaxValue;
+        }
+    };
+
+    // Coarsest level with several blocks per column
+    int levelIndex = -1;
+    for (int i = DECIMATION_LEVELS - 1; i >= 0; i--) {
+        if ((count >> (DECIMATION_SHIFT * (i + 1))) >= static_cast<quint32>(4 * columns)) {
+            levelIndex = i;
+            break;
+        }
+    }
+
+    quint32 head = count;
+    quint32 blocks = 0;
+    quint32 tail = 0;
+    int bits = 0;
+    if (levelIndex >= 0) {
+        bits = DECIMATION_SHIFT * (levelIndex + 1);
+        quint32 blockMask = (1u << bits) - 1;
+        head = ((blockMask + 1) - (start & blockMask)) & blockMask;
+        tail = end & blockMask;
+        blocks = (count - head - tail) >> bits;
+    }
+
+    quint32 n = start;
+    for (quint32 i = 0; i < head; i++, n++) {
+        add(ms[n & mask], value[n & mask], ms[n & mask], value[n & mask]);
+    }
+    if (blocks > 0) {
+        const DecimationLevel_t& level = levels[levelIndex];
+        quint32 block = n >> bits;
+        for (quint32 i = 0; i < blocks; i++, block++) {
+            int slot = block & level.mask;
+            add(level.minTime[slot], level.minValue[slot], level.maxTime[slot], level.maxValue[slot]);
+        }
+        n += blocks << bits;
+    }
+    for (quint32 i = 0; i < tail; i++, n++) {
+        add(ms[n & mask], value[n & mask], ms[n & mask], value[n & mask]);
+    }
+    flushColumn();
 }
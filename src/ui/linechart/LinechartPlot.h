@@ -25,6 +25,9 @@
 #include <QMap>
 #include <QList>
 #include <QMutex>
+#include <QAtomicInteger>
+#include <QVector>
+#include <QPointF>
 #include <QTime>
 #include <QTimer>
 #include <qwt_plot_panner.h>
@@ -58,11 +61,28 @@ class QwtPlotCurve;
 /**
  * @brief Container class for the time series data
  *
+ * Samples are stored in a ring buffer with one array per column. Every sample is written twice, to its
+ * slot and to slot + capacity, so any run of up to capacity consecutive samples is contiguous and can be
+ * handed to Qwt without copying. append() is the single producer. Readers take snapshots published
+ * through the atomic sample counter and never lock. The buffer only grows, on the producer side, when the
+ * plot interval or the average window no longer fits comfortably.
+ *
+ * For long windows the ring also keeps min/max summaries of fixed size sample blocks on a few levels.
+ * They are updated with every append, so decimating a window for drawing only visits the summaries
+ * and never the whole window.
  **/
 class TimeSeriesData
 {
 public:
 
+    /// Contiguous view of samples. It stays valid until the buffer grows, and its oldest samples are only
+    /// overwritten after another capacity - count appends.
+    typedef struct {
+        const double*   x;
+        const double*   y;
+        int             count;
+    } Samples_t;
+
     TimeSeriesData(QwtPlot* plot, QString friendlyName = "data", quint64 plotInterval = 10000, quint64 maxInterval = 0, double zeroValue = 0);
     ~TimeSeriesData();
 
@@ -70,14 +90,16 @@ public:
 
     QwtScaleMap* getScaleMap();
 
+    /** @brief Get the number of samples appended so far */
     int getCount() const;
-    int size() const;
-    const double* getX() const;
-    const double* getY() const;
-
-    const double* getPlotX() const;
-    const double* getPlotY() const;
-    int getPlotCount() const;
+    /** @brief Get the number of samples the ring buffer holds */
+    int getCapacity() const;
+    /** @brief Get all samples still held by the ring buffer */
+    Samples_t getSamples() const;
+    /** @brief Get the samples inside the plot interval */
+    Samples_t getPlotSamples() const;
+    /** @brief Get the samples inside the plot interval reduced to their smallest and largest value per column */
+    void getDecimatedPlotSamples(int columns, QVector<QPointF>& points) const;
 
     int getID();
     QString getFriendlyName();
@@ -96,6 +118,10 @@ public:
     void setInterval(quint64 ms);
     void setAverageWindowSize(int windowSize);
 
+    static const int INITIAL_CAPACITY = 1024;
+    static const int DECIMATION_LEVELS = 3;     ///< Number of min/max summary levels
+    static const int DECIMATION_SHIFT = 4;      ///< Each level summarizes 2^DECIMATION_SHIFT blocks of the level below
+
 protected:
     QwtPlot* plot;
     quint64 startTime;
@@ -104,7 +130,6 @@ protected:
     quint64 plotInterval;
     quint64 maxInterval;
     int id;
-    quint64 plotCount;
     QString friendlyName;
 
     double lastValue; ///< The last inserted value
@@ -112,22 +137,40 @@ protected:
     double maxValue;  ///< The largest value in the dataset
     double zeroValue; ///< The expected value in the dataset
 
-    QMutex dataMutex;
-
     QwtScaleMap* scaleMap;
 
     void updateScaleMap();
 
 private:
-    quint64 count;
-    QVector<double> ms;
-    QVector<double> value;
+    /// Min/max summary of sample blocks, kept as a ring like the samples
+    typedef struct {
+        QVector<double> minTime;
+        QVector<double> minValue;
+        QVector<double> maxTime;
+        QVector<double> maxValue;
+        quint32         mask;
+    } DecimationLevel_t;
+
+    void grow(int minCapacity);
+    void resetAverage();
+    void resetLevels();
+    void addToLevels(quint32 n, double ms, double value, bool restart);
+    quint32 retained(quint32 end) const;
+    Samples_t view(quint32 end, quint32 count) const;
+
+    QVector<double> ms;                 ///< Time column, 2 * capacity entries
+    QVector<double> value;              ///< Value column, 2 * capacity entries
+    int capacity;                       ///< Power of two
+    quint32 mask;                       ///< capacity - 1
+    QAtomicInteger<quint32> written;    ///< Number of samples appended, published after each append
+    QAtomicInteger<quint32> plotStart;  ///< Sample number of the first sample inside the plot interval
     double mean;
     double median;
     double variance;
+    double m2;                          ///< Sum of squared deviations from the mean over the average window
+    unsigned int windowCount;           ///< Number of samples currently in the average window
     unsigned int averageWindow;
-    QVector<double> outputMs;
-    QVector<double> outputValue;
+    DecimationLevel_t levels[DECIMATION_LEVELS];
 };
 
 
@@ -178,6 +221,7 @@ public:
     static const int DEFAULT_REFRESH_RATE = 100; ///< The default refresh rate is 10 Hz / every 100 ms
     static const int DEFAULT_PLOT_INTERVAL = 1000 * 8; ///< The default plot interval is 15 seconds
     static const int DEFAULT_SCALE_INTERVAL = 1000 * 8;
+    static const int DECIMATION_THRESHOLD = 4; ///< Curves with more samples per pixel column than this are decimated before drawing
 
 public slots:
     void setRefreshRate(int ms);
@@ -267,6 +311,7 @@ protected:
 
     // Methods
     void addCurve(QString id);
+    void updateCurve(const QString& id);
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
 
@@ -32,6 +32,8 @@
 #include <QStandardPaths>
 #include <QShortcut>
 
+#include <climits>
+
 #include "LinechartWidget.h"
 #include "LinechartPlot.h"
 #include "LogCompressor.h"
@@ -59,7 +61,8 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     logStartTime(0),
     updateTimer(new QTimer()),
     selectedMAV(-1),
-    lastTimestamp(0)
+    lastTimestamp(0),
+    subscriptions(NULL)
 {
     // Add elements defined in Qt Designer
     ui.setupUi(this);
@@ -133,6 +136,9 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
 
 LinechartWidget::~LinechartWidget()
 {
+    foreach (const QString& curveID, subscribedCurves.values()) {
+        setCurveSubscribed(curveID, false);
+    }
     writeSettings();
     stopLogging();
     if (activePlot) delete activePlot;
@@ -154,6 +160,7 @@ void LinechartWidget::selectAllCurves(bool all)
 {
     QMap<QString, QLabel*>::iterator i;
     for (i = curveLabels->begin(); i != curveLabels->end(); ++i) {
+        setCurveSubscribed(i.key(), all);
         activePlot->setVisibleById(i.key(), all);
     }
 }
@@ -312,6 +319,70 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
     if(!ok || type == QMetaType::QByteArray || type == QMetaType::QString)
         return;
     bool isDouble = type == QMetaType::Float || type == QMetaType::Double;
+
+    appendValue(uasId, curve, unit, value, isDouble, usec);
+}
+
+void LinechartWidget::appendValues(const MAVLinkFieldBatch& batch)
+{
+    const MAVLinkFieldSet& fields = *batch.fields;
+    for (int i = 0; i < batch.values.count(); i++) {
+        int index = batch.indices[i];
+        // Other subscribers may have asked for fields which are not plotted here
+        if (subscribedCurves.contains(fields.names[index] + fields.units[index])) {
+            appendValue(batch.sysid, fields.names[index], fields.units[index], batch.values[i], fields.isFloat[index], batch.time);
+        }
+    }
+}
+
+void LinechartWidget::setSubscriptions(MAVLinkSubscriptions* subscriptions)
+{
+    this->subscriptions = subscriptions;
+}
+
+/**
+ * @brief Add curve list entries for decoder values
+ * Values are only decoded once their curve is checked.
+ *
+ * @param fields The names and types of the values of one message
+ **/
+void LinechartWidget::addFields(const MAVLinkFieldSetPtr& fields)
+{
+    if (selectedMAV != -1 && selectedMAV != fields->sysid) {
+        return;
+    }
+    for (int i = 0; i < fields->names.count(); i++) {
+        QString curveID = fields->names[i] + fields->units[i];
+        CurveField_t curveField = { fields->sysid, fields->msgid, i };
+        curveFields.insert(curveID, curveField);
+        if (!curveLabels->contains(curveID)) {
+            if (!fields->isFloat[i]) {
+                intData.insert(curveID, 0);
+            }
+            addCurve(fields->names[i], fields->units[i]);
+        } else if (checkBoxes.contains(curveID) && checkBoxes[curveID]->isChecked()) {
+            setCurveSubscribed(curveID, true);
+        }
+    }
+}
+
+void LinechartWidget::setCurveSubscribed(const QString& curveID, bool subscribed)
+{
+    if (!subscriptions || !curveFields.contains(curveID) || subscribedCurves.contains(curveID) == subscribed) {
+        return;
+    }
+    const CurveField_t& curveField = curveFields[curveID];
+    if (subscribed) {
+        subscriptions->subscribe(curveField.sysid, curveField.msgid, curveField.field);
+        subscribedCurves.insert(curveID);
+    } else {
+        subscriptions->unsubscribe(curveField.sysid, curveField.msgid, curveField.field);
+        subscribedCurves.remove(curveID);
+    }
+}
+
+void LinechartWidget::appendValue(int uasId, const QString& curve, const QString& unit, double value, bool isDouble, quint64 usec)
+{
     QString curveID = curve + unit;
 
     if ((selectedMAV == -1 && isVisible()) || (selectedMAV == uasId && isVisible()))
@@ -330,7 +401,7 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
 
         // Add int data
         if(!isDouble)
-            intData.insert(curveID, variant.toInt());
+            intData.insert(curveID, static_cast<int>(qBound(static_cast<double>(INT_MIN), value, static_cast<double>(INT_MAX))));
     }
 
     if (lastTimestamp == 0 && usec != 0)
@@ -370,6 +441,13 @@ void LinechartWidget::refresh()
 {
     setUpdatesEnabled(false);
     QString str;
+    // Decoder curves only get their plot curve, and with that a color, once the first value arrives
+    foreach (const QString& curveID, subscribedCurves) {
+        QWidget* colorIcon = colorIcons.value(curveID, 0);
+        if (colorIcon && colorIcon->styleSheet().isEmpty()) {
+            updateColorIcon(curveID, true);
+        }
+    }
     // Value
     QMap<QString, QLabel*>::iterator i;
     for (i = curveLabels->begin(); i != curveLabels->end(); ++i) {
@@ -608,7 +686,8 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
  **/
 void LinechartWidget::removeCurve(QString curve)
 {
-    Q_UNUSED(curve)
+    setCurveSubscribed(curve, false);
+    curveFields.remove(curve);
 
     QWidget* widget = NULL;
     widget = curveLabels->take(curve);
@@ -912,25 +991,31 @@ void LinechartWidget::takeButtonClick(bool checked)
 
     if(button != NULL)
     {
+        setCurveSubscribed(button->objectName(), checked);
         activePlot->setVisibleById(button->objectName(), checked);
-        QWidget* colorIcon = colorIcons.value(button->objectName(), 0);
-        if (colorIcon)
+        updateColorIcon(button->objectName(), checked);
+    }
+}
+
+void LinechartWidget::updateColorIcon(const QString& curveID, bool checked)
+{
+    QWidget* colorIcon = colorIcons.value(curveID, 0);
+    if (colorIcon)
+    {
+        if (checked)
         {
-            if (checked)
+            QColor color = activePlot->getColorForCurve(curveID);
+            if (color.isValid())
             {
-                QColor color = activePlot->getColorForCurve(button->objectName());
-                if (color.isValid())
-                {
-                    QString colorstyle;
-                    colorstyle = colorstyle.sprintf("QWidget { background-color: #%02X%02X%02X; }", color.red(), color.green(), color.blue());
-                    colorIcon->setStyleSheet(colorstyle);
-                }
-            }
-            else
-            {
-                colorIcon->setStyleSheet("");
+                QString colorstyle;
+                colorstyle = colorstyle.sprintf("QWidget { background-color: #%02X%02X%02X; }", color.red(), color.green(), color.blue());
+                colorIcon->setStyleSheet(colorstyle);
             }
         }
+        else
+        {
+            colorIcon->setStyleSheet("");
+        }
     }
 }
 
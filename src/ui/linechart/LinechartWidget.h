@@ -34,9 +34,11 @@
 #include <QReadWriteLock>
 #include <QToolButton>
 #include <QTimer>
+#include <QSet>
 #include <qwt_plot_curve.h>
 
 #include "LinechartPlot.h"
+#include "MAVLinkDecoder.h"
 #include "UASInterface.h"
 #include "ui_Linechart.h"
 
@@ -57,6 +59,9 @@ public:
     static const int MIN_TIME_SCROLLBAR_VALUE = 0; ///< The minimum scrollbar value
     static const int MAX_TIME_SCROLLBAR_VALUE = 16383; ///< The maximum scrollbar value
 
+    /** @brief Set the registry checked decoder curves are subscribed with */
+    void setSubscriptions(MAVLinkSubscriptions* subscriptions);
+
 public slots:
     void addCurve(const QString& curve, const QString& unit);
     void removeCurve(QString curve);
@@ -66,6 +71,10 @@ public slots:
     void setShortNames(bool enable);
     /** @brief Append data to the given curve. */
     void appendData(int uasId, const QString& curve, const QString& unit, const QVariant& value, quint64 usec);
+    /** @brief Append all values of a decoded message */
+    void appendValues(const MAVLinkFieldBatch& batch);
+    /** @brief List the decoder values which can be plotted */
+    void addFields(const MAVLinkFieldSetPtr& fields);
     /** @brief Hide curves which do not match the filter pattern */
     void filterCurves(const QString &filter);
 
@@ -112,6 +121,12 @@ protected:
     void createLayout();
     /** @brief Get the name for a curve key */
     QString getCurveName(const QString& key, bool shortEnabled);
+    /** @brief Append one value to the given curve */
+    void appendValue(int uasId, const QString& curve, const QString& unit, double value, bool isDouble, quint64 usec);
+    /** @brief Subscribe or unsubscribe the decoder field behind a curve */
+    void setCurveSubscribed(const QString& curveID, bool subscribed);
+    /** @brief Show the curve color next to a checked curve */
+    void updateColorIcon(const QString& curveID, bool checked);
 
     int sysid;                            ///< ID of the unmanned system this plot belongs to
     LinechartPlot* activePlot;            ///< Plot for this system
@@ -157,6 +172,17 @@ protected:
     bool autoGroundTimeSet;
     static const int updateInterval = 1000; ///< Time between number updates, in milliseconds
 
+    /// Decoder field a curve is fed from
+    typedef struct {
+        int     sysid;
+        quint32 msgid;
+        int     field;
+    } CurveField_t;
+
+    MAVLinkSubscriptions*       subscriptions;      ///< Registry for decoder fields, NULL if not fed by a decoder
+    QMap<QString, CurveField_t> curveFields;        ///< Decoder field by curve id
+    QSet<QString>               subscribedCurves;   ///< Curves whose decoder field is subscribed
+
     static const int MAX_CURVE_MENUITEM_NUMBER = 8;
     static const int PAGESTEP_TIME_SCROLLBAR_VALUE = (MAX_TIME_SCROLLBAR_VALUE - MIN_TIME_SCROLLBAR_VALUE) / 10;
 
@@ -21,8 +21,11 @@ QWidget* Linecharts::_newVehicleWidget(Vehicle* vehicle, QWidget* parent)
     // Connect valueChanged signals
     connect(vehicle->uas(), &UAS::valueChanged, widget, &LinechartWidget::appendData);
 
-    // Connect decoder
-    connect(_mavlinkDecoder, &MAVLinkDecoder::valueChanged, widget, &LinechartWidget::appendData);
+    // Connect decoder, values are only decoded for checked curves
+    widget->setSubscriptions(_mavlinkDecoder->subscriptions());
+    connect(_mavlinkDecoder, &MAVLinkDecoder::fieldsAvailable, widget, &LinechartWidget::addFields);
+    connect(_mavlinkDecoder, &MAVLinkDecoder::valuesReceived, widget, &LinechartWidget::appendValues);
+    QMetaObject::invokeMethod(_mavlinkDecoder, "announceFields", Qt::QueuedConnection);
 
     // Select system
     widget->setActive(true);